@@ -0,0 +1,177 @@
+// ===============================
+// File: CandleSegment.cpp
+// ===============================
+#include "CandleSegment.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+
+void CandleSeries::clear() {
+    open.clear();
+    high.clear();
+    low.clear();
+    close.clear();
+    vol.clear();
+    x0.clear();
+    x1.clear();
+}
+
+namespace {
+
+// Colors as in ExtractKernels.h: a registered theme folds the colour tests
+// into constants, DynamicColors handles the rest.
+template <class Colors>
+bool segment(const ImageView& img, const ChartLayout& layout, const Colors& candle, const DynamicColors& volume,
+             CandleSeries& out, std::vector<int>& work, int minCandles) {
+    const PixelRect plot{std::max(0, layout.plot.x0), std::max(0, layout.plot.y0),
+                         std::min(img.width, layout.plot.x1), std::min(img.height, layout.plot.y1)};
+    if (plot.empty()) return false;
+    const int cols = plot.width(), rows = plot.height();
+    const int ri = img.rIndex(), bi = img.bIndex();
+
+    // per column: bull/bear pixel counts and the rows of its longest coloured
+    // run (one-row gaps bridged), tallied row by row like the scan kernels,
+    // plus the run being grown and one row of sort scratch
+    work.assign((size_t)cols * 9, 0);
+    int* bull = work.data();
+    int* bear = bull + cols;
+    int* top = bear + cols;
+    int* bot = top + cols;
+    int* runBull = bot + cols;
+    int* runBear = runBull + cols;
+    int* runTop = runBear + cols;
+    int* runBot = runTop + cols;
+    int* tmp = runBot + cols;
+    std::fill(top, top + cols, 0);
+    std::fill(bot, bot + cols, -1);
+    std::fill(runBot, runBot + cols, INT_MIN / 2);   // no run yet: the first hit starts one
+
+    auto closeRun = [&](int i) {
+        if (runBot[i] - runTop[i] <= bot[i] - top[i]) return;
+        bull[i] = runBull[i];
+        bear[i] = runBear[i];
+        top[i] = runTop[i];
+        bot[i] = runBot[i];
+    };
+
+    for (int y = plot.y0; y < plot.y1; y++) {
+        const unsigned char* p = img.at(plot.x0, y);
+        for (int i = 0; i < cols; i++, p += 4) {
+            const int r = p[ri], g = p[1], b = p[bi];
+            const bool a = candle.isA(r, g, b);
+            if (!a && !candle.isB(r, g, b)) continue;
+            if (y - runBot[i] > 2) {
+                closeRun(i);
+                runTop[i] = y;
+                runBull[i] = runBear[i] = 0;
+            }
+            runBot[i] = y;
+            runBull[i] += a;
+            runBear[i] += !a;
+        }
+    }
+    for (int i = 0; i < cols; i++) closeRun(i);
+
+    // a candle column is one solid run (body + wicks); moving-average lines
+    // drawn in the candle colours cross it as short runs, so each column keeps
+    // its longest run only and one that is no taller than a line is dropped.
+    // Colour scattered over the run is text or anti-aliasing, and when that
+    // is most of what is left this is not a candle chart
+    const int thin = std::max(3, rows / 100);
+    int kept = 0, solid = 0;
+    for (int i = 0; i < cols; i++) {
+        const int len = bot[i] - top[i] + 1;
+        const int hits = bull[i] + bear[i];
+        if (hits == 0) continue;
+        if (len < thin) {
+            bull[i] = bear[i] = 0;
+            continue;
+        }
+        kept++;
+        if (hits * 10 >= len * 6) solid++;
+        else bull[i] = bear[i] = 0;
+    }
+    if (solid * 2 < kept) return false;
+
+    const float h = (float)rows;
+    auto norm = [&](int y) { return std::min(1.f, std::max(0.f, 1.f - (float)(y - plot.y0) / h)); };
+
+    for (int i = 0; i < cols;) {
+        if (bull[i] + bear[i] == 0) {
+            i++;
+            continue;
+        }
+        const bool isBull = bull[i] >= bear[i];
+        int j = i, nBull = 0, nBear = 0, hi = INT_MAX, lo = -1;
+        for (; j < cols && bull[j] + bear[j] > 0 && (bull[j] >= bear[j]) == isBull; j++) {
+            nBull += bull[j];
+            nBear += bear[j];
+            hi = std::min(hi, top[j]);
+            lo = std::max(lo, bot[j]);
+        }
+
+        // body = rows coloured across at least half the candle's width. The
+        // columns are solid runs nested around the wick, so that is the
+        // need-th highest column top down to the need-th lowest bottom.
+        const int w = j - i;
+        const int need = w <= 2 ? 1 : (w + 1) / 2;
+        std::copy(top + i, top + j, tmp);
+        std::nth_element(tmp, tmp + need - 1, tmp + w);
+        const int bodyTop = tmp[need - 1];
+        std::copy(bot + i, bot + j, tmp);
+        std::nth_element(tmp, tmp + need - 1, tmp + w, std::greater<int>());
+        const int bodyBot = tmp[need - 1];
+
+        const bool up = nBull >= nBear;
+        out.open.push_back(norm(up ? bodyBot : bodyTop));
+        out.close.push_back(norm(up ? bodyTop : bodyBot));
+        out.high.push_back(norm(hi));
+        out.low.push_back(norm(lo));
+        out.x0.push_back(plot.x0 + i);
+        out.x1.push_back(plot.x0 + j);
+        i = j;
+    }
+
+    // widths, median via nth_element on the (now free) tally area
+    const int n = (int)out.size();
+    if (n < std::max(1, minCandles)) {
+        out.clear();
+        return false;
+    }
+    for (int k = 0; k < n; k++) work[(size_t)k] = out.x1[k] - out.x0[k];
+    std::nth_element(work.begin(), work.begin() + n / 2, work.begin() + n);
+    if (work[(size_t)n / 2] < 2) {
+        out.clear();
+        return false;
+    }
+
+    // volume: tallest bar column under each candle
+    out.vol.assign((size_t)n, 0.f);
+    if (!layout.volume.empty()) {
+        const PixelRect vr{plot.x0, std::max(0, layout.volume.y0), plot.x1, std::min(img.height, layout.volume.y1)};
+        if (!withVolumeTheme(volume, RegisteredThemes{},
+                             [&](auto theme) { scanVolume(img, vr, 1, theme, work, out.columnVol); }))
+            scanVolume(img, vr, 1, volume, work, out.columnVol);
+        for (int k = 0; k < n; k++) {
+            float v = 0.f;
+            for (int x = out.x0[k]; x < out.x1[k]; x++) v = std::max(v, out.columnVol[(size_t)(x - plot.x0)]);
+            out.vol[(size_t)k] = v;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool segmentCandles(const ImageView& img, const ChartLayout& layout, const DynamicColors& candle,
+                    const DynamicColors& volume, CandleSeries& out, std::vector<int>& work, int minCandles) {
+    TRACE_SCOPE("segmentCandles");
+    out.clear();
+    bool ok = false;
+    if (!withCandleTheme(candle, RegisteredThemes{},
+                         [&](auto theme) { ok = segment(img, layout, theme, volume, out, work, minCandles); }))
+        ok = segment(img, layout, candle, volume, out, work, minCandles);
+    return ok;
+}
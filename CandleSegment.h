@@ -0,0 +1,45 @@
+// ===============================
+// File: CandleSegment.h
+// One OHLC + volume point per candle on a chart image, instead of one close
+// per pixel column (Predictor::setCandleSegmentation).
+//   - each column keeps its longest run of candle-coloured pixels; moving
+//     averages drawn in the candle colours cross a column as short runs, and
+//     a column whose longest run is that short counts as empty
+//   - columns are grouped into candles, split at empty columns and where the
+//     majority colour flips
+//   - a row is body when at least half the candle's columns are coloured in
+//     it (the wick is the narrow part); body top/bottom give open/close by
+//     colour, the outermost coloured rows give high/low
+//   - volume is the tallest bar column under the candle
+// Wicks drawn in another colour than the body are not seen: high/low are then
+// the body's. Prices are normalized 0..1 (1 = top of the plot) exactly like
+// the column series.
+// ===============================
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "ChartLayout.h"
+#include "ExtractKernels.h"
+#include "ImageView.h"
+#include "SeriesView.h"
+
+// Oldest candle first.
+struct CandleSeries {
+    std::vector<float> open, high, low, close, vol;
+    std::vector<int> x0, x1;   // image columns [x0, x1) the candle covers
+
+    std::vector<float> columnVol;   // scratch: volume bar height per plot column
+
+    std::size_t size() const { return close.size(); }
+    SeriesView view() const { return {close, vol, high, low}; }
+    void clear();
+};
+
+// false (out empty) when most columns left are not solid runs (text: not a
+// candle chart) or the plot does not split into at least minCandles
+// candles at least 2 px wide on median: line charts, or candles so dense they
+// touch, where the column series is the better read.
+bool segmentCandles(const ImageView& img, const ChartLayout& layout, const DynamicColors& candle,
+                    const DynamicColors& volume, CandleSeries& out, std::vector<int>& work,
+                    int minCandles = 30);
@@ -0,0 +1,115 @@
+// ===============================
+// File: ChartCache.cpp
+// ===============================
+#include "ChartCache.h"
+
+#include <algorithm>
+
+#include "Trace.h"
+
+ChartCache::ChartCache(std::size_t capacity) : capacity_(std::max<std::size_t>(1, capacity)) {
+    worker_ = std::thread([this] { workerLoop(); });
+}
+
+ChartCache::~ChartCache() {
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    worker_.join();
+}
+
+void ChartCache::prefetch(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        if (!slots_.emplace(path, Slot{}).second) return;
+        queue_.push_back(path);
+    }
+    wake_.notify_one();
+}
+
+ChartCache::State ChartCache::poll(const std::string& path, std::shared_ptr<const Chart>& out, std::string* error) {
+    std::unique_lock<std::mutex> lk(mu_);
+    auto it = slots_.find(path);
+    if (it == slots_.end()) {
+        slots_.emplace(path, Slot{});
+        queue_.push_back(path);
+        lk.unlock();
+        wake_.notify_one();
+        return State::Pending;
+    }
+    Slot& s = it->second;
+    if (s.failed) {
+        if (error) *error = s.error;
+        slots_.erase(it);
+        return State::Failed;
+    }
+    if (!s.chart) return State::Pending;
+
+    // first use: upload (GL calls stay on this thread)
+    if (!s.uploaded) {
+        Chart& c = *s.chart;
+        if (!c.texture.create((unsigned)c.pixels.width, (unsigned)c.pixels.height)) {
+            if (error) *error = "cannot create a " + std::to_string(c.pixels.width) + "x" +
+                                std::to_string(c.pixels.height) + " texture for " + path;
+            lru_.erase(s.lru);
+            slots_.erase(it);
+            return State::Failed;
+        }
+        c.texture.update(c.pixels.data(), (unsigned)c.pixels.width, (unsigned)c.pixels.height, 0, 0);
+        s.uploaded = true;
+    }
+    lru_.splice(lru_.begin(), lru_, s.lru);
+    out = s.chart;
+    evictLocked();
+    return State::Ready;
+}
+
+// Only called from prefetch/poll, so charts (and their textures) are
+// released on the GUI thread; callers' shared_ptrs keep evicted ones alive.
+void ChartCache::evictLocked() {
+    while (lru_.size() > capacity_) {
+        slots_.erase(lru_.back());
+        lru_.pop_back();
+    }
+}
+
+void ChartCache::workerLoop() {
+    trace::setThreadName("chart-cache");
+    std::unique_lock<std::mutex> lk(mu_);
+    for (;;) {
+        wake_.wait(lk, [&] { return stop_ || !queue_.empty(); });
+        if (stop_) return;
+        const std::string path = std::move(queue_.front());
+        queue_.pop_front();
+        lk.unlock();
+
+        auto chart = std::make_shared<Chart>();
+        chart->path = path;
+        std::string err;
+        bool ok;
+        {
+            TRACE_SCOPE("chartCache.decode");
+            ok = decodeImageFile(path, chart->pixels, &err);
+        }
+        if (ok) chart->meta = parseMetaFromFilename(path);
+        // decoder scratch is not needed once decoded
+        chart->pixels.fileBytes = {};
+        chart->pixels.zstream = {};
+        chart->pixels.scanlines = {};
+
+        lk.lock();
+        auto it = slots_.find(path);
+        if (it == slots_.end()) continue;   // pending slots are never erased, but be safe
+        Slot& s = it->second;
+        if (!ok) {
+            s.failed = true;
+            s.error = err.empty() ? "cannot decode " + path : err;
+            continue;
+        }
+        s.chart = std::move(chart);
+        lru_.push_front(path);
+        s.lru = lru_.begin();
+    }
+}
@@ -0,0 +1,74 @@
+// ===============================
+// File: ChartCache.h
+// Chart images for the GUI, decoded before they are asked for:
+//   - prefetch(path) queues the file on a background thread, which decodes it
+//     (ImageDecode, the predictor's own decoder) and parses the filename meta
+//   - poll(path) on the GUI thread hands the chart out once decoded, uploading
+//     its texture on first use (GL stays on the GUI thread)
+//   - the last `capacity` charts stay resident, least recently used evicted
+//     first, so switching back and forth never touches the disk again
+// The pixels are kept next to the texture, so the chart on screen can be
+// scored in place (Predictor::predictImage) instead of decoded a second time.
+// ===============================
+#pragma once
+#include <SFML/Graphics.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "ChartMeta.h"
+#include "ImageDecode.h"
+
+class ChartCache {
+public:
+    struct Chart {
+        std::string path;
+        ChartMeta meta;
+        PixelBuffer pixels;     // RGBA8, what the texture shows
+        sf::Texture texture;    // valid once poll() returned the chart
+    };
+
+    enum class State { Pending, Ready, Failed };
+
+    explicit ChartCache(std::size_t capacity = 8);
+    ~ChartCache();
+
+    ChartCache(const ChartCache&) = delete;
+    ChartCache& operator=(const ChartCache&) = delete;
+
+    // No-op if the chart is resident or queued already.
+    void prefetch(const std::string& path);
+
+    // GUI thread. Ready: out is the chart (kept alive by out even if evicted
+    // later). Pending: queued (now, if it was not) and still decoding.
+    // Failed: *error says why; the next poll tries the file again.
+    State poll(const std::string& path, std::shared_ptr<const Chart>& out, std::string* error = nullptr);
+
+private:
+    struct Slot {
+        std::shared_ptr<Chart> chart;   // null while pending
+        bool failed = false;
+        bool uploaded = false;
+        std::string error;
+        std::list<std::string>::iterator lru;   // valid once decoded
+    };
+
+    void workerLoop();
+    void evictLocked();   // mu_ held
+
+    const std::size_t capacity_;
+    std::mutex mu_;
+    std::condition_variable wake_;
+    std::deque<std::string> queue_;
+    std::unordered_map<std::string, Slot> slots_;
+    std::list<std::string> lru_;        // decoded charts, most recently used first
+    bool stop_ = false;
+    std::thread worker_;
+};
@@ -0,0 +1,351 @@
+// ===============================
+// File: ChartLayout.cpp
+// ===============================
+#include "ChartLayout.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <memory>
+
+namespace {
+
+struct Px { unsigned char r, g, b; };
+
+inline Px px(const ImageView& img, int x, int y) {
+    const unsigned char* p = img.at(x, y);
+    return {p[img.rIndex()], p[1], p[img.bIndex()]};
+}
+
+// 4 bits per channel
+inline int colorBin(const Px& p) {
+    return ((p.r >> 4) << 8) | ((p.g >> 4) << 4) | (p.b >> 4);
+}
+
+inline bool saturated(const Px& p) {
+    int mx = std::max({p.r, p.g, p.b});
+    int mn = std::min({p.r, p.g, p.b});
+    return (mx - mn) >= 60 && mx >= 90;
+}
+
+inline bool greenish(const RGB& c) { return c.g > c.r + 30 && c.g >= c.b; }
+inline bool reddish(const RGB& c)  { return c.r > c.g + 30; }
+
+inline bool near(const Px& p, const RGB& c, int tol) {
+    return std::abs((int)p.r - c.r) <= tol &&
+           std::abs((int)p.g - c.g) <= tol &&
+           std::abs((int)p.b - c.b) <= tol;
+}
+
+struct BinStats {
+    std::array<uint32_t, 4096> count{};
+    std::array<uint64_t, 4096> sumR{}, sumG{}, sumB{};
+
+    void add(int bin, const Px& p) {
+        count[bin]++;
+        sumR[bin] += p.r;
+        sumG[bin] += p.g;
+        sumB[bin] += p.b;
+    }
+    RGB mean(int bin) const {
+        RGB c;
+        if (!count[bin]) return c;
+        c.r = (unsigned char)(sumR[bin] / count[bin]);
+        c.g = (unsigned char)(sumG[bin] / count[bin]);
+        c.b = (unsigned char)(sumB[bin] / count[bin]);
+        return c;
+    }
+    // most populated bin whose colour passes pred
+    template <typename Pred>
+    bool best(Pred pred, uint32_t minCount, RGB& out) const {
+        int bestBin = -1;
+        for (int b = 0; b < 4096; b++) {
+            if (count[b] < minCount) continue;
+            RGB c;
+            c.r = (unsigned char)((b >> 8) * 16 + 8);
+            c.g = (unsigned char)(((b >> 4) & 15) * 16 + 8);
+            c.b = (unsigned char)((b & 15) * 16 + 8);
+            if (!pred(c)) continue;
+            if (bestBin < 0 || count[b] > count[bestBin]) bestBin = b;
+        }
+        if (bestBin < 0) return false;
+        out = mean(bestBin);
+        return true;
+    }
+};
+
+struct RowRun { int y0, y1; };
+
+// FNV-1a step, as in chartLayoutFingerprint
+inline void fnvMix(uint64_t& h, uint64_t v) {
+    h ^= v;
+    h *= 1099511628211ULL;
+}
+
+inline void fnvMix(uint64_t& h, const PixelRect& r) {
+    fnvMix(h, (uint64_t)(uint32_t)r.x0);
+    fnvMix(h, (uint64_t)(uint32_t)r.y0);
+    fnvMix(h, (uint64_t)(uint32_t)r.x1);
+    fnvMix(h, (uint64_t)(uint32_t)r.y1);
+}
+
+inline void fnvMix(uint64_t& h, const RGB& c) {
+    fnvMix(h, ((uint64_t)c.r << 16) | ((uint64_t)c.g << 8) | c.b);
+}
+
+} // namespace
+
+ChartLayout legacyChartLayout(int W, int H, const LayoutCuts& cuts) {
+    ChartLayout L;
+    L.width = W;
+    L.height = H;
+
+    const int topCut    = (int)(cuts.top * H);
+    const int bottomCut = (int)(cuts.bottom * H); // exclude MACD/RSI panels
+    const int leftCut   = (int)(cuts.left * W);
+    const int rightCut  = (int)(cuts.right * W);
+
+    L.plot = {leftCut, topCut, W - rightCut, H - bottomCut};
+
+    // volume panel band (tuned for the original screenshots), bottom row inclusive
+    L.volume = {leftCut, (int)(cuts.volumeTop * H), W - rightCut, (int)(cuts.volumeBottom * H) + 1};
+    return L;
+}
+
+namespace {
+
+// Steps 1-3 and 5: panel rows and colours, which depend on the chart style and
+// not on where this chart's candles happen to be, so they can be cached. plot
+// is the whole band between the neighbouring panels; fitPlotToCandles narrows it.
+ChartLayout analyzeChartPanels(const ImageView& img, const ChartLayout& fallback) {
+    TRACE_SCOPE("analyzeChartLayout");
+    const int W = img.width, H = img.height;
+    if (img.empty() || W < 32 || H < 32) return fallback;
+
+    // 1) vertical-run mask, projected onto rows
+    std::vector<int> rowAct(H, 0);
+    std::vector<uint16_t> bins((size_t)W * H, 0xFFFF);
+    for (int y = 1; y < H - 1; y++) {
+        for (int x = 0; x < W; x++) {
+            const Px p = px(img, x, y);
+            if (!saturated(p)) continue;
+            int b = colorBin(p);
+            if (colorBin(px(img, x, y - 1)) != b || colorBin(px(img, x, y + 1)) != b) continue;
+            bins[(size_t)y * W + x] = (uint16_t)b;
+            rowAct[y]++;
+        }
+    }
+
+    // 2) panels = runs of active rows (small gaps bridged)
+    const int minAct = std::max(2, W / 400);
+    const int maxGap = std::max(2, H / 100);
+    const int minPanel = std::max(4, H / 50);
+    std::vector<RowRun> runs;
+    int start = -1, lastActive = -1;
+    for (int y = 0; y < H; y++) {
+        if (rowAct[y] < minAct) continue;
+        if (start >= 0 && y - lastActive > maxGap) {
+            runs.push_back({start, lastActive + 1});
+            start = -1;
+        }
+        if (start < 0) start = y;
+        lastActive = y;
+    }
+    if (start >= 0) runs.push_back({start, lastActive + 1});
+    runs.erase(std::remove_if(runs.begin(), runs.end(),
+                              [&](const RowRun& r) { return r.y1 - r.y0 < minPanel; }),
+               runs.end());
+    if (runs.empty()) return fallback;
+
+    size_t plotIdx = 0;
+    for (size_t i = 1; i < runs.size(); i++) {
+        if (runs[i].y1 - runs[i].y0 > runs[plotIdx].y1 - runs[plotIdx].y0) plotIdx = i;
+    }
+    const RowRun plotRun = runs[plotIdx];
+    if (plotRun.y1 - plotRun.y0 < H / 5) return fallback;
+
+    // 3) candle colours from the plot panel histogram
+    auto panelStats = [&](const RowRun& r, BinStats& st) {
+        for (int y = r.y0; y < r.y1; y++) {
+            for (int x = 0; x < W; x++) {
+                uint16_t b = bins[(size_t)y * W + x];
+                if (b != 0xFFFF) st.add(b, px(img, x, y));
+            }
+        }
+    };
+    auto plotStats = std::make_unique<BinStats>();
+    panelStats(plotRun, *plotStats);
+
+    ChartLayout L;
+    L.width = W;
+    L.height = H;
+    L.volUp = fallback.volUp;
+    L.volDown = fallback.volDown;
+    L.volTolerance = fallback.volTolerance;
+    const uint32_t minColor = (uint32_t)std::max(16, H / 20);
+    if (!plotStats->best(greenish, minColor, L.bull) || !plotStats->best(reddish, minColor, L.bear)) {
+        return fallback;
+    }
+    L.hasCandleColors = true;
+
+    // 4) the plot is the band up to the neighbouring panels: the active rows are
+    // only where this chart's candles are, the next chart's may sit elsewhere
+    L.plot = {0, plotIdx > 0 ? runs[plotIdx - 1].y1 : 0,
+              W, plotIdx + 1 < runs.size() ? runs[plotIdx + 1].y0 : H};
+
+    // 5) volume = first panel below the plot; everything else is an indicator
+    int volIdx = -1;
+    for (size_t i = 0; i < runs.size(); i++) {
+        if (runs[i].y0 >= plotRun.y1) { volIdx = (int)i; break; }
+    }
+    for (size_t i = 0; i < runs.size(); i++) {
+        if ((int)i == volIdx || i == plotIdx) continue;
+        L.indicators.push_back({0, runs[i].y0, W, runs[i].y1});
+    }
+
+    if (volIdx >= 0) {
+        const RowRun vr = runs[volIdx];
+        L.volume = {0, vr.y0, W, vr.y1};
+        auto volStats = std::make_unique<BinStats>();
+        panelStats(vr, *volStats);
+        RGB up, down;
+        const uint32_t minVol = (uint32_t)std::max(4, H / 100);
+        if (volStats->best(greenish, minVol, up) && volStats->best(reddish, minVol, down)) {
+            L.volUp = up;
+            L.volDown = down;
+            L.volTolerance = 40;
+        }
+    } else {
+        L.volume = PixelRect{};
+    }
+
+    L.detected = true;
+    return L;
+}
+
+} // namespace
+
+void fitPlotToCandles(const ImageView& img, int colorTolerance, ChartLayout& L) {
+    if (!L.detected || !L.hasCandleColors || img.width != L.width || img.height != L.height) return;
+    TRACE_SCOPE("fitPlotToCandles");
+    const int W = L.width, H = L.height;
+    const PixelRect band = L.plot;
+    // 0 = neither, 1 = bull, 2 = bear
+    auto cls = [&](int x, int y) {
+        const Px p = px(img, x, y);
+        return near(p, L.bull, colorTolerance) ? 1 : near(p, L.bear, colorTolerance) ? 2 : 0;
+    };
+
+    // rows holding vertical runs in the candle colours; the band also holds
+    // the legend and header text, so take the tallest run of such rows
+    std::vector<int> rowHits(band.height(), 0);
+    for (int y = std::max(band.y0, 1); y < std::min(band.y1, H - 1); y++) {
+        for (int x = band.x0; x < band.x1; x++) {
+            const int c = cls(x, y);
+            if (c && cls(x, y - 1) == c && cls(x, y + 1) == c) rowHits[y - band.y0]++;
+        }
+    }
+    const int maxGap = std::max(2, H / 100);
+    RowRun best{0, 0};
+    int start = -1, lastActive = -1;
+    for (int i = 0; i <= band.height(); i++) {
+        const bool active = i < band.height() && rowHits[i] > 0;
+        if (start >= 0 && (i == band.height() || (active && i - lastActive > maxGap))) {
+            if (lastActive + 1 - start > best.y1 - best.y0) best = {start, lastActive + 1};
+            start = -1;
+        }
+        if (!active) continue;
+        if (start < 0) start = i;
+        lastActive = i;
+    }
+    // the runs' end pixels have only one neighbour in the colour
+    const int cy0 = std::max(band.y0, band.y0 + best.y0 - 1);
+    const int cy1 = std::min(band.y1, band.y0 + best.y1 + 1);
+
+    int cx0 = W, cx1 = -1;
+    for (int y = cy0; y < cy1; y++) {
+        for (int x = band.x0; x < band.x1; x++) {
+            if (!cls(x, y)) continue;
+            cx0 = std::min(cx0, x);
+            cx1 = std::max(cx1, x);
+        }
+    }
+    // too little to go on: keep the whole band
+    if (cx1 - cx0 < W / 4 || cy1 - cy0 < H / 10) return;
+    L.plot = {cx0, cy0, cx1 + 1, cy1};
+    // columns stay aligned with the close series
+    if (!L.volume.empty()) {
+        L.volume.x0 = L.plot.x0;
+        L.volume.x1 = L.plot.x1;
+    }
+}
+
+ChartLayout analyzeChartLayout(const ImageView& img, int colorTolerance, const ChartLayout& fallback) {
+    ChartLayout L = analyzeChartPanels(img, fallback);
+    fitPlotToCandles(img, colorTolerance, L);
+    return L;
+}
+
+uint64_t chartLayoutFingerprint(const ImageView& img) {
+    const int W = img.width, H = img.height;
+    // FNV-1a over size + the outer ring (every 4th pixel, 3 bits per channel)
+    uint64_t h = 1469598103934665603ULL;
+    auto mix = [&](uint64_t v) { fnvMix(h, v); };
+    mix((uint64_t)W);
+    mix((uint64_t)H);
+    if (img.empty()) return h;
+
+    auto sample = [&](int x, int y) {
+        const Px p = px(img, x, y);
+        mix((uint64_t)(((p.r >> 5) << 6) | ((p.g >> 5) << 3) | (p.b >> 5)));
+    };
+    for (int x = 0; x < W; x += 4) { sample(x, 0); sample(x, H - 1); }
+    for (int y = 0; y < H; y += 4) { sample(0, y); sample(W - 1, y); }
+    return h;
+}
+
+// ---------- cache ----------
+ChartLayout ChartLayoutCache::get(const ImageView& img, int colorTolerance, const ChartLayout& fallback) {
+    uint64_t key = chartLayoutFingerprint(img);
+    fnvMix(key, fallback.plot);
+    fnvMix(key, fallback.volume);
+    fnvMix(key, fallback.volUp);
+    fnvMix(key, fallback.volDown);
+    fnvMix(key, (uint64_t)(uint32_t)fallback.volTolerance);
+    ChartLayout L;
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = map_.find(key);
+        found = it != map_.end();
+        if (found) L = it->second;
+        else misses_++;
+    }
+
+    if (!found) {
+        // analyse outside the lock; a racing thread may do the same work once
+        L = analyzeChartPanels(img, fallback);
+        std::lock_guard<std::mutex> lock(mu_);
+        if (map_.size() >= maxEntries_) map_.clear();
+        map_.emplace(key, L);
+    }
+    // the candle extent is this chart's, never the cached one's
+    fitPlotToCandles(img, colorTolerance, L);
+    return L;
+}
+
+void ChartLayoutCache::clear() {
+    std::lock_guard<std::mutex> lock(mu_);
+    map_.clear();
+}
+
+std::size_t ChartLayoutCache::size() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return map_.size();
+}
+
+uint64_t ChartLayoutCache::misses() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return misses_;
+}
@@ -0,0 +1,96 @@
+// ===============================
+// File: ChartLayout.h
+// Where things are on a chart screenshot: price plot, volume panel, indicator
+// panels, and the candle colours actually used.
+//
+// legacyChartLayout() reproduces the historical fixed cuts (10% top, 25% bottom,
+// 3%/2% sides, volume 74..89%). analyzeChartLayout() measures them instead:
+//   - pixels that are saturated and have the same colour directly above and
+//     below (candle bodies/wicks, volume bars) form a "vertical run" mask
+//   - row projection of that mask splits the image into panels; the tallest is
+//     the price plot, the one right below it is volume, the rest are indicators
+//   - a colour histogram of the mask inside each panel gives the dominant
+//     green-ish (bull) and red-ish (bear) colours
+//   - the plot is then narrowed to this chart's candles in those colours
+// Analysis is a full pass over the image, so the panels and colours are cached
+// per layout fingerprint (size + hash of the outer border). The candle extent
+// is not: it is re-measured for every chart.
+// ===============================
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "ImageView.h"
+
+struct PixelRect {
+    int x0 = 0, y0 = 0;   // inclusive
+    int x1 = 0, y1 = 0;   // exclusive
+    int width() const { return x1 - x0; }
+    int height() const { return y1 - y0; }
+    bool empty() const { return x1 <= x0 || y1 <= y0; }
+};
+
+struct RGB {
+    unsigned char r = 0, g = 0, b = 0;
+};
+
+struct ChartLayout {
+    int width = 0;
+    int height = 0;
+
+    PixelRect plot;                     // candle area scanned for closes
+    PixelRect volume;                   // bars grow up from y1-1 (may be empty)
+    std::vector<PixelRect> indicators;  // MACD/RSI/etc. panels (informational)
+
+    bool hasCandleColors = false;       // false -> use the configured ColorConfig
+    RGB bull, bear;
+
+    RGB volUp{0, 200, 120};
+    RGB volDown{200, 60, 60};
+    int volTolerance = 70;
+
+    bool detected = false;              // false -> legacy fixed cuts
+};
+
+// The fixed cuts as fractions of the image (PredictorConfig "cut.*").
+struct LayoutCuts {
+    double top = 0.10, bottom = 0.25;          // plot: off the top / off the bottom (MACD/RSI)
+    double left = 0.03, right = 0.02;
+    double volumeTop = 0.74, volumeBottom = 0.89;   // volume band, bottom row inclusive
+};
+
+ChartLayout legacyChartLayout(int W, int H, const LayoutCuts& cuts = {});
+
+// Returns fallback (the caller's fixed layout for this image: its cuts and
+// volume colours) when no confident plot is found. A detected layout keeps
+// fallback's volume colours unless the volume panel's own are found.
+ChartLayout analyzeChartLayout(const ImageView& img, int colorTolerance, const ChartLayout& fallback);
+
+// Narrows a detected L.plot (and the volume columns) to img's candles in
+// L.bull/L.bear. No-op for fixed layouts or when too little is found.
+void fitPlotToCandles(const ImageView& img, int colorTolerance, ChartLayout& L);
+
+uint64_t chartLayoutFingerprint(const ImageView& img);
+
+// Thread-safe fingerprint -> panel layout map; get() fits the plot to each
+// image's candles. Shared by Predictor copies, which may be configured
+// differently: the fallback is part of the key.
+class ChartLayoutCache {
+public:
+    explicit ChartLayoutCache(std::size_t maxEntries = 64) : maxEntries_(maxEntries) {}
+
+    ChartLayout get(const ImageView& img, int colorTolerance, const ChartLayout& fallback);
+
+    void clear();
+    std::size_t size() const;
+    uint64_t misses() const;
+
+private:
+    mutable std::mutex mu_;
+    std::unordered_map<uint64_t, ChartLayout> map_;
+    std::size_t maxEntries_;
+    uint64_t misses_ = 0;
+};
@@ -0,0 +1,49 @@
+// ===============================
+// File: ChartMeta.cpp
+// ===============================
+#include "ChartMeta.h"
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <regex>
+#include <sstream>
+
+ChartMeta parseMetaFromFilename(const std::string& imagePath) {
+    ChartMeta meta;
+
+    // timeframe
+    if (imagePath.find("test30") != std::string::npos || imagePath.find("_30m") != std::string::npos) meta.tfMin = 30;
+    else if (imagePath.find("test5") != std::string::npos || imagePath.find("_5m") != std::string::npos) meta.tfMin = 5;
+    else if (imagePath.find("test1") != std::string::npos || imagePath.find("_1m") != std::string::npos) meta.tfMin = 1;
+
+    // scale parse: ..._MIN_MAX.png (compiled once; const regex is safe to share across threads)
+    static const std::regex re(R"(_([0-9]+(?:\.[0-9]+)?)_([0-9]+(?:\.[0-9]+)?)\.png$)");
+    std::smatch m;
+    if (std::regex_search(imagePath, m, re) && m.size() == 3) {
+        meta.minPrice = std::stod(m[1].str());
+        meta.maxPrice = std::stod(m[2].str());
+        if (meta.maxPrice > meta.minPrice) meta.hasScale = true;
+    }
+
+    return meta;
+}
+
+std::string nowHHMM() {
+    using namespace std::chrono;
+    auto now = system_clock::now();
+    std::time_t t = system_clock::to_time_t(now);
+
+    // reentrant variants: the watch mode calls this from worker threads
+    std::tm local{};
+#if defined(_WIN32)
+    localtime_s(&local, &t);
+#else
+    localtime_r(&t, &local);
+#endif
+
+    std::ostringstream oss;
+    oss << std::setw(2) << std::setfill('0') << local.tm_hour
+        << ":"
+        << std::setw(2) << std::setfill('0') << local.tm_min;
+    return oss.str();
+}
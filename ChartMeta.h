@@ -0,0 +1,20 @@
+// ===============================
+// File: ChartMeta.h
+// Chart metadata parsed from screenshot filenames + local clock helper.
+// Shared by the GUI and the headless watch mode.
+// ===============================
+#pragma once
+#include <string>
+
+struct ChartMeta {
+    int tfMin = -1;                 // 1, 5, 30
+    bool hasScale = false;
+    double minPrice = 0.0;          // bottom of chart
+    double maxPrice = 0.0;          // top of chart
+};
+
+// Supports: XRP_1m_2.0325_2.0697.png  OR  test1.png (no scale)
+ChartMeta parseMetaFromFilename(const std::string& imagePath);
+
+// Local wall-clock time as "HH:MM" (what predictWithTime expects)
+std::string nowHHMM();
@@ -0,0 +1,117 @@
+// ===============================
+// File: ChartOverlay.cpp
+// ===============================
+#include "ChartOverlay.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+const sf::Color kClose(235, 235, 235, 150);
+const sf::Color kSmooth(255, 200, 0, 230);
+const sf::Color kSupport(40, 220, 120, 170);
+const sf::Color kResistance(240, 70, 70, 170);
+const sf::Color kBreakout(60, 200, 255, 230);
+const sf::Color kStop(255, 110, 40, 255);
+const sf::Color kTarget(120, 170, 255, 255);
+
+// Plot rectangle on screen + value/index -> screen mapping.
+struct Mapper {
+    float left = 0.f, top = 0.f, width = 1.f, height = 1.f;
+    std::size_t columns = 1;
+
+    float x(double idx) const { return left + (float)((idx + 0.5) / (double)columns) * width; }
+    float y(double v) const { return top + (1.f - (float)v) * height; }
+};
+
+void line(sf::VertexArray& va, float x0, float y0, float x1, float y1, sf::Color c) {
+    va.append(sf::Vertex({x0, y0}, c));
+    va.append(sf::Vertex({x1, y1}, c));
+}
+
+void hline(sf::VertexArray& va, const Mapper& m, double v, sf::Color c) {
+    if (v <= 0.0 || v > 1.0) return;
+    line(va, m.left, m.y(v), m.left + m.width, m.y(v), c);
+}
+
+// Polyline, or when there are more than ~2 values per screen pixel, one
+// vertical min..max span per pixel joined to its neighbour.
+void series(sf::VertexArray& va, const Mapper& m, const std::vector<float>& v, sf::Color c) {
+    if (v.size() < 2) return;
+    const int px = std::max(1, (int)std::ceil(m.width));
+    if (v.size() <= (std::size_t)px * 2) {
+        for (std::size_t i = 1; i < v.size(); i++) line(va, m.x(i - 1), m.y(v[i - 1]), m.x(i), m.y(v[i]), c);
+        return;
+    }
+    float prevX = 0.f, prevY = 0.f;
+    for (int p = 0; p < px; p++) {
+        const std::size_t b = v.size() * p / px, e = std::max(b + 1, v.size() * (p + 1) / px);
+        float lo = v[b], hi = v[b];
+        for (std::size_t i = b + 1; i < e; i++) {
+            lo = std::min(lo, v[i]);
+            hi = std::max(hi, v[i]);
+        }
+        const float x = m.left + p + 0.5f;
+        if (hi > lo) line(va, x, m.y(hi), x, m.y(lo), c);
+        if (p > 0) line(va, prevX, prevY, x, m.y(v[b]), c);
+        prevX = x;
+        prevY = m.y(v[e - 1]);
+    }
+}
+
+} // namespace
+
+void ChartOverlay::build(const PredictionOverlay& ov, const sf::FloatRect& imageBounds) {
+    clear();
+    if (!ov.valid || ov.close.empty()) return;
+
+    Mapper m;
+    m.columns = ov.close.size();
+    if (ov.imageWidth > 0 && ov.imageHeight > 0 && !ov.plot.empty()) {
+        const float sx = imageBounds.width / ov.imageWidth;
+        const float sy = imageBounds.height / ov.imageHeight;
+        m.left = imageBounds.left + ov.plot.x0 * sx;
+        m.top = imageBounds.top + ov.plot.y0 * sy;
+        m.width = ov.plot.width() * sx;
+        m.height = ov.plot.height() * sy;
+    } else {
+        // predictSeries: no image, use the whole area
+        m.left = imageBounds.left;
+        m.top = imageBounds.top;
+        m.width = imageBounds.width;
+        m.height = imageBounds.height;
+    }
+
+    for (float s : ov.supports) hline(lines_, m, s, kSupport);
+    for (float r : ov.resistances) hline(lines_, m, r, kResistance);
+    hline(lines_, m, ov.breakoutLevel, kBreakout);
+    hline(lines_, m, ov.stopLoss, kStop);
+    hline(lines_, m, ov.target1, kTarget);
+    hline(lines_, m, ov.target2, kTarget);
+
+    series(lines_, m, ov.close, kClose);
+    series(lines_, m, ov.smooth, kSmooth);
+
+    // swing highs: triangle above pointing down; lows: below pointing up
+    const float r = 4.f;
+    for (const auto& sw : ov.swings) {
+        const float x = m.x(sw.idx), y = m.y(sw.value);
+        const sf::Color c = sw.isHigh ? kResistance : kSupport;
+        const float d = sw.isHigh ? -1.f : 1.f;
+        markers_.append(sf::Vertex({x, y + d * 2.f}, c));
+        markers_.append(sf::Vertex({x - r, y + d * (2.f + 2.f * r)}, c));
+        markers_.append(sf::Vertex({x + r, y + d * (2.f + 2.f * r)}, c));
+    }
+}
+
+void ChartOverlay::clear() {
+    lines_.clear();
+    markers_.clear();
+}
+
+void ChartOverlay::draw(sf::RenderTarget& target) const {
+    if (lines_.getVertexCount()) target.draw(lines_);
+    if (markers_.getVertexCount()) target.draw(markers_);
+}
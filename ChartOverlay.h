@@ -0,0 +1,27 @@
+// ===============================
+// File: ChartOverlay.h
+// Draws Prediction::overlay (extracted close, smoothed series, swings, S/R,
+// breakout, stop/targets) on top of the chart sprite.
+// Everything is baked into two vertex arrays when a result arrives (lines +
+// swing markers), so drawing is two draw calls however long the series is.
+// Series longer than the on-screen width are reduced to a min/max span per
+// screen pixel, so a 8k-column chart costs about as much as a 500-column one.
+// ===============================
+#pragma once
+#include <SFML/Graphics.hpp>
+
+#include "Predictor.h"
+
+class ChartOverlay {
+public:
+    // imageBounds = where the whole chart image is on screen (sprite.getGlobalBounds()).
+    void build(const PredictionOverlay& ov, const sf::FloatRect& imageBounds);
+    void clear();
+    bool empty() const { return lines_.getVertexCount() == 0 && markers_.getVertexCount() == 0; }
+
+    void draw(sf::RenderTarget& target) const;
+
+private:
+    sf::VertexArray lines_{sf::Lines};
+    sf::VertexArray markers_{sf::Triangles};
+};
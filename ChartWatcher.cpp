@@ -0,0 +1,328 @@
+// ===============================
+// File: ChartWatcher.cpp
+// ===============================
+#include "ChartWatcher.h"
+#include "LockFreeQueue.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct Job {
+    std::string path;
+    Clock::time_point eventTime{};
+};
+
+bool hasExtension(const std::string& name, const std::string& ext) {
+    if (name.size() < ext.size() || name.empty() || name[0] == '.') return false;
+    return std::equal(ext.rbegin(), ext.rend(), name.rbegin(), [](char a, char b) {
+        return std::tolower((unsigned char)a) == std::tolower((unsigned char)b);
+    });
+}
+
+std::atomic<bool> g_quit{false};
+
+void onQuitSignal(int) { g_quit.store(true); }
+}
+
+struct ChartWatcher::Impl {
+    Impl(const Predictor& proto, WatchOptions o, Callback c)
+        : prototype(proto), opt(std::move(o)), cb(std::move(c)),
+          queue(std::max<std::size_t>(2, opt.queueCapacity)) {}
+
+    Predictor prototype;
+    WatchOptions opt;
+    Callback cb;
+    std::string dir;
+
+    LockFreeQueue<Job> queue;
+    std::atomic<bool> stopping{false};
+
+    // sleeping workers park here; the queue itself never takes this lock
+    std::mutex wakeMu;
+    std::condition_variable wakeCv;
+    std::atomic<int> queued{0};
+
+    std::thread watchThread;
+    std::vector<std::thread> workers;
+
+    int inotifyFd = -1;
+    int stopFd = -1;
+
+    void enqueue(Job job) {
+        while (!queue.tryPush(job)) {
+            if (stopping.load()) return;
+            std::this_thread::yield();
+        }
+        queued.fetch_add(1);
+        { std::lock_guard<std::mutex> lock(wakeMu); }
+        wakeCv.notify_one();
+    }
+
+    void workerLoop(int idx) {
+        trace::setThreadName("watch-worker-" + std::to_string(idx));
+        Predictor predictor = prototype;
+        Job job;
+
+        while (!stopping.load()) {
+            if (!queue.tryPop(job)) {
+                std::unique_lock<std::mutex> lock(wakeMu);
+                wakeCv.wait(lock, [&] { return queued.load() > 0 || stopping.load(); });
+                continue;
+            }
+            queued.fetch_sub(1);
+
+            TRACE_SCOPE("watchPredict");
+            WatchResult r;
+            r.path = job.path;
+            r.meta = parseMetaFromFilename(job.path);
+            try {
+                if (opt.previewStride > 1) {
+                    r.prediction = predictor.predictTwoPass(job.path, nowHHMM(), r.meta.tfMin, opt.previewStride,
+                                                            r.meta.hasScale, r.meta.minPrice, r.meta.maxPrice);
+                } else {
+                    r.prediction = predictor.predictWithTime(job.path, nowHHMM(), r.meta.tfMin,
+                                                             r.meta.hasScale, r.meta.minPrice, r.meta.maxPrice);
+                }
+            } catch (const std::exception& e) {
+                r.ok = false;
+                r.error = e.what();
+            }
+            r.latencyMs = std::chrono::duration<double, std::milli>(Clock::now() - job.eventTime).count();
+            if (cb) cb(r);
+        }
+    }
+
+#if defined(__linux__)
+    struct FileStamp {
+        long long size = -1;
+        long long mtimeNs = -1;
+        bool operator==(const FileStamp& o) const { return size == o.size && mtimeNs == o.mtimeNs; }
+    };
+
+    struct Pending {
+        Clock::time_point lastEvent{};
+        long long lastSize = -1;
+    };
+
+    std::map<std::string, Pending> pending;       // modified, not yet closed
+    std::map<std::string, FileStamp> dispatched;  // what we last handed to workers (files still there)
+    static constexpr std::size_t kMaxDispatched = 4096;
+
+    static bool stampOf(const std::string& path, FileStamp& out) {
+        struct stat st{};
+        if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) return false;
+        out.size = (long long)st.st_size;
+        out.mtimeNs = (long long)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+        return true;
+    }
+
+    // dedup: close + debounce (or repeated closes) for identical content dispatch once
+    void dispatch(const std::string& path, Clock::time_point t) {
+        FileStamp st;
+        if (!stampOf(path, st) || st.size <= 0) return;
+        auto it = dispatched.find(path);
+        if (it != dispatched.end() && it->second == st) return;
+        if (it == dispatched.end() && dispatched.size() >= kMaxDispatched) pruneDispatched();
+        dispatched[path] = st;
+        enqueue(Job{path, t});
+    }
+
+    // Deletes and moves-away are pruned as they come in; this catches what
+    // the events missed (queue overflow) so the map never outgrows the folder.
+    void pruneDispatched() {
+        FileStamp st;
+        for (auto it = dispatched.begin(); it != dispatched.end();) {
+            if (stampOf(it->first, st)) ++it;
+            else it = dispatched.erase(it);
+        }
+        if (dispatched.size() >= kMaxDispatched) dispatched.clear();   // huge folder: forget, worst case a re-predict
+    }
+
+    void flushDebounced(Clock::time_point now) {
+        const auto quiet = std::chrono::milliseconds(opt.debounceMs);
+        for (auto it = pending.begin(); it != pending.end();) {
+            if (now - it->second.lastEvent < quiet) { ++it; continue; }
+            FileStamp st;
+            if (!stampOf(it->first, st)) { it = pending.erase(it); continue; }
+            if (st.size > 0 && st.size == it->second.lastSize) {
+                dispatch(it->first, it->second.lastEvent);
+                it = pending.erase(it);
+            } else {
+                // still growing: re-arm
+                it->second.lastSize = st.size;
+                it->second.lastEvent = now;
+                ++it;
+            }
+        }
+    }
+
+    void watchLoop() {
+        trace::setThreadName("watch-inotify");
+        alignas(struct inotify_event) char buf[64 * 1024];
+
+        while (!stopping.load()) {
+            pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {stopFd, POLLIN, 0}};
+            int timeout = pending.empty() ? -1 : std::max(1, opt.debounceMs / 2);
+            int rc = ::poll(fds, 2, timeout);
+            if (rc < 0 && errno != EINTR) break;
+            if (fds[1].revents & POLLIN) break;
+
+            const auto now = Clock::now();
+            if (rc > 0 && (fds[0].revents & POLLIN)) {
+                for (;;) {
+                    ssize_t n = ::read(inotifyFd, buf, sizeof(buf));
+                    if (n <= 0) break;
+                    for (char* p = buf; p < buf + n;) {
+                        auto* ev = reinterpret_cast<struct inotify_event*>(p);
+                        p += sizeof(struct inotify_event) + ev->len;
+                        if (ev->len == 0 || !hasExtension(ev->name, opt.extension)) continue;
+
+                        std::string path = dir + "/" + ev->name;
+                        if (ev->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                            pending.erase(path);
+                            dispatched.erase(path);
+                        } else if (ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                            pending.erase(path);
+                            dispatch(path, now);
+                        } else if (ev->mask & (IN_MODIFY | IN_CREATE)) {
+                            auto& pe = pending[path];
+                            pe.lastEvent = now;
+                        }
+                    }
+                }
+            }
+            if (!pending.empty()) flushDebounced(now);
+        }
+    }
+#endif
+};
+
+ChartWatcher::ChartWatcher(const Predictor& prototype, WatchOptions opt, Callback cb)
+    : impl_(new Impl(prototype, std::move(opt), std::move(cb))) {}
+
+ChartWatcher::~ChartWatcher() {
+    stop();
+}
+
+bool ChartWatcher::start(const std::string& dir, std::string* error) {
+#if defined(__linux__)
+    if (running_.load()) return true;
+    Impl& im = *impl_;
+
+    im.dir = dir;
+    while (im.dir.size() > 1 && im.dir.back() == '/') im.dir.pop_back();
+
+    im.inotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (im.inotifyFd < 0) {
+        if (error) *error = std::string("inotify_init1: ") + std::strerror(errno);
+        return false;
+    }
+    if (::inotify_add_watch(im.inotifyFd, im.dir.c_str(),
+                            IN_CLOSE_WRITE | IN_MOVED_TO | IN_MODIFY | IN_CREATE |
+                            IN_DELETE | IN_MOVED_FROM) < 0) {
+        if (error) *error = "cannot watch " + im.dir + ": " + std::strerror(errno);
+        ::close(im.inotifyFd);
+        im.inotifyFd = -1;
+        return false;
+    }
+    im.stopFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    im.stopping.store(false);
+    const int n = std::max(1, im.opt.workers);
+    for (int i = 0; i < n; i++) im.workers.emplace_back([&im, i] { im.workerLoop(i); });
+    im.watchThread = std::thread([&im] { im.watchLoop(); });
+
+    running_.store(true);
+    return true;
+#else
+    (void)dir;
+    if (error) *error = "directory watch mode needs inotify (Linux only)";
+    return false;
+#endif
+}
+
+void ChartWatcher::stop() {
+#if defined(__linux__)
+    if (!running_.exchange(false)) return;
+    Impl& im = *impl_;
+
+    im.stopping.store(true);
+    uint64_t one = 1;
+    (void)!::write(im.stopFd, &one, sizeof(one));
+    { std::lock_guard<std::mutex> lock(im.wakeMu); }
+    im.wakeCv.notify_all();
+
+    if (im.watchThread.joinable()) im.watchThread.join();
+    for (auto& t : im.workers) t.join();
+    im.workers.clear();
+
+    ::close(im.inotifyFd);
+    ::close(im.stopFd);
+    im.inotifyFd = im.stopFd = -1;
+#endif
+}
+
+// Headless: print one line per chart as soon as it is predicted.
+int runWatchMode(const std::string& dir, const WatchOptions& opt, const std::shared_ptr<ConfigStore>& config) {
+    Predictor predictor;
+    predictor.setConfidenceThreshold(60.0);
+    if (config) predictor.setConfigStore(config);
+
+    std::mutex printMu;
+    ChartWatcher watcher(predictor, opt, [&](const WatchResult& r) {
+        std::lock_guard<std::mutex> lock(printMu);
+        std::cout << std::filesystem::path(r.path).filename().string()
+                  << " tf=" << r.meta.tfMin << "m";
+        if (!r.ok) {
+            std::cout << " error=" << r.error;
+        } else {
+            const Prediction& p = r.prediction;
+            std::cout << " " << p.label << " " << p.signal
+                      << " conf=" << std::fixed << std::setprecision(1) << p.confidence
+                      << " pBull=" << std::setprecision(3) << p.pBull;
+            if (p.extractStride > 1) std::cout << " preview=" << p.extractStride;
+            if (p.signal != "NEUTRAL") {
+                std::cout << " stop=" << std::setprecision(4) << p.stopLoss
+                          << " t1=" << p.target1 << " rr=" << std::setprecision(2) << p.riskRewardRatio;
+            }
+        }
+        std::cout << " (" << std::fixed << std::setprecision(1) << r.latencyMs << " ms)" << std::endl;
+    });
+
+    std::string err;
+    if (!watcher.start(dir, &err)) {
+        std::cerr << "Watch failed: " << err << "\n";
+        return 1;
+    }
+    std::cout << "Watching " << dir << " with " << std::max(1, opt.workers)
+              << " worker(s). Ctrl+C to stop." << std::endl;
+
+    std::signal(SIGINT, onQuitSignal);
+    std::signal(SIGTERM, onQuitSignal);
+    while (!g_quit.load()) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    watcher.stop();
+    return 0;
+}
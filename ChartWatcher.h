@@ -0,0 +1,70 @@
+// ===============================
+// File: ChartWatcher.h
+// Watches a folder (inotify) and predicts chart PNGs as soon as they land.
+//
+//   ChartWatcher w(predictor, WatchOptions{}, [](const WatchResult& r) { ... });
+//   w.start("captures/");
+//
+// Files are dispatched on IN_CLOSE_WRITE / IN_MOVED_TO (writer is done).
+// Files that are only seen as modified are debounced: dispatched once their
+// size has been stable for debounceMs; deleted / moved-away files are forgotten.
+// Timeframe and price scale come from the filename (ChartMeta). Jobs go
+// through a lock-free queue to a pool of workers, each with its own Predictor
+// copy (predictWithTime is not reentrant on one instance).
+// Linux only; start() fails elsewhere.
+//
+// runWatchMode() is the headless loop on top of it (stockpredict_watch and
+// StockPredictGUI --watch): one line per chart on stdout until SIGINT/SIGTERM.
+// ===============================
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ChartMeta.h"
+#include "Predictor.h"
+
+struct WatchOptions {
+    int workers = 2;
+    int debounceMs = 30;          // quiet period for files modified but not yet closed
+    std::size_t queueCapacity = 256;
+    std::string extension = ".png";
+    int previewStride = 0;        // >1: stride-k preview first, full res only if it signals
+};
+
+struct WatchResult {
+    std::string path;
+    ChartMeta meta;
+    Prediction prediction;
+    bool ok = true;
+    std::string error;
+    double latencyMs = 0.0;       // filesystem event -> prediction ready
+};
+
+class ChartWatcher {
+public:
+    // Called from worker threads; must be thread-safe.
+    using Callback = std::function<void(const WatchResult&)>;
+
+    ChartWatcher(const Predictor& prototype, WatchOptions opt, Callback cb);
+    ~ChartWatcher();
+
+    ChartWatcher(const ChartWatcher&) = delete;
+    ChartWatcher& operator=(const ChartWatcher&) = delete;
+
+    bool start(const std::string& dir, std::string* error = nullptr);
+    void stop();
+    bool running() const { return running_.load(); }
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+    std::atomic<bool> running_{false};
+};
+
+// Returns the process exit code: 1 when the folder cannot be watched.
+int runWatchMode(const std::string& dir, const WatchOptions& opt,
+                 const std::shared_ptr<ConfigStore>& config = nullptr);
@@ -0,0 +1,348 @@
+// ===============================
+// File: DaemonProtocol.cpp
+// ===============================
+#include "DaemonProtocol.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace daemonproto {
+
+namespace {
+
+// Append/read plain values in host byte order
+class Writer {
+public:
+    explicit Writer(std::vector<uint8_t>& b) : buf_(b) {}
+    template <typename T> void put(T v) {
+        const auto* p = reinterpret_cast<const uint8_t*>(&v);
+        buf_.insert(buf_.end(), p, p + sizeof(T));
+    }
+    void bytes(const void* p, std::size_t n) {
+        const auto* b = static_cast<const uint8_t*>(p);
+        buf_.insert(buf_.end(), b, b + n);
+    }
+    void str8(const std::string& s) {
+        std::size_t n = std::min<std::size_t>(s.size(), 255);
+        put<uint8_t>((uint8_t)n);
+        bytes(s.data(), n);
+    }
+    void str16(const std::string& s) {
+        std::size_t n = std::min<std::size_t>(s.size(), 65535);
+        put<uint16_t>((uint16_t)n);
+        bytes(s.data(), n);
+    }
+
+private:
+    std::vector<uint8_t>& buf_;
+};
+
+class Reader {
+public:
+    Reader(const uint8_t* p, std::size_t n) : p_(p), end_(p + n) {}
+    template <typename T> bool get(T& v) {
+        if ((std::size_t)(end_ - p_) < sizeof(T)) return false;
+        std::memcpy(&v, p_, sizeof(T));
+        p_ += sizeof(T);
+        return true;
+    }
+    bool bytes(void* out, std::size_t n) {
+        if ((std::size_t)(end_ - p_) < n) return false;
+        std::memcpy(out, p_, n);
+        p_ += n;
+        return true;
+    }
+    bool str(std::string& s, std::size_t n) {
+        if ((std::size_t)(end_ - p_) < n) return false;
+        s.assign(reinterpret_cast<const char*>(p_), n);
+        p_ += n;
+        return true;
+    }
+    bool str8(std::string& s) { uint8_t n = 0; return get(n) && str(s, n); }
+    bool str16(std::string& s) { uint16_t n = 0; return get(n) && str(s, n); }
+    std::size_t remaining() const { return (std::size_t)(end_ - p_); }
+
+private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+};
+
+const char* kLabels[]  = {"Neutral", "Bullish", "Bearish"};
+const char* kSignals[] = {"NEUTRAL", "BUY", "STRONG_BUY", "SELL", "STRONG_SELL"};
+
+template <std::size_t N>
+uint8_t codeOf(const std::string& s, const char* (&table)[N]) {
+    for (std::size_t i = 0; i < N; i++) if (s == table[i]) return (uint8_t)i;
+    return 0;
+}
+
+std::vector<uint8_t> withHeader(uint32_t id, uint8_t kind, uint8_t status) {
+    std::vector<uint8_t> buf(sizeof(FrameHeader));
+    FrameHeader h;
+    h.requestId = id;
+    h.kind = kind;
+    h.status = status;
+    std::memcpy(buf.data(), &h, sizeof(h));
+    return buf;
+}
+
+void finishFrame(std::vector<uint8_t>& buf) {
+    uint32_t n = (uint32_t)(buf.size() - sizeof(FrameHeader));
+    std::memcpy(buf.data() + offsetof(FrameHeader, payloadBytes), &n, sizeof(n));
+}
+
+void putLevels(Writer& w, const std::vector<double>& lv) {
+    std::size_t n = std::min<std::size_t>(lv.size(), 255);
+    w.put<uint8_t>((uint8_t)n);
+    for (std::size_t i = 0; i < n; i++) w.put<double>(lv[i]);
+}
+
+bool getLevels(Reader& r, std::vector<double>& lv) {
+    uint8_t n = 0;
+    if (!r.get(n)) return false;
+    lv.resize(n);
+    for (auto& v : lv) if (!r.get(v)) return false;
+    return true;
+}
+
+} // namespace
+
+// ---------- requests ----------
+std::vector<uint8_t> encodeRequest(const Request& r) {
+    std::vector<uint8_t> buf = withHeader(r.id, (uint8_t)r.kind, 0);
+    Writer w(buf);
+
+    w.put<uint8_t>((uint8_t)std::max(0, std::min(255, r.tfMinutes)));
+    char hhmm[5] = {0, 0, 0, 0, 0};
+    std::memcpy(hhmm, r.timeStr.data(), std::min<std::size_t>(5, r.timeStr.size()));
+    w.bytes(hhmm, 5);
+    w.put<uint8_t>(r.hasScale ? 1 : 0);
+    w.put<double>(r.minPrice);
+    w.put<double>(r.maxPrice);
+
+    switch (r.kind) {
+    case Kind::Path:
+        w.put<uint32_t>((uint32_t)r.path.size());
+        w.bytes(r.path.data(), r.path.size());
+        break;
+    case Kind::Pixels:
+        w.put<uint32_t>((uint32_t)r.width);
+        w.put<uint32_t>((uint32_t)r.height);
+        w.bytes(r.rgba.data(), r.rgba.size());
+        break;
+    case Kind::Ohlcv:
+        w.put<uint32_t>((uint32_t)(r.ohlcv.size() / 5));
+        w.bytes(r.ohlcv.data(), (r.ohlcv.size() / 5) * 5 * sizeof(float));
+        break;
+    }
+    finishFrame(buf);
+    return buf;
+}
+
+bool decodeRequest(const FrameHeader& h, const uint8_t* payload, std::size_t n, Request& out) {
+    Reader r(payload, n);
+    out.id = h.requestId;
+    out.kind = (Kind)h.kind;
+
+    uint8_t tf = 0, scale = 0;
+    char hhmm[5];
+    if (!r.get(tf) || !r.bytes(hhmm, 5) || !r.get(scale) ||
+        !r.get(out.minPrice) || !r.get(out.maxPrice)) return false;
+    out.tfMinutes = tf ? (int)tf : -1;
+    out.timeStr.assign(hhmm, strnlen(hhmm, 5));
+    out.hasScale = scale != 0;
+
+    switch (out.kind) {
+    case Kind::Path: {
+        uint32_t len = 0;
+        return r.get(len) && r.str(out.path, len);
+    }
+    case Kind::Pixels: {
+        uint32_t w = 0, hgt = 0;
+        if (!r.get(w) || !r.get(hgt)) return false;
+        std::size_t bytes = (std::size_t)w * hgt * 4;
+        if (w == 0 || hgt == 0 || r.remaining() != bytes) return false;
+        out.width = (int)w;
+        out.height = (int)hgt;
+        out.rgba.resize(bytes);
+        return r.bytes(out.rgba.data(), bytes);
+    }
+    case Kind::Ohlcv: {
+        uint32_t bars = 0;
+        if (!r.get(bars) || r.remaining() != (std::size_t)bars * 5 * sizeof(float)) return false;
+        out.ohlcv.resize((std::size_t)bars * 5);
+        return r.bytes(out.ohlcv.data(), out.ohlcv.size() * sizeof(float));
+    }
+    }
+    return false;
+}
+
+// ---------- replies ----------
+std::vector<uint8_t> encodeReply(const Reply& r) {
+    std::vector<uint8_t> buf = withHeader(r.id, 0, r.ok ? 0 : 1);
+    Writer w(buf);
+    if (!r.ok) {
+        w.str16(r.error);
+        finishFrame(buf);
+        return buf;
+    }
+
+    const Prediction& p = r.prediction;
+    const FeatureBreakdown& bd = p.breakdown;
+    w.put<double>(p.pBull);
+    w.put<double>(p.confidence);
+    w.put<uint8_t>(codeOf(p.label, kLabels));
+    w.put<uint8_t>(codeOf(p.signal, kSignals));
+    uint8_t flags = (uint8_t)((p.tf1mBullish ? 1 : 0) | (p.tf5mBullish ? 2 : 0) | (p.tf30mBullish ? 4 : 0) |
+                              (p.hasActiveSupport ? 8 : 0) | (p.hasActiveResistance ? 16 : 0) |
+                              (bd.breakoutBuy ? 32 : 0));
+    w.put<uint8_t>(flags);
+    w.put<uint8_t>((uint8_t)p.confluence);
+
+    for (double v : {p.stopLoss, p.target1, p.target2, p.riskRewardRatio,
+                     p.activeSupport, p.activeResistance, p.distToSupport, p.distToResistance,
+                     bd.trendScore, bd.momentumScore, bd.reversalScore, bd.srScore, bd.rawScore,
+                     bd.breakoutScore, bd.breakoutLevel}) {
+        w.put<double>(v);
+    }
+    putLevels(w, p.supportLevels);
+    putLevels(w, p.resistanceLevels);
+    w.str8(p.buyType);
+
+    std::string pats;
+    for (std::size_t i = 0; i < bd.patterns.size(); i++) {
+        if (i) pats += '|';
+        pats += bd.patterns[i];
+    }
+    w.str16(pats);
+
+    finishFrame(buf);
+    return buf;
+}
+
+bool decodeReply(const FrameHeader& h, const uint8_t* payload, std::size_t n, Reply& out) {
+    Reader r(payload, n);
+    out.id = h.requestId;
+    out.ok = (h.status == 0);
+    out.prediction = Prediction{};
+    if (!out.ok) return r.str16(out.error);
+
+    Prediction& p = out.prediction;
+    FeatureBreakdown& bd = p.breakdown;
+    uint8_t label = 0, signal = 0, flags = 0, confluence = 0;
+    if (!r.get(p.pBull) || !r.get(p.confidence) || !r.get(label) || !r.get(signal) ||
+        !r.get(flags) || !r.get(confluence)) return false;
+    if (label > 2 || signal > 4) return false;
+    p.pBear = 1.0 - p.pBull;
+    p.label = kLabels[label];
+    p.signal = kSignals[signal];
+    p.tf1mBullish = flags & 1;
+    p.tf5mBullish = flags & 2;
+    p.tf30mBullish = flags & 4;
+    p.hasActiveSupport = flags & 8;
+    p.hasActiveResistance = flags & 16;
+    bd.breakoutBuy = flags & 32;
+    p.confluence = confluence;
+
+    for (double* v : {&p.stopLoss, &p.target1, &p.target2, &p.riskRewardRatio,
+                      &p.activeSupport, &p.activeResistance, &p.distToSupport, &p.distToResistance,
+                      &bd.trendScore, &bd.momentumScore, &bd.reversalScore, &bd.srScore, &bd.rawScore,
+                      &bd.breakoutScore, &bd.breakoutLevel}) {
+        if (!r.get(*v)) return false;
+    }
+    if (!getLevels(r, p.supportLevels) || !getLevels(r, p.resistanceLevels)) return false;
+    if (!r.str8(p.buyType)) return false;
+
+    std::string pats;
+    if (!r.str16(pats)) return false;
+    std::size_t start = 0;
+    while (start < pats.size()) {
+        std::size_t bar = pats.find('|', start);
+        if (bar == std::string::npos) bar = pats.size();
+        bd.patterns.push_back(pats.substr(start, bar - start));
+        start = bar + 1;
+    }
+    return true;
+}
+
+// ---------- socket helpers ----------
+bool writeAll(int fd, const void* data, std::size_t n) {
+    const auto* p = static_cast<const uint8_t*>(data);
+    while (n > 0) {
+        ssize_t k = ::send(fd, p, n, MSG_NOSIGNAL);
+        if (k < 0 && errno == EINTR) continue;
+        if (k <= 0) return false;
+        p += k;
+        n -= (std::size_t)k;
+    }
+    return true;
+}
+
+static bool readAll(int fd, void* data, std::size_t n) {
+    auto* p = static_cast<uint8_t*>(data);
+    while (n > 0) {
+        ssize_t k = ::recv(fd, p, n, 0);
+        if (k < 0 && errno == EINTR) continue;
+        if (k <= 0) return false;
+        p += k;
+        n -= (std::size_t)k;
+    }
+    return true;
+}
+
+bool readFrame(int fd, FrameHeader& h, std::vector<uint8_t>& payload) {
+    if (!readAll(fd, &h, sizeof(h))) return false;
+    if (h.magic != kMagic || h.payloadBytes > kMaxPayload) return false;
+    payload.resize(h.payloadBytes);
+    return readAll(fd, payload.data(), payload.size());
+}
+
+// ---------- client ----------
+Client::~Client() {
+    close();
+}
+
+bool Client::connect(const std::string& socketPath, std::string* error) {
+    close();
+    sockaddr_un addr{};
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        if (error) *error = "socket path too long";
+        return false;
+    }
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) {
+        if (error) *error = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+    if (::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        if (error) *error = "connect " + socketPath + ": " + std::strerror(errno);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void Client::close() {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+}
+
+bool Client::call(Request& req, Reply& reply) {
+    if (fd_ < 0) return false;
+    req.id = nextId_++;
+    std::vector<uint8_t> frame = encodeRequest(req);
+    if (!writeAll(fd_, frame.data(), frame.size())) return false;
+
+    FrameHeader h;
+    if (!readFrame(fd_, h, buf_) || h.requestId != req.id) return false;
+    return decodeReply(h, buf_.data(), buf_.size(), reply);
+}
+
+} // namespace daemonproto
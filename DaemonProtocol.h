@@ -0,0 +1,95 @@
+// ===============================
+// File: DaemonProtocol.h
+// Framed request/reply format for the local prediction daemon (stockpredictd)
+// plus a small blocking client.
+//
+// Frame = 16-byte header + payload. Integers/floats are in host byte order:
+// the socket is a Unix domain socket, so both ends are on the same machine.
+//
+// Request payload:
+//   u8  tfMinutes (0 = none)   char[5] "HH:MM"   u8 hasScale   f64 minPrice   f64 maxPrice
+//   Path:   u32 len, bytes
+//   Pixels: u32 width, u32 height, width*height*4 RGBA bytes
+//   Ohlcv:  u32 bars, bars*5 f32 (open, high, low, close, volume), oldest first
+//
+// Reply payload (status 0): compact Prediction (see encodeReply). status 1: u32 len + error text.
+// ===============================
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Predictor.h"
+
+namespace daemonproto {
+
+constexpr uint32_t kMagic = 0x31445053;              // "SPD1"
+constexpr uint32_t kMaxPayload = 256u * 1024u * 1024u;
+
+enum class Kind : uint8_t { Path = 1, Pixels = 2, Ohlcv = 3 };
+
+struct FrameHeader {
+    uint32_t magic = kMagic;
+    uint32_t payloadBytes = 0;
+    uint32_t requestId = 0;
+    uint8_t kind = 0;          // Kind for requests
+    uint8_t status = 0;        // replies: 0 ok, 1 error
+    uint16_t reserved = 0;
+};
+static_assert(sizeof(FrameHeader) == 16, "FrameHeader must stay 16 bytes");
+
+struct Request {
+    uint32_t id = 0;
+    Kind kind = Kind::Path;
+    int tfMinutes = -1;
+    std::string timeStr;                 // "HH:MM"
+    bool hasScale = false;
+    double minPrice = 0.0;
+    double maxPrice = 0.0;
+
+    std::string path;                    // Kind::Path
+    int width = 0, height = 0;           // Kind::Pixels
+    std::vector<unsigned char> rgba;
+    std::vector<float> ohlcv;            // Kind::Ohlcv, 5 per bar
+};
+
+struct Reply {
+    uint32_t id = 0;
+    bool ok = true;
+    std::string error;
+    Prediction prediction;
+};
+
+std::vector<uint8_t> encodeRequest(const Request& r);
+bool decodeRequest(const FrameHeader& h, const uint8_t* payload, std::size_t n, Request& out);
+
+std::vector<uint8_t> encodeReply(const Reply& r);
+bool decodeReply(const FrameHeader& h, const uint8_t* payload, std::size_t n, Reply& out);
+
+// Blocking socket helpers (EINTR-safe)
+bool writeAll(int fd, const void* data, std::size_t n);
+bool readFrame(int fd, FrameHeader& h, std::vector<uint8_t>& payload);
+
+// One connection, one request in flight.
+class Client {
+public:
+    Client() = default;
+    ~Client();
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    bool connect(const std::string& socketPath, std::string* error = nullptr);
+    void close();
+    bool connected() const { return fd_ >= 0; }
+
+    // false on transport failure; prediction errors come back in reply.ok/error
+    bool call(Request& req, Reply& reply);
+
+private:
+    int fd_ = -1;
+    uint32_t nextId_ = 1;
+    std::vector<uint8_t> buf_;
+};
+
+} // namespace daemonproto
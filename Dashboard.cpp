@@ -0,0 +1,425 @@
+// ===============================
+// File: Dashboard.cpp
+// ===============================
+#include "Dashboard.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ChartMeta.h"
+#include "ImageDecode.h"
+#include "Trace.h"
+
+namespace fs = std::filesystem;
+using DashClock = std::chrono::steady_clock;
+
+namespace {
+
+struct Cell {
+    std::string path;
+    std::string symbol;
+    ChartMeta meta;
+    unsigned atlasX = 0, atlasY = 0;
+
+    // --- guarded by Impl::mu ---
+    bool busy = false;
+    DashClock::time_point due{};
+    fs::file_time_type mtime{};
+    std::uintmax_t fileSize = 0;
+    std::string scoredAt;                 // HH:MM the last result was computed for
+    bool haveResult = false;
+    bool thumbReady = false;              // new thumbnail waiting for upload
+    bool resultReady = false;             // new signal waiting for the badge/label
+    std::vector<unsigned char> thumb;     // thumbWidth*thumbHeight RGBA
+    Prediction pred;
+    std::string error;
+
+    // --- GUI thread only ---
+    sf::Text label;
+};
+
+// Area-average shrink of a whole chart into a w x h RGBA tile. Aspect ratio is
+// kept; the unused band is filled with the background colour.
+void shrinkInto(const ImageView& src, int w, int h, std::vector<unsigned char>& out) {
+    out.assign((std::size_t)w * h * 4, 0);
+    for (std::size_t i = 0; i < out.size(); i += 4) {
+        out[i] = out[i + 1] = out[i + 2] = 18;
+        out[i + 3] = 255;
+    }
+    if (src.empty()) return;
+
+    const double scale = std::min((double)w / src.width, (double)h / src.height);
+    const int dw = std::max(1, (int)(src.width * scale));
+    const int dh = std::max(1, (int)(src.height * scale));
+    const int ox = (w - dw) / 2, oy = (h - dh) / 2;
+    const int ri = src.rIndex(), bi = src.bIndex();
+
+    for (int ty = 0; ty < dh; ty++) {
+        const int y0 = (int)((long long)ty * src.height / dh);
+        const int y1 = std::max(y0 + 1, (int)((long long)(ty + 1) * src.height / dh));
+        for (int tx = 0; tx < dw; tx++) {
+            const int x0 = (int)((long long)tx * src.width / dw);
+            const int x1 = std::max(x0 + 1, (int)((long long)(tx + 1) * src.width / dw));
+            unsigned r = 0, g = 0, b = 0, n = 0;
+            for (int y = y0; y < y1; y++) {
+                const unsigned char* p = src.at(x0, y);
+                for (int x = x0; x < x1; x++, p += 4) {
+                    r += p[ri];
+                    g += p[1];
+                    b += p[bi];
+                    n++;
+                }
+            }
+            unsigned char* d = &out[((std::size_t)(oy + ty) * w + (ox + tx)) * 4];
+            d[0] = (unsigned char)(r / n);
+            d[1] = (unsigned char)(g / n);
+            d[2] = (unsigned char)(b / n);
+        }
+    }
+}
+
+sf::Color badgeColor(const Cell& c) {
+    if (!c.error.empty()) return sf::Color(150, 40, 150);
+    if (!c.haveResult) return sf::Color(60, 60, 60);
+    const std::string& s = c.pred.signal;
+    if (s == "STRONG_BUY") return sf::Color(0, 200, 80);
+    if (s == "BUY") return sf::Color(60, 150, 70);
+    if (s == "SELL") return sf::Color(170, 70, 50);
+    if (s == "STRONG_SELL") return sf::Color(230, 40, 40);
+    return sf::Color(110, 110, 110);
+}
+
+std::string tfText(int tf) { return tf > 0 ? std::to_string(tf) + "m" : "?"; }
+
+std::string labelText(const Cell& c) {
+    std::string s = c.symbol + " " + tfText(c.meta.tfMin) + "  ";
+    if (!c.error.empty()) return s + "ERROR";
+    if (!c.haveResult) return s + "...";
+    char conf[16];
+    std::snprintf(conf, sizeof(conf), " %.0f%%", c.pred.confidence);
+    return s + c.pred.signal + conf;
+}
+
+void setQuad(sf::VertexArray& va, std::size_t i, float x, float y, float w, float h) {
+    va[i * 4 + 0].position = {x, y};
+    va[i * 4 + 1].position = {x + w, y};
+    va[i * 4 + 2].position = {x + w, y + h};
+    va[i * 4 + 3].position = {x, y + h};
+}
+
+} // namespace
+
+struct Dashboard::Impl {
+    Predictor prototype;
+    const sf::Font& font;
+    DashboardOptions opt;
+
+    std::vector<Cell> cells;
+    sf::Texture atlas;
+    sf::VertexArray thumbs{sf::Quads};
+    sf::VertexArray badges{sf::Quads};
+    sf::FloatRect bounds{0.f, 0.f, 960.f, 640.f};
+    unsigned labelSize = 12;
+    bool labelsBelow = true;
+
+    mutable std::mutex mu;
+    std::condition_variable cv;
+    std::vector<std::thread> workers;
+    std::atomic<bool> stopping{false};
+    std::vector<std::size_t> uploads;   // GUI-side scratch: cells taken this frame
+    std::vector<unsigned char> staging; // GUI-side copy of one thumbnail
+
+    Impl(const Predictor& p, const sf::Font& f, DashboardOptions o) : prototype(p), font(f), opt(std::move(o)) {}
+
+    void scan() {
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(opt.dir, ec)) {
+            if (!entry.is_regular_file()) continue;
+            const std::string ext = entry.path().extension().string();
+            if (ext != ".png" && ext != ".ppm" && ext != ".pgm") continue;
+            Cell c;
+            c.path = entry.path().string();
+            const std::string stem = entry.path().stem().string();
+            c.symbol = stem.substr(0, stem.find('_'));
+            c.meta = parseMetaFromFilename(c.path);
+            cells.push_back(std::move(c));
+        }
+        std::sort(cells.begin(), cells.end(), [](const Cell& a, const Cell& b) {
+            return a.symbol != b.symbol ? a.symbol < b.symbol : a.meta.tfMin < b.meta.tfMin;
+        });
+    }
+
+    bool buildAtlas(std::string* error) {
+        const unsigned maxTex = sf::Texture::getMaximumSize();
+        // Shrink the tiles until the atlas fits (a few hundred charts at 192x128 do).
+        for (;;) {
+            const unsigned cols = std::max(1u, maxTex / (unsigned)opt.thumbWidth);
+            const unsigned rows = (unsigned)((cells.size() + cols - 1) / cols);
+            if (rows * (unsigned)opt.thumbHeight <= maxTex) break;
+            if (opt.thumbWidth <= 32) {
+                if (error) *error = "too many charts for one atlas texture";
+                return false;
+            }
+            opt.thumbWidth = opt.thumbWidth * 3 / 4;
+            opt.thumbHeight = opt.thumbHeight * 3 / 4;
+        }
+
+        const unsigned tw = (unsigned)opt.thumbWidth, th = (unsigned)opt.thumbHeight;
+        unsigned cols = (unsigned)std::ceil(std::sqrt((double)cells.size()));
+        cols = std::min(cols, maxTex / tw);
+        const unsigned rows = (unsigned)((cells.size() + cols - 1) / cols);
+        if (!atlas.create(cols * tw, rows * th)) {
+            if (error) *error = "could not create atlas texture";
+            return false;
+        }
+        atlas.setSmooth(true);
+
+        std::vector<unsigned char> blank;
+        shrinkInto(ImageView(), (int)tw, (int)th, blank);
+        for (std::size_t i = 0; i < cells.size(); i++) {
+            Cell& c = cells[i];
+            c.atlasX = (unsigned)(i % cols) * tw;
+            c.atlasY = (unsigned)(i / cols) * th;
+            atlas.update(blank.data(), tw, th, c.atlasX, c.atlasY);
+        }
+
+        thumbs.resize(cells.size() * 4);
+        badges.resize(cells.size() * 4);
+        for (std::size_t i = 0; i < cells.size(); i++) {
+            const float u = (float)cells[i].atlasX, v = (float)cells[i].atlasY;
+            thumbs[i * 4 + 0].texCoords = {u, v};
+            thumbs[i * 4 + 1].texCoords = {u + tw, v};
+            thumbs[i * 4 + 2].texCoords = {u + tw, v + th};
+            thumbs[i * 4 + 3].texCoords = {u, v + th};
+            for (int k = 0; k < 4; k++) badges[i * 4 + k].color = badgeColor(cells[i]);
+            cells[i].label.setFont(font);
+            cells[i].label.setString(labelText(cells[i]));
+        }
+        return true;
+    }
+
+    // Columns chosen so the tiles come out as large as possible in `bounds`.
+    void relayout() {
+        const std::size_t n = cells.size();
+        if (n == 0) return;
+        const float gap = 6.f;
+        const float aspect = (float)opt.thumbHeight / (float)opt.thumbWidth;
+
+        float bestW = 0.f;
+        std::size_t bestCols = 1;
+        for (std::size_t cols = 1; cols <= n; cols++) {
+            const std::size_t rows = (n + cols - 1) / cols;
+            const float cellW = (bounds.width - gap * (cols - 1)) / cols;
+            const float cellH = (bounds.height - gap * (rows - 1)) / rows;
+            // cell = thumb + badge strip (~18% of the thumb height)
+            const float w = std::min(cellW, cellH / (aspect * 1.18f));
+            if (w > bestW) {
+                bestW = w;
+                bestCols = cols;
+            }
+        }
+
+        const float tw = std::max(8.f, bestW);
+        const float th = tw * aspect;
+        const float strip = std::max(4.f, th * 0.18f);
+        labelSize = (unsigned)std::clamp(strip * 0.8f, 8.f, 16.f);
+        labelsBelow = strip >= 9.f;
+
+        for (std::size_t i = 0; i < n; i++) {
+            const float x = bounds.left + (float)(i % bestCols) * (tw + gap);
+            const float y = bounds.top + (float)(i / bestCols) * (th + strip + gap);
+            setQuad(thumbs, i, x, y, tw, th);
+            setQuad(badges, i, x, y + th, tw, strip);
+            sf::Text& t = cells[i].label;
+            t.setCharacterSize(labelSize);
+            t.setPosition(x + 3.f, y + th + (strip - labelSize) * 0.5f - 1.f);
+        }
+    }
+
+    void startWorkers() {
+        int n = opt.workers;
+        if (n <= 0) n = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+        n = std::min<int>(n, (int)std::max<std::size_t>(1, cells.size()));
+        for (int i = 0; i < n; i++) workers.emplace_back([this] { workerLoop(); });
+    }
+
+    // Soonest-due idle cell, or cells.size() if none is due yet (next = when to look again).
+    std::size_t pickDue(DashClock::time_point now, DashClock::time_point& next) const {
+        std::size_t best = cells.size();
+        next = now + std::chrono::milliseconds(opt.refreshMs);
+        for (std::size_t i = 0; i < cells.size(); i++) {
+            const Cell& c = cells[i];
+            if (c.busy) continue;
+            if (c.due <= now) {
+                if (best == cells.size() || c.due < cells[best].due) best = i;
+            } else {
+                next = std::min(next, c.due);
+            }
+        }
+        return best;
+    }
+
+    void workerLoop() {
+        Predictor predictor = prototype;   // predict* is not reentrant on one instance
+        predictor.setOutputs(kPredictSignal);   // a cell only shows signal + confidence
+        PixelBuffer pixels;
+        std::vector<unsigned char> thumb;
+
+        std::unique_lock<std::mutex> lk(mu);
+        while (!stopping.load()) {
+            DashClock::time_point next;
+            const std::size_t idx = pickDue(DashClock::now(), next);
+            if (idx == cells.size()) {
+                cv.wait_until(lk, next);
+                continue;
+            }
+            Cell& c = cells[idx];
+            c.busy = true;
+            const std::string path = c.path;
+            const ChartMeta meta = c.meta;
+            const fs::file_time_type lastMtime = c.mtime;
+            const std::uintmax_t lastSize = c.fileSize;
+            const std::string lastScoredAt = c.scoredAt;
+            const bool hadResult = c.haveResult;
+            lk.unlock();
+
+            std::error_code ec;
+            const fs::file_time_type mtime = fs::last_write_time(path, ec);
+            const std::uintmax_t size = ec ? 0 : fs::file_size(path, ec);
+            const std::string timeStr = nowHHMM();
+            // same file, same minute -> same answer; the time-of-day filter is per minute
+            const bool unchanged = hadResult && !ec && mtime == lastMtime && size == lastSize;
+            const bool rescore = !unchanged || timeStr != lastScoredAt;
+
+            Prediction p;
+            std::string err;
+            bool fresh = false;
+            if (rescore) {
+                TRACE_SCOPE("dashboard.refresh");
+                if (!decodeImageFile(path, pixels, &err)) {
+                    err = "Could not load image: " + path + " (" + err + ")";
+                } else {
+                    if (!unchanged) {
+                        shrinkInto(pixels.view(), opt.thumbWidth, opt.thumbHeight, thumb);
+                        fresh = true;
+                    }
+                    try {
+                        p = predictor.predictImage(pixels.view(), timeStr, meta.tfMin, meta.hasScale,
+                                                   meta.minPrice, meta.maxPrice);
+                    } catch (const std::exception& e) {
+                        err = e.what();
+                    }
+                }
+            }
+
+            lk.lock();
+            c.busy = false;
+            c.due = DashClock::now() + std::chrono::milliseconds(opt.refreshMs);
+            if (!rescore) continue;
+            c.mtime = mtime;
+            c.fileSize = size;
+            c.scoredAt = timeStr;
+            if (fresh) {
+                c.thumb.swap(thumb);
+                c.thumbReady = true;
+            }
+            c.error = err;
+            if (err.empty()) {
+                c.pred = std::move(p);
+                c.haveResult = true;
+            }
+            c.resultReady = true;
+        }
+    }
+
+    bool update() {
+        if (cells.empty()) return false;
+        bool changed = false;
+        std::size_t budget = (std::size_t)std::max(1, opt.uploadsPerFrame);
+
+        std::unique_lock<std::mutex> lk(mu);
+        for (std::size_t i = 0; i < cells.size(); i++) {
+            Cell& c = cells[i];
+            if (c.resultReady) {
+                c.resultReady = false;
+                const sf::Color col = badgeColor(c);
+                for (int k = 0; k < 4; k++) badges[i * 4 + k].color = col;
+                c.label.setString(labelText(c));
+                changed = true;
+            }
+            if (c.thumbReady && budget > 0) {
+                // copy out under the lock, upload after releasing it
+                c.thumbReady = false;
+                staging.assign(c.thumb.begin(), c.thumb.end());
+                budget--;
+                lk.unlock();
+                atlas.update(staging.data(), (unsigned)opt.thumbWidth, (unsigned)opt.thumbHeight,
+                             c.atlasX, c.atlasY);
+                changed = true;
+                lk.lock();
+            }
+        }
+        return changed;
+    }
+};
+
+Dashboard::Dashboard(const Predictor& prototype, const sf::Font& font, DashboardOptions opt)
+    : impl_(std::make_unique<Impl>(prototype, font, std::move(opt))) {}
+
+Dashboard::~Dashboard() { stop(); }
+
+bool Dashboard::start(std::string* error) {
+    if (!impl_->workers.empty()) return true;
+    impl_->scan();
+    if (impl_->cells.empty()) {
+        if (error) *error = "no charts in " + impl_->opt.dir;
+        return false;
+    }
+    if (!impl_->buildAtlas(error)) return false;
+    impl_->relayout();
+    impl_->stopping.store(false);
+    impl_->startWorkers();
+    return true;
+}
+
+void Dashboard::stop() {
+    {
+        std::lock_guard<std::mutex> lk(impl_->mu);
+        impl_->stopping.store(true);
+    }
+    impl_->cv.notify_all();
+    for (auto& t : impl_->workers) t.join();
+    impl_->workers.clear();
+}
+
+bool Dashboard::update() { return impl_->update(); }
+
+void Dashboard::setBounds(const sf::FloatRect& area) {
+    impl_->bounds = area;
+    impl_->relayout();
+}
+
+void Dashboard::draw(sf::RenderTarget& target) const {
+    if (impl_->cells.empty()) return;
+    target.draw(impl_->thumbs, sf::RenderStates(&impl_->atlas));
+    target.draw(impl_->badges);
+    if (!impl_->labelsBelow) return;   // tiles too small for readable text; colours only
+    for (const Cell& c : impl_->cells) target.draw(c.label);
+}
+
+std::size_t Dashboard::size() const { return impl_->cells.size(); }
+
+std::size_t Dashboard::scored() const {
+    std::lock_guard<std::mutex> lk(impl_->mu);
+    std::size_t n = 0;
+    for (const Cell& c : impl_->cells) n += c.haveResult ? 1 : 0;
+    return n;
+}
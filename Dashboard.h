@@ -0,0 +1,53 @@
+// ===============================
+// File: Dashboard.h
+// Watchlist grid for the GUI: every chart in a directory (symbol x timeframe)
+// as a thumbnail with its latest signal badge.
+//   - worker threads (own Predictor copies) decode, shrink and score charts in
+//     the background, re-checking each one every refreshMs
+//   - thumbnails live in one texture atlas; all cells are a single textured
+//     vertex array, badges a second untextured one -> two draw calls + labels
+//   - update() on the GUI thread only uploads what changed, a few cells per frame
+// ===============================
+#pragma once
+#include <SFML/Graphics.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "Predictor.h"
+
+struct DashboardOptions {
+    std::string dir = "assets/charts";
+    int workers = 0;            // 0 = hardware_concurrency - 1 (at least 1)
+    int refreshMs = 2000;       // re-check each chart this often (skipped if the file is unchanged)
+    int thumbWidth = 192;       // atlas resolution per cell; drawn scaled to fit the grid
+    int thumbHeight = 128;
+    int uploadsPerFrame = 8;    // atlas updates per update() call
+};
+
+class Dashboard {
+public:
+    Dashboard(const Predictor& prototype, const sf::Font& font, DashboardOptions opt = {});
+    ~Dashboard();
+
+    Dashboard(const Dashboard&) = delete;
+    Dashboard& operator=(const Dashboard&) = delete;
+
+    // Scans opt.dir, builds the atlas and starts the workers.
+    bool start(std::string* error = nullptr);
+    void stop();
+
+    // GUI thread, once per frame. Returns true if anything visible changed.
+    bool update();
+
+    void setBounds(const sf::FloatRect& area);
+    void draw(sf::RenderTarget& target) const;
+
+    std::size_t size() const;
+    std::size_t scored() const;   // cells with at least one result
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
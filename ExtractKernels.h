@@ -0,0 +1,179 @@
+// ===============================
+// File: ExtractKernels.h
+// The pixel scans behind Predictor::extractCloseSeries / extractVolumeSeries,
+// templated on where the colours come from and on the pixel format:
+//   - DynamicColors: whatever the Predictor / layout holds at runtime (the
+//     fallback, works for any colours)
+//   - ThemeColors<Theme>: a registered theme; every target colour and the
+//     tolerance are compile-time constants
+// Pixel format is a template parameter too, so the channel offsets are fixed.
+// Both instantiate the same loops and give identical results; the theme ones
+// let the compiler fold each colour test into constant range checks.
+//
+// Scans go row by row with one tally per column (the image is stored by rows,
+// the old column-by-column walk jumped a whole row per pixel).
+// ===============================
+#pragma once
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+#include "ChartLayout.h"
+#include "ImageView.h"
+
+// ---------- themes ----------
+// Candle colours plus the volume bar colours that go with them.
+struct DefaultTheme {   // Predictor's ColorConfig / ChartLayout defaults
+    static constexpr const char* name = "default";
+    static constexpr RGB bull{40, 220, 140}, bear{220, 60, 220};
+    static constexpr int tolerance = 45;
+    static constexpr RGB volUp{0, 200, 120}, volDown{200, 60, 60};
+    static constexpr int volTolerance = 70;
+};
+
+struct TradingViewTheme {
+    static constexpr const char* name = "tradingview";
+    static constexpr RGB bull{38, 166, 154}, bear{239, 83, 80};
+    static constexpr int tolerance = 45;
+    static constexpr RGB volUp{38, 166, 154}, volDown{239, 83, 80};
+    static constexpr int volTolerance = 70;
+};
+
+template <class... Themes>
+struct ThemeList {};
+
+// add a theme here to get specialized scans for it (and Predictor::setColorTheme)
+using RegisteredThemes = ThemeList<DefaultTheme, TradingViewTheme>;
+
+// ---------- colour sources ----------
+constexpr bool nearRGB(int r, int g, int b, RGB t, int tol) {
+    return (r - t.r <= tol && t.r - r <= tol) && (g - t.g <= tol && t.g - g <= tol) &&
+           (b - t.b <= tol && t.b - b <= tol);
+}
+
+struct DynamicColors {
+    RGB a, b;   // bull/bear or volume up/down
+    int tol = 0;
+    bool isA(int r, int g, int bl) const { return nearRGB(r, g, bl, a, tol); }
+    bool isB(int r, int g, int bl) const { return nearRGB(r, g, bl, b, tol); }
+};
+
+template <class Theme>
+struct ThemeColors {
+    static bool isA(int r, int g, int b) { return nearRGB(r, g, b, Theme::bull, Theme::tolerance); }
+    static bool isB(int r, int g, int b) { return nearRGB(r, g, b, Theme::bear, Theme::tolerance); }
+};
+
+template <class Theme>
+struct ThemeVolumeColors {
+    static bool isA(int r, int g, int b) { return nearRGB(r, g, b, Theme::volUp, Theme::volTolerance); }
+    static bool isB(int r, int g, int b) { return nearRGB(r, g, b, Theme::volDown, Theme::volTolerance); }
+};
+
+constexpr bool sameRGB(RGB x, RGB y) { return x.r == y.r && x.g == y.g && x.b == y.b; }
+
+// Calls fn(ThemeColors<T>{}) for the first registered theme whose candle
+// colours match c; false when none does.
+template <class Fn, class... Themes>
+bool withCandleTheme(const DynamicColors& c, ThemeList<Themes...>, Fn&& fn) {
+    return ((sameRGB(c.a, Themes::bull) && sameRGB(c.b, Themes::bear) && c.tol == Themes::tolerance
+                 ? (fn(ThemeColors<Themes>{}), true)
+                 : false) || ...);
+}
+
+template <class Fn, class... Themes>
+bool withVolumeTheme(const DynamicColors& c, ThemeList<Themes...>, Fn&& fn) {
+    return ((sameRGB(c.a, Themes::volUp) && sameRGB(c.b, Themes::volDown) && c.tol == Themes::volTolerance
+                 ? (fn(ThemeVolumeColors<Themes>{}), true)
+                 : false) || ...);
+}
+
+// ---------- kernels ----------
+// Close per sampled column of rect (already clipped to the image): the top of
+// the bull pixels if they are the majority, else the bottom of the bear ones;
+// -1 when the column has neither. Normalized 0..1 (1 = top of rect).
+template <class Colors, int RI, int BI>
+void scanCloseColumns(const ImageView& img, const PixelRect& rect, int k, const Colors& colors,
+                      std::vector<int>& work, std::vector<float>& out) {
+    const int cols = rect.x1 > rect.x0 ? (rect.x1 - rect.x0 + k - 1) / k : 0;
+    out.clear();
+    if (cols == 0) return;
+    work.assign((size_t)cols * 4, 0);
+    int* bullCount = work.data();
+    int* bearCount = bullCount + cols;
+    int* bullMinY = bearCount + cols;
+    int* bearMaxY = bullMinY + cols;
+    std::fill(bullMinY, bullMinY + cols, INT_MAX);
+    std::fill(bearMaxY, bearMaxY + cols, -1);
+
+    for (int y = rect.y0; y < rect.y1; y += k) {
+        const unsigned char* p = img.at(rect.x0, y);
+        for (int i = 0; i < cols; i++, p += 4 * k) {
+            const int r = p[RI], g = p[1], b = p[BI];
+            const bool bull = colors.isA(r, g, b);
+            const bool bear = !bull && colors.isB(r, g, b);
+            bullCount[i] += bull;
+            bearCount[i] += bear;
+            // rows ascend, so the last bear hit is the max
+            bullMinY[i] = bull ? std::min(bullMinY[i], y) : bullMinY[i];
+            bearMaxY[i] = bear ? y : bearMaxY[i];
+        }
+    }
+
+    out.resize((size_t)cols);
+    const float h = (float)(rect.y1 - rect.y0);
+    for (int i = 0; i < cols; i++) {
+        if (bullCount[i] == 0 && bearCount[i] == 0) {
+            out[i] = -1.f;
+            continue;
+        }
+        const int closeY = bullCount[i] >= bearCount[i] ? bullMinY[i] : bearMaxY[i];
+        const float norm = 1.f - (float)(closeY - rect.y0) / h;
+        out[i] = std::min(1.f, std::max(0.f, norm));
+    }
+}
+
+// Volume bar height per sampled column of rect: the first run of bar-coloured
+// pixels met scanning up from the bottom row (rect.y1 - 1), as a fraction of
+// the panel height.
+template <class Colors, int RI, int BI>
+void scanVolumeColumns(const ImageView& img, const PixelRect& rect, int k, const Colors& colors,
+                       std::vector<int>& work, std::vector<float>& out) {
+    const int cols = rect.x1 > rect.x0 ? (rect.x1 - rect.x0 + k - 1) / k : 0;
+    out.clear();
+    if (cols == 0) return;
+    work.assign((size_t)cols * 3, 0);
+    int* height = work.data();
+    int* started = height + cols;
+    int* done = started + cols;
+
+    for (int y = rect.y1 - 1; y >= rect.y0; y -= k) {
+        const unsigned char* p = img.at(rect.x0, y);
+        for (int i = 0; i < cols; i++, p += 4 * k) {
+            const int r = p[RI], g = p[1], b = p[BI];
+            const int hit = colors.isA(r, g, b) || colors.isB(r, g, b);
+            height[i] += k & -(hit & !done[i]);
+            done[i] |= started[i] & !hit;
+            started[i] |= hit;
+        }
+    }
+
+    out.resize((size_t)cols);
+    const double panelH = std::max(1, rect.y1 - 1 - rect.y0);
+    for (int i = 0; i < cols; i++) out[i] = (float)std::min(1.0, std::max(0.0, height[i] / panelH));
+}
+
+// Pixel format picked at runtime, everything below it fixed.
+template <class Colors>
+void scanClose(const ImageView& img, const PixelRect& rect, int k, const Colors& colors,
+               std::vector<int>& work, std::vector<float>& out) {
+    if (img.format == PixelFormat::BGRA8) scanCloseColumns<Colors, 2, 0>(img, rect, k, colors, work, out);
+    else scanCloseColumns<Colors, 0, 2>(img, rect, k, colors, work, out);
+}
+
+template <class Colors>
+void scanVolume(const ImageView& img, const PixelRect& rect, int k, const Colors& colors,
+                std::vector<int>& work, std::vector<float>& out) {
+    if (img.format == PixelFormat::BGRA8) scanVolumeColumns<Colors, 2, 0>(img, rect, k, colors, work, out);
+    else scanVolumeColumns<Colors, 0, 2>(img, rect, k, colors, work, out);
+}
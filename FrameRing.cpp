@@ -0,0 +1,333 @@
+// ===============================
+// File: FrameRing.cpp
+// ===============================
+#include "FrameRing.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <ctime>
+#endif
+
+namespace {
+
+constexpr uint32_t kRingMagic = 0x474E5246;   // "FRNG"
+constexpr uint32_t kRingVersion = 1;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring needs lock-free 64-bit atomics");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "ring needs lock-free 32-bit atomics");
+
+struct alignas(64) RingHeader {
+    std::atomic<uint32_t> magic;       // written last by the creator
+    uint32_t version;
+    uint32_t slots;
+    uint32_t slotBytes;                // pixel bytes per slot
+    uint64_t slotStride;               // SlotHeader + pixels, 64-byte aligned
+    alignas(64) std::atomic<uint64_t> writeSeq;   // frames published so far
+    alignas(64) std::atomic<uint32_t> wake;       // futex word, bumped per publish
+};
+
+struct alignas(64) SlotHeader {
+    std::atomic<uint64_t> seq;         // odd while being written, else 2*(frameIndex+1)
+    char symbol[32];
+    int32_t tfMinutes;
+    int32_t width;
+    int32_t height;
+    uint32_t stride;
+    uint32_t format;
+    int64_t captureNs;
+};
+
+inline uint64_t align64(uint64_t v) { return (v + 63) & ~uint64_t(63); }
+
+inline const RingHeader* header(const unsigned char* base) {
+    return reinterpret_cast<const RingHeader*>(base);
+}
+
+inline const SlotHeader* slotAt(const unsigned char* base, uint64_t index) {
+    const RingHeader* h = header(base);
+    return reinterpret_cast<const SlotHeader*>(base + align64(sizeof(RingHeader)) +
+                                               (index % h->slots) * h->slotStride);
+}
+
+bool fail(std::string* error, const std::string& msg) {
+    if (error) *error = msg;
+    return false;
+}
+
+std::string shmName(const std::string& name) {
+    return (!name.empty() && name[0] == '/') ? name : "/" + name;
+}
+
+#if defined(__linux__)
+void futexWake(const std::atomic<uint32_t>* word) {
+    syscall(SYS_futex, reinterpret_cast<const uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+// false on EFAULT etc. so callers can fall back to a plain sleep
+bool futexWait(const std::atomic<uint32_t>* word, uint32_t expected, int timeoutMs) {
+    timespec ts{timeoutMs / 1000, (long)(timeoutMs % 1000) * 1000000L};
+    long rc = syscall(SYS_futex, reinterpret_cast<const uint32_t*>(word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+    return rc == 0 || errno == EAGAIN || errno == ETIMEDOUT || errno == EINTR;
+}
+#endif
+
+} // namespace
+
+int64_t frameClockNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ---------- writer ----------
+std::unique_ptr<FrameRingWriter> FrameRingWriter::create(const std::string& name, const FrameRingConfig& cfg,
+                                                         std::string* error) {
+#if defined(__linux__)
+    if (cfg.slots < 2 || cfg.maxWidth <= 0 || cfg.maxHeight <= 0) {
+        fail(error, "bad ring config");
+        return nullptr;
+    }
+    const uint64_t slotBytes = (uint64_t)cfg.maxWidth * cfg.maxHeight * 4;
+    if (slotBytes > 0xFFFFFFFFull) {
+        fail(error, "slot too large");
+        return nullptr;
+    }
+    const uint64_t slotStride = align64(sizeof(SlotHeader)) + align64(slotBytes);
+    const uint64_t total = align64(sizeof(RingHeader)) + slotStride * cfg.slots;
+
+    const std::string path = shmName(name);
+    shm_unlink(path.c_str());   // stale segment from a crashed producer
+    int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        fail(error, "shm_open(" + path + "): " + std::strerror(errno));
+        return nullptr;
+    }
+    if (ftruncate(fd, (off_t)total) != 0) {
+        fail(error, std::string("ftruncate: ") + std::strerror(errno));
+        ::close(fd);
+        shm_unlink(path.c_str());
+        return nullptr;
+    }
+    void* mem = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mem == MAP_FAILED) {
+        fail(error, std::string("mmap: ") + std::strerror(errno));
+        shm_unlink(path.c_str());
+        return nullptr;
+    }
+
+    unsigned char* base = static_cast<unsigned char*>(mem);
+    // fresh segment is zero-filled; atomics just need constructing in place
+    RingHeader* h = new (base) RingHeader();
+    h->version = kRingVersion;
+    h->slots = cfg.slots;
+    h->slotBytes = (uint32_t)slotBytes;
+    h->slotStride = slotStride;
+    h->writeSeq.store(0, std::memory_order_relaxed);
+    h->wake.store(0, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < cfg.slots; i++) {
+        new (base + align64(sizeof(RingHeader)) + i * slotStride) SlotHeader();
+    }
+    h->magic.store(kRingMagic, std::memory_order_release);
+
+    std::unique_ptr<FrameRingWriter> w(new FrameRingWriter());
+    w->name_ = path;
+    w->base_ = base;
+    w->size_ = total;
+    return w;
+#else
+    (void)name; (void)cfg;
+    fail(error, "shared-memory frame ring is only implemented on Linux");
+    return nullptr;
+#endif
+}
+
+FrameRingWriter::~FrameRingWriter() {
+#if defined(__linux__)
+    if (base_) munmap(base_, size_);
+    if (!name_.empty()) shm_unlink(name_.c_str());
+#endif
+}
+
+bool FrameRingWriter::publish(const std::string& symbol, int tfMinutes, const ImageView& img, std::string* error) {
+    TRACE_SCOPE("framePublish");
+    RingHeader* h = reinterpret_cast<RingHeader*>(base_);
+    const uint64_t rowBytes = (uint64_t)img.width * 4;
+    if (img.empty()) return fail(error, "empty frame");
+    if (rowBytes * (uint64_t)img.height > h->slotBytes) return fail(error, "frame larger than ring slot");
+
+    const uint64_t index = next_;
+    SlotHeader* s = const_cast<SlotHeader*>(slotAt(base_, index));
+    unsigned char* pixels = reinterpret_cast<unsigned char*>(s) + align64(sizeof(SlotHeader));
+
+    s->seq.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memset(s->symbol, 0, sizeof(s->symbol));
+    std::memcpy(s->symbol, symbol.data(), std::min(symbol.size(), sizeof(s->symbol) - 1));
+    s->tfMinutes = tfMinutes;
+    s->width = img.width;
+    s->height = img.height;
+    s->stride = (uint32_t)rowBytes;
+    s->format = (uint32_t)img.format;
+    s->captureNs = frameClockNs();
+    if (img.stride == rowBytes) {
+        std::memcpy(pixels, img.data, rowBytes * (uint64_t)img.height);
+    } else {
+        for (int y = 0; y < img.height; y++) std::memcpy(pixels + y * rowBytes, img.row(y), rowBytes);
+    }
+
+    s->seq.store(2 * (index + 1), std::memory_order_release);
+    h->writeSeq.store(index + 1, std::memory_order_release);
+    next_ = index + 1;
+
+#if defined(__linux__)
+    h->wake.fetch_add(1, std::memory_order_release);
+    futexWake(&h->wake);
+#endif
+    return true;
+}
+
+// ---------- reader ----------
+std::unique_ptr<FrameRingReader> FrameRingReader::open(const std::string& name, std::string* error) {
+#if defined(__linux__)
+    const std::string path = shmName(name);
+    int fd = shm_open(path.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        fail(error, "shm_open(" + path + "): " + std::strerror(errno));
+        return nullptr;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(RingHeader)) {
+        ::close(fd);
+        fail(error, "ring segment too small");
+        return nullptr;
+    }
+    void* mem = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mem == MAP_FAILED) {
+        fail(error, std::string("mmap: ") + std::strerror(errno));
+        return nullptr;
+    }
+
+    const unsigned char* base = static_cast<const unsigned char*>(mem);
+    const RingHeader* h = header(base);
+    const uint64_t expect = align64(sizeof(RingHeader)) + h->slotStride * h->slots;
+    if (h->magic.load(std::memory_order_acquire) != kRingMagic || h->version != kRingVersion ||
+        h->slots == 0 || expect > (uint64_t)st.st_size) {
+        munmap(mem, (size_t)st.st_size);
+        fail(error, "not a frame ring (or not initialised yet)");
+        return nullptr;
+    }
+
+    std::unique_ptr<FrameRingReader> r(new FrameRingReader());
+    r->base_ = base;
+    r->size_ = (size_t)st.st_size;
+    // start at the live edge; history in the ring is already stale
+    r->next_ = h->writeSeq.load(std::memory_order_acquire);
+    return r;
+#else
+    (void)name;
+    fail(error, "shared-memory frame ring is only implemented on Linux");
+    return nullptr;
+#endif
+}
+
+FrameRingReader::~FrameRingReader() {
+#if defined(__linux__)
+    if (base_) munmap(const_cast<unsigned char*>(base_), size_);
+#endif
+}
+
+bool FrameRingReader::waitForFrames(int timeoutMs) {
+    const RingHeader* h = header(base_);
+    if (h->writeSeq.load(std::memory_order_acquire) > next_) return true;
+#if defined(__linux__)
+    const uint32_t seen = h->wake.load(std::memory_order_acquire);
+    if (h->writeSeq.load(std::memory_order_acquire) > next_) return true;
+    if (!futexWait(&h->wake, seen, timeoutMs)) {
+        // kernel refused a futex on a read-only mapping: poll instead
+        std::this_thread::sleep_for(std::chrono::milliseconds(std::min(timeoutMs, 1)));
+    }
+#endif
+    return h->writeSeq.load(std::memory_order_acquire) > next_;
+}
+
+const std::vector<FrameInfo>& FrameRingReader::latestFrames(int maxAgeMs) {
+    TRACE_SCOPE("frameLatest");
+    batch_.clear();
+    const RingHeader* h = header(base_);
+    const uint64_t end = h->writeSeq.load(std::memory_order_acquire);
+    uint64_t begin = next_;
+    if (end > begin + h->slots) {
+        stats_.lapped += end - h->slots - begin;
+        begin = end - h->slots;
+    }
+    const int64_t now = frameClockNs();
+
+    for (uint64_t idx = begin; idx < end; idx++) {
+        const SlotHeader* s = slotAt(base_, idx);
+        const uint64_t want = 2 * (idx + 1);
+        if (s->seq.load(std::memory_order_acquire) != want) {
+            stats_.lapped++;
+            continue;
+        }
+
+        FrameInfo f;
+        f.index = idx;
+        f.symbol.assign(s->symbol, strnlen(s->symbol, sizeof(s->symbol)));
+        f.tfMinutes = s->tfMinutes;
+        f.captureNs = s->captureNs;
+        const int32_t w = s->width, hgt = s->height;
+        const uint32_t stride = s->stride, format = s->format;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s->seq.load(std::memory_order_relaxed) != want) {
+            stats_.lapped++;
+            continue;
+        }
+        // header copied consistently; still bounds-check before building a view on it
+        if (w <= 0 || hgt <= 0 || stride < (uint32_t)w * 4 || (uint64_t)stride * hgt > h->slotBytes || format > 1) {
+            stats_.torn++;
+            continue;
+        }
+        if (maxAgeMs > 0 && now - f.captureNs > (int64_t)maxAgeMs * 1000000) {
+            stats_.tooOld++;
+            continue;
+        }
+        const unsigned char* pixels = reinterpret_cast<const unsigned char*>(s) + align64(sizeof(SlotHeader));
+        f.view = ImageView(pixels, w, hgt, stride, (PixelFormat)format);
+
+        auto same = std::find_if(batch_.begin(), batch_.end(), [&](const FrameInfo& b) {
+            return b.tfMinutes == f.tfMinutes && b.symbol == f.symbol;
+        });
+        if (same != batch_.end()) {
+            stats_.superseded++;
+            *same = std::move(f);
+        } else {
+            batch_.push_back(std::move(f));
+        }
+    }
+
+    next_ = end;
+    stats_.delivered += batch_.size();
+    return batch_;
+}
+
+bool FrameRingReader::stillValid(const FrameInfo& f) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slotAt(base_, f.index)->seq.load(std::memory_order_relaxed) == 2 * (f.index + 1);
+}
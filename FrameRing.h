@@ -0,0 +1,103 @@
+// ===============================
+// File: FrameRing.h
+// Shared-memory ring of chart frames between a capture process (one writer)
+// and any number of predictor processes (readers). POSIX shm, no file I/O.
+//
+// Layout: RingHeader, then `slots` fixed-size slots (SlotHeader + pixels).
+// Every slot is a seqlock: the writer makes seq odd, copies the frame in,
+// then stores 2*(frameIndex+1). Readers never write to the ring and keep
+// their own cursor, so each reader sees every frame (broadcast). A reader
+// checks seq before and after using a slot; a frame that got overwritten
+// while it was being scored is reported by stillValid() and dropped. Readers
+// that fall more than `slots` frames behind lose the oldest ones.
+//
+// Linux only (futex wake-ups); elsewhere create/open fail with an error.
+// ===============================
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ImageView.h"
+
+struct FrameRingConfig {
+    uint32_t slots = 16;
+    int maxWidth = 1920;        // frames larger than this are rejected by publish()
+    int maxHeight = 1080;
+};
+
+struct FrameInfo {
+    uint64_t index = 0;         // frame number, increases by one per publish
+    std::string symbol;
+    int tfMinutes = -1;
+    int64_t captureNs = 0;      // steady clock (CLOCK_MONOTONIC) of the producer
+    ImageView view;             // points into the shared segment, no copy
+};
+
+struct FrameReadStats {
+    uint64_t delivered = 0;     // frames handed out by latestFrames()
+    uint64_t superseded = 0;    // skipped: a newer frame of the same symbol/TF was in the same poll
+    uint64_t tooOld = 0;        // skipped: older than maxAgeMs
+    uint64_t lapped = 0;        // lost: overwritten before this reader got to them
+    uint64_t torn = 0;          // dropped after scoring (stillValid() == false) or bad header
+};
+
+class FrameRingWriter {
+public:
+    // Creates (or replaces) the segment /name. The segment is unlinked on destruction.
+    static std::unique_ptr<FrameRingWriter> create(const std::string& name, const FrameRingConfig& cfg,
+                                                   std::string* error = nullptr);
+    ~FrameRingWriter();
+
+    FrameRingWriter(const FrameRingWriter&) = delete;
+    FrameRingWriter& operator=(const FrameRingWriter&) = delete;
+
+    // Copies img into the next slot (single producer: one thread calls this).
+    bool publish(const std::string& symbol, int tfMinutes, const ImageView& img,
+                 std::string* error = nullptr);
+    uint64_t published() const { return next_; }
+
+private:
+    FrameRingWriter() = default;
+
+    std::string name_;
+    unsigned char* base_ = nullptr;
+    std::size_t size_ = 0;
+    uint64_t next_ = 0;
+};
+
+class FrameRingReader {
+public:
+    static std::unique_ptr<FrameRingReader> open(const std::string& name, std::string* error = nullptr);
+    ~FrameRingReader();
+
+    FrameRingReader(const FrameRingReader&) = delete;
+    FrameRingReader& operator=(const FrameRingReader&) = delete;
+
+    // Sleeps until the writer has published past this reader's cursor.
+    bool waitForFrames(int timeoutMs);
+
+    // Newest unseen frame per (symbol, timeframe); everything older is skipped
+    // and counted. maxAgeMs > 0 also drops frames captured longer ago than that.
+    // The returned vector is reused by the next call.
+    const std::vector<FrameInfo>& latestFrames(int maxAgeMs = 0);
+
+    // True if f's slot has not been overwritten, i.e. whatever was read
+    // through f.view is intact. Call after scoring; count a false as torn.
+    bool stillValid(const FrameInfo& f) const;
+    void countTorn() { stats_.torn++; }
+
+    const FrameReadStats& stats() const { return stats_; }
+
+private:
+    FrameRingReader() = default;
+
+    const unsigned char* base_ = nullptr;
+    std::size_t size_ = 0;
+    uint64_t next_ = 0;
+    std::vector<FrameInfo> batch_;
+    FrameReadStats stats_;
+};
+
+int64_t frameClockNs();
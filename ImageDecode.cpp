@@ -0,0 +1,621 @@
+// ===============================
+// File: ImageDecode.cpp
+// ===============================
+#include "ImageDecode.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+bool fail(std::string* error, const char* msg) {
+    if (error) *error = msg;
+    return false;
+}
+
+// ---------- inflate (RFC 1951) ----------
+// LSB-first bit reader. Reads past the end return zero bits; overrun() tells
+// whether any of those were actually consumed.
+class BitReader {
+public:
+    BitReader(const uint8_t* p, size_t n) : p_(p), n_(n) {}
+
+    void refill() {
+        while (cnt_ <= 56) {
+            uint64_t b = pos_ < n_ ? p_[pos_] : 0;
+            pos_++;
+            buf_ |= b << cnt_;
+            cnt_ += 8;
+        }
+    }
+    uint32_t peek(int n) {
+        if (cnt_ < n) refill();
+        return (uint32_t)(buf_ & ((1ULL << n) - 1));
+    }
+    void drop(int n) {
+        buf_ >>= n;
+        cnt_ -= n;
+    }
+    uint32_t bits(int n) {
+        if (n == 0) return 0;
+        uint32_t v = peek(n);
+        drop(n);
+        return v;
+    }
+    void alignToByte() { drop(cnt_ & 7); }
+
+    // stored blocks: hand out whole bytes, first from the bit buffer then raw
+    bool copyBytes(uint8_t* dst, size_t len) {
+        while (len && cnt_ >= 8) {
+            *dst++ = (uint8_t)bits(8);
+            len--;
+        }
+        if (!len) return true;
+        // buffer is empty here, so pos_ is the next unread byte
+        if (pos_ > n_ || n_ - pos_ < len) return false;
+        std::memcpy(dst, p_ + pos_, len);
+        pos_ += len;
+        return true;
+    }
+
+    bool overrun() const { return pos_ > n_ + (size_t)(cnt_ / 8); }
+
+private:
+    const uint8_t* p_;
+    size_t n_;
+    size_t pos_ = 0;
+    uint64_t buf_ = 0;
+    int cnt_ = 0;
+};
+
+constexpr int kFastBits = 10;
+
+struct Huffman {
+    uint16_t fast[1 << kFastBits];   // (symbol << 4) | length, 0 = take the slow path
+    uint16_t counts[16];
+    uint16_t symbols[288];
+
+    bool build(const uint8_t* lengths, int n) {
+        std::memset(fast, 0, sizeof(fast));
+        std::memset(counts, 0, sizeof(counts));
+        for (int i = 0; i < n; i++) counts[lengths[i]]++;
+        counts[0] = 0;
+
+        int left = 1;
+        for (int len = 1; len < 16; len++) {
+            left <<= 1;
+            left -= counts[len];
+            if (left < 0) return false;   // over-subscribed
+        }
+
+        uint16_t offs[16];
+        offs[1] = 0;
+        for (int len = 1; len < 15; len++) offs[len + 1] = offs[len] + counts[len];
+        for (int i = 0; i < n; i++) {
+            if (lengths[i]) symbols[offs[lengths[i]]++] = (uint16_t)i;
+        }
+
+        // canonical codes, bit-reversed into the lookup table
+        int code = 0, idx = 0;
+        for (int len = 1; len <= kFastBits; len++) {
+            for (int k = 0; k < counts[len]; k++, code++, idx++) {
+                int rev = 0;
+                for (int b = 0; b < len; b++) rev |= ((code >> b) & 1) << (len - 1 - b);
+                const uint16_t e = (uint16_t)((symbols[idx] << 4) | len);
+                for (int r = rev; r < (1 << kFastBits); r += 1 << len) fast[r] = e;
+            }
+            code <<= 1;
+        }
+        return true;
+    }
+
+    int decode(BitReader& br) const {
+        const uint16_t e = fast[br.peek(kFastBits)];
+        if (e) {
+            br.drop(e & 15);
+            return e >> 4;
+        }
+        // long code: walk the canonical code one bit at a time
+        int code = 0, first = 0, index = 0;
+        for (int len = 1; len < 16; len++) {
+            code |= (int)br.bits(1);
+            const int count = counts[len];
+            if (code - count < first) return symbols[index + (code - first)];
+            index += count;
+            first += count;
+            first <<= 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+};
+
+const uint16_t kLenBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                               35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const uint8_t kLenExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                               3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const uint16_t kDistBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                8193, 12289, 16385, 24577};
+const uint8_t kDistExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// Inflates into out[0..outSize). The size is known up front for PNG, so the
+// output never grows; anything that would overflow it is an error.
+bool inflateInto(const uint8_t* in, size_t inSize, uint8_t* out, size_t outSize,
+                 size_t& written, std::string* error) {
+    BitReader br(in, inSize);
+    size_t o = 0;
+    Huffman litTable, distTable;
+    Huffman* lit = &litTable;
+    Huffman* dist = &distTable;
+
+    bool last = false;
+    while (!last) {
+        last = br.bits(1) != 0;
+        const uint32_t type = br.bits(2);
+
+        if (type == 0) {
+            br.alignToByte();
+            const uint32_t len = br.bits(16);
+            const uint32_t nlen = br.bits(16);
+            if ((len ^ 0xFFFF) != nlen) return fail(error, "corrupt stored block");
+            if (outSize - o < len) return fail(error, "inflate output overflow");
+            if (!br.copyBytes(out + o, len)) return fail(error, "truncated stored block");
+            o += len;
+            continue;
+        }
+
+        if (type == 1) {
+            uint8_t lengths[288 + 30];
+            std::memset(lengths, 8, 144);
+            std::memset(lengths + 144, 9, 112);
+            std::memset(lengths + 256, 7, 24);
+            std::memset(lengths + 280, 8, 8);
+            std::memset(lengths + 288, 5, 30);
+            lit->build(lengths, 288);
+            dist->build(lengths + 288, 30);
+        } else if (type == 2) {
+            const int hlit = (int)br.bits(5) + 257;
+            const int hdist = (int)br.bits(5) + 1;
+            const int hclen = (int)br.bits(4) + 4;
+            static const uint8_t order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+            uint8_t clen[19] = {};
+            for (int i = 0; i < hclen; i++) clen[order[i]] = (uint8_t)br.bits(3);
+            Huffman codeLen;
+            if (!codeLen.build(clen, 19)) return fail(error, "bad code-length code");
+
+            uint8_t lengths[288 + 32] = {};
+            int i = 0;
+            while (i < hlit + hdist) {
+                int sym = codeLen.decode(br);
+                if (sym < 0) return fail(error, "bad code-length symbol");
+                if (sym < 16) {
+                    lengths[i++] = (uint8_t)sym;
+                    continue;
+                }
+                int rep = 0;
+                uint8_t val = 0;
+                if (sym == 16) {
+                    if (i == 0) return fail(error, "repeat with no previous length");
+                    val = lengths[i - 1];
+                    rep = 3 + (int)br.bits(2);
+                } else if (sym == 17) {
+                    rep = 3 + (int)br.bits(3);
+                } else {
+                    rep = 11 + (int)br.bits(7);
+                }
+                if (i + rep > hlit + hdist) return fail(error, "code lengths overflow");
+                while (rep--) lengths[i++] = val;
+            }
+            if (!lit->build(lengths, hlit) || !dist->build(lengths + hlit, hdist)) {
+                return fail(error, "bad huffman table");
+            }
+        } else {
+            return fail(error, "bad block type");
+        }
+
+        for (;;) {
+            int sym = lit->decode(br);
+            if (sym < 0) return fail(error, "bad literal/length code");
+            if (sym < 256) {
+                if (o >= outSize) return fail(error, "inflate output overflow");
+                out[o++] = (uint8_t)sym;
+                continue;
+            }
+            if (sym == 256) break;
+
+            sym -= 257;
+            if (sym >= 29) return fail(error, "bad length symbol");
+            const size_t len = kLenBase[sym] + br.bits(kLenExtra[sym]);
+            const int dsym = dist->decode(br);
+            if (dsym < 0 || dsym >= 30) return fail(error, "bad distance symbol");
+            const size_t d = kDistBase[dsym] + br.bits(kDistExtra[dsym]);
+            if (d > o) return fail(error, "distance too far back");
+            if (outSize - o < len) return fail(error, "inflate output overflow");
+
+            uint8_t* dst = out + o;
+            const uint8_t* src = dst - d;
+            if (d >= len) {
+                std::memcpy(dst, src, len);
+            } else {
+                for (size_t k = 0; k < len; k++) dst[k] = src[k];   // overlapping run
+            }
+            o += len;
+        }
+        if (br.overrun()) return fail(error, "truncated deflate stream");
+    }
+
+    written = o;
+    return true;
+}
+
+// ---------- PNG ----------
+inline uint32_t be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+inline uint8_t paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return (uint8_t)a;
+    if (pb <= pc) return (uint8_t)b;
+    return (uint8_t)c;
+}
+
+// In-place unfilter of h rows of (1 + rowBytes) bytes each.
+bool unfilter(uint8_t* rows, int h, size_t rowBytes, int bpp) {
+    const uint8_t* prev = nullptr;
+    for (int y = 0; y < h; y++) {
+        uint8_t* row = rows + (size_t)y * (rowBytes + 1);
+        const uint8_t f = row[0];
+        uint8_t* cur = row + 1;
+        switch (f) {
+        case 0:
+            break;
+        case 1:
+            for (size_t i = bpp; i < rowBytes; i++) cur[i] = (uint8_t)(cur[i] + cur[i - bpp]);
+            break;
+        case 2:
+            if (prev) for (size_t i = 0; i < rowBytes; i++) cur[i] = (uint8_t)(cur[i] + prev[i]);
+            break;
+        case 3:
+            for (size_t i = 0; i < rowBytes; i++) {
+                int a = i >= (size_t)bpp ? cur[i - bpp] : 0;
+                int b = prev ? prev[i] : 0;
+                cur[i] = (uint8_t)(cur[i] + ((a + b) >> 1));
+            }
+            break;
+        case 4:
+            for (size_t i = 0; i < rowBytes; i++) {
+                int a = i >= (size_t)bpp ? cur[i - bpp] : 0;
+                int b = prev ? prev[i] : 0;
+                int c = (prev && i >= (size_t)bpp) ? prev[i - bpp] : 0;
+                cur[i] = (uint8_t)(cur[i] + paeth(a, b, c));
+            }
+            break;
+        default:
+            return false;
+        }
+        prev = cur;
+    }
+    return true;
+}
+
+struct PngInfo {
+    uint32_t width = 0, height = 0;
+    int depth = 0, colorType = 0, interlace = 0;
+    int channels = 0;
+    uint8_t palette[256][4];
+    int paletteSize = 0;
+    bool hasKey = false;
+    uint16_t key[3] = {0, 0, 0};   // tRNS colour key for grey/RGB
+
+    size_t rowBytes(uint32_t w) const { return ((size_t)w * channels * depth + 7) / 8; }
+};
+
+// sample i of a packed row at the image's bit depth (full range, not scaled)
+inline uint32_t sampleAt(const uint8_t* row, size_t i, int depth) {
+    switch (depth) {
+    case 8:  return row[i];
+    case 16: return ((uint32_t)row[2 * i] << 8) | row[2 * i + 1];
+    default: {
+        const size_t bit = i * depth;
+        const int shift = 8 - depth - (int)(bit & 7);
+        return (row[bit >> 3] >> shift) & ((1u << depth) - 1);
+    }
+    }
+}
+
+// one unfiltered row -> RGBA8 pixels at dst, dstStep bytes apart
+void expandRow(const PngInfo& info, const uint8_t* row, uint32_t w, uint8_t* dst, size_t dstStep) {
+    const int depth = info.depth;
+    const uint32_t maxv = (1u << depth) - 1;
+    auto to8 = [&](uint32_t v) -> uint8_t {
+        if (depth == 8) return (uint8_t)v;
+        if (depth == 16) return (uint8_t)(v >> 8);
+        return (uint8_t)(v * 255 / maxv);
+    };
+
+    // fast path for the common screenshot formats
+    if (depth == 8 && info.colorType == 6 && dstStep == 4) {
+        std::memcpy(dst, row, (size_t)w * 4);
+        return;
+    }
+    if (depth == 8 && info.colorType == 2 && !info.hasKey && dstStep == 4) {
+        for (uint32_t x = 0; x < w; x++, row += 3, dst += 4) {
+            dst[0] = row[0]; dst[1] = row[1]; dst[2] = row[2]; dst[3] = 255;
+        }
+        return;
+    }
+
+    for (uint32_t x = 0; x < w; x++, dst += dstStep) {
+        switch (info.colorType) {
+        case 0: {
+            uint32_t g = sampleAt(row, x, depth);
+            uint8_t v = to8(g);
+            dst[0] = dst[1] = dst[2] = v;
+            dst[3] = (info.hasKey && g == info.key[0]) ? 0 : 255;
+            break;
+        }
+        case 2: {
+            uint32_t r = sampleAt(row, 3 * (size_t)x, depth);
+            uint32_t g = sampleAt(row, 3 * (size_t)x + 1, depth);
+            uint32_t b = sampleAt(row, 3 * (size_t)x + 2, depth);
+            dst[0] = to8(r); dst[1] = to8(g); dst[2] = to8(b);
+            dst[3] = (info.hasKey && r == info.key[0] && g == info.key[1] && b == info.key[2]) ? 0 : 255;
+            break;
+        }
+        case 3: {
+            uint32_t idx = sampleAt(row, x, depth);
+            if ((int)idx < info.paletteSize) {
+                std::memcpy(dst, info.palette[idx], 4);
+            } else {
+                dst[0] = dst[1] = dst[2] = 0; dst[3] = 255;
+            }
+            break;
+        }
+        case 4: {
+            uint8_t v = to8(sampleAt(row, 2 * (size_t)x, depth));
+            dst[0] = dst[1] = dst[2] = v;
+            dst[3] = to8(sampleAt(row, 2 * (size_t)x + 1, depth));
+            break;
+        }
+        case 6:
+            for (int c = 0; c < 4; c++) dst[c] = to8(sampleAt(row, 4 * (size_t)x + c, depth));
+            break;
+        }
+    }
+}
+
+struct Pass { int x0, y0, dx, dy; };
+const Pass kAdam7[7] = {{0, 0, 8, 8}, {4, 0, 8, 8}, {0, 4, 4, 8}, {2, 0, 4, 4},
+                        {0, 2, 2, 4}, {1, 0, 2, 2}, {0, 1, 1, 2}};
+
+bool decodePng(const uint8_t* data, size_t size, PixelBuffer& out, std::string* error) {
+    TRACE_SCOPE("decodePng");
+    PngInfo info;
+    std::vector<uint8_t>& idat = out.zstream;   // only used when there is more than one IDAT chunk
+    const uint8_t* zdata = nullptr;
+    size_t zsize = 0;
+    int idatCount = 0;
+    bool haveHeader = false;
+
+    size_t p = 8;
+    while (p + 12 <= size) {
+        const uint32_t len = be32(data + p);
+        const uint8_t* type = data + p + 4;
+        const uint8_t* body = data + p + 8;
+        if (len > size - p - 12) return fail(error, "truncated PNG chunk");
+
+        if (!std::memcmp(type, "IHDR", 4)) {
+            if (len < 13) return fail(error, "bad IHDR");
+            info.width = be32(body);
+            info.height = be32(body + 4);
+            info.depth = body[8];
+            info.colorType = body[9];
+            info.interlace = body[12];
+            if (body[10] != 0 || body[11] != 0) return fail(error, "unsupported PNG compression/filter");
+            switch (info.colorType) {
+            case 0: info.channels = 1; break;
+            case 2: info.channels = 3; break;
+            case 3: info.channels = 1; break;
+            case 4: info.channels = 2; break;
+            case 6: info.channels = 4; break;
+            default: return fail(error, "bad PNG colour type");
+            }
+            const int d = info.depth;
+            const bool okDepth = (info.colorType == 0 && (d == 1 || d == 2 || d == 4 || d == 8 || d == 16)) ||
+                                 (info.colorType == 3 && (d == 1 || d == 2 || d == 4 || d == 8)) ||
+                                 ((info.colorType == 2 || info.colorType == 4 || info.colorType == 6) &&
+                                  (d == 8 || d == 16));
+            if (!okDepth) return fail(error, "bad PNG bit depth");
+            if (info.width == 0 || info.height == 0 || info.width > (1u << 15) || info.height > (1u << 15)) {
+                return fail(error, "unsupported PNG size");
+            }
+            haveHeader = true;
+        } else if (!std::memcmp(type, "PLTE", 4)) {
+            info.paletteSize = (int)std::min<uint32_t>(256, len / 3);
+            for (int i = 0; i < info.paletteSize; i++) {
+                info.palette[i][0] = body[3 * i];
+                info.palette[i][1] = body[3 * i + 1];
+                info.palette[i][2] = body[3 * i + 2];
+                info.palette[i][3] = 255;
+            }
+        } else if (!std::memcmp(type, "tRNS", 4)) {
+            if (info.colorType == 3) {
+                for (uint32_t i = 0; i < len && i < 256; i++) info.palette[i][3] = body[i];
+            } else if (info.colorType == 0 && len >= 2) {
+                info.hasKey = true;
+                info.key[0] = (uint16_t)((body[0] << 8) | body[1]);
+            } else if (info.colorType == 2 && len >= 6) {
+                info.hasKey = true;
+                for (int c = 0; c < 3; c++) info.key[c] = (uint16_t)((body[2 * c] << 8) | body[2 * c + 1]);
+            }
+        } else if (!std::memcmp(type, "IDAT", 4)) {
+            // single IDAT (the usual case) is inflated in place, no copy
+            if (idatCount == 0) {
+                zdata = body;
+                zsize = len;
+            } else {
+                if (idatCount == 1) idat.assign(zdata, zdata + zsize);
+                idat.insert(idat.end(), body, body + len);
+            }
+            idatCount++;
+        } else if (!std::memcmp(type, "IEND", 4)) {
+            break;
+        }
+        p += 12 + (size_t)len;
+    }
+
+    if (!haveHeader) return fail(error, "missing IHDR");
+    if (idatCount == 0) return fail(error, "missing IDAT");
+    if (info.colorType == 3 && info.paletteSize == 0) return fail(error, "missing PLTE");
+    if (idatCount > 1) {
+        zdata = idat.data();
+        zsize = idat.size();
+    }
+
+    // zlib wrapper: CMF/FLG, deflate, adler32 (not checked)
+    if (zsize < 2 || (zdata[0] & 0x0F) != 8 || ((zdata[0] << 8) | zdata[1]) % 31 != 0 || (zdata[1] & 0x20)) {
+        return fail(error, "bad zlib header");
+    }
+
+    const uint32_t W = info.width, H = info.height;
+    size_t rawSize = 0;
+    if (info.interlace == 0) {
+        rawSize = (size_t)H * (info.rowBytes(W) + 1);
+    } else if (info.interlace == 1) {
+        for (const Pass& ps : kAdam7) {
+            uint32_t pw = W > (uint32_t)ps.x0 ? (W - ps.x0 + ps.dx - 1) / ps.dx : 0;
+            uint32_t ph = H > (uint32_t)ps.y0 ? (H - ps.y0 + ps.dy - 1) / ps.dy : 0;
+            if (pw && ph) rawSize += (size_t)ph * (info.rowBytes(pw) + 1);
+        }
+    } else {
+        return fail(error, "bad PNG interlace method");
+    }
+
+    out.scanlines.resize(rawSize);
+    size_t written = 0;
+    {
+        TRACE_SCOPE("inflate");
+        if (!inflateInto(zdata + 2, zsize - 2, out.scanlines.data(), rawSize, written, error)) return false;
+    }
+    if (written != rawSize) return fail(error, "PNG image data size mismatch");
+
+    out.width = (int)W;
+    out.height = (int)H;
+    out.rgba.resize((size_t)W * H * 4);
+
+    const int bpp = std::max(1, info.channels * info.depth / 8);
+    uint8_t* raw = out.scanlines.data();
+
+    if (info.interlace == 0) {
+        const size_t rb = info.rowBytes(W);
+        if (!unfilter(raw, (int)H, rb, bpp)) return fail(error, "bad PNG filter type");
+        for (uint32_t y = 0; y < H; y++) {
+            expandRow(info, raw + (size_t)y * (rb + 1) + 1, W, out.rgba.data() + (size_t)y * W * 4, 4);
+        }
+        return true;
+    }
+
+    for (const Pass& ps : kAdam7) {
+        uint32_t pw = W > (uint32_t)ps.x0 ? (W - ps.x0 + ps.dx - 1) / ps.dx : 0;
+        uint32_t ph = H > (uint32_t)ps.y0 ? (H - ps.y0 + ps.dy - 1) / ps.dy : 0;
+        if (!pw || !ph) continue;
+        const size_t rb = info.rowBytes(pw);
+        if (!unfilter(raw, (int)ph, rb, bpp)) return fail(error, "bad PNG filter type");
+        for (uint32_t y = 0; y < ph; y++) {
+            uint8_t* dst = out.rgba.data() + ((size_t)(ps.y0 + y * ps.dy) * W + ps.x0) * 4;
+            expandRow(info, raw + (size_t)y * (rb + 1) + 1, pw, dst, (size_t)ps.dx * 4);
+        }
+        raw += (size_t)ph * (rb + 1);
+    }
+    return true;
+}
+
+// ---------- PPM / PGM ----------
+bool netpbmInt(const uint8_t* data, size_t size, size_t& p, uint32_t& v) {
+    for (;;) {
+        while (p < size && std::isspace(data[p])) p++;
+        if (p < size && data[p] == '#') {
+            while (p < size && data[p] != '\n') p++;
+            continue;
+        }
+        break;
+    }
+    if (p >= size || !std::isdigit(data[p])) return false;
+    v = 0;
+    while (p < size && std::isdigit(data[p])) {
+        v = v * 10 + (uint32_t)(data[p] - '0');
+        if (v > (1u << 20)) return false;
+        p++;
+    }
+    return true;
+}
+
+bool decodeNetpbm(const uint8_t* data, size_t size, PixelBuffer& out, std::string* error) {
+    TRACE_SCOPE("decodeNetpbm");
+    const bool rgb = data[1] == '6';
+    size_t p = 2;
+    uint32_t w = 0, h = 0, maxv = 0;
+    if (!netpbmInt(data, size, p, w) || !netpbmInt(data, size, p, h) || !netpbmInt(data, size, p, maxv)) {
+        return fail(error, "bad PPM header");
+    }
+    if (w == 0 || h == 0 || maxv == 0 || maxv > 65535) return fail(error, "bad PPM header");
+    p++;   // single whitespace after maxval
+
+    const int channels = rgb ? 3 : 1;
+    const int bytesPerSample = maxv > 255 ? 2 : 1;
+    const size_t need = (size_t)w * h * channels * bytesPerSample;
+    if (p > size || size - p < need) return fail(error, "truncated PPM data");
+
+    out.width = (int)w;
+    out.height = (int)h;
+    out.rgba.resize((size_t)w * h * 4);
+    const uint8_t* s = data + p;
+    uint8_t* d = out.rgba.data();
+    for (size_t i = 0; i < (size_t)w * h; i++, d += 4) {
+        for (int c = 0; c < channels; c++) {
+            uint32_t v = bytesPerSample == 2 ? ((uint32_t)s[0] << 8 | s[1]) : s[0];
+            s += bytesPerSample;
+            d[c] = (uint8_t)(maxv == 255 ? v : v * 255 / maxv);
+        }
+        if (!rgb) d[1] = d[2] = d[0];
+        d[3] = 255;
+    }
+    return true;
+}
+
+} // namespace
+
+bool decodeImageMemory(const unsigned char* bytes, std::size_t size, PixelBuffer& out, std::string* error) {
+    static const uint8_t kPngSig[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (!bytes || size < 8) return fail(error, "not an image");
+    if (!std::memcmp(bytes, kPngSig, 8)) return decodePng(bytes, size, out, error);
+    if (bytes[0] == 'P' && (bytes[1] == '5' || bytes[1] == '6')) return decodeNetpbm(bytes, size, out, error);
+    return fail(error, "unsupported image format (PNG, PPM/PGM only)");
+}
+
+bool decodeImageFile(const std::string& path, PixelBuffer& out, std::string* error) {
+    TRACE_SCOPE("decodeImage");
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return fail(error, "cannot open file");
+    std::fseek(f, 0, SEEK_END);
+    long n = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    if (n <= 0) {
+        std::fclose(f);
+        return fail(error, "empty file");
+    }
+    out.fileBytes.resize((size_t)n);
+    const size_t got = std::fread(out.fileBytes.data(), 1, (size_t)n, f);
+    std::fclose(f);
+    if (got != (size_t)n) return fail(error, "short read");
+    return decodeImageMemory(out.fileBytes.data(), out.fileBytes.size(), out, error);
+}
@@ -0,0 +1,34 @@
+// ===============================
+// File: ImageDecode.h
+// Small self-contained image decoder for the predictor core (no SFML, no zlib).
+//   - PNG: all colour types, bit depths 1..16, Adam7, tRNS; own inflate
+//   - PPM/PGM (P6/P5, binary "raw" netpbm), maxval up to 65535
+// Output is always tightly packed RGBA8, top row first, written into a
+// PixelBuffer that keeps its allocations between calls.
+// ===============================
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "ImageView.h"
+
+struct PixelBuffer {
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> rgba;   // width*height*4
+
+    // decoder scratch, kept so repeated decodes don't reallocate
+    std::vector<unsigned char> fileBytes;
+    std::vector<unsigned char> zstream;     // IDAT chunks joined (multi-IDAT PNGs)
+    std::vector<unsigned char> scanlines;
+
+    const unsigned char* data() const { return rgba.data(); }
+    ImageView view() const { return ImageView(rgba.data(), width, height); }
+    bool empty() const { return width <= 0 || height <= 0; }
+};
+
+// false + *error on failure; out keeps whatever capacity it had.
+bool decodeImageFile(const std::string& path, PixelBuffer& out, std::string* error = nullptr);
+bool decodeImageMemory(const unsigned char* bytes, std::size_t size, PixelBuffer& out,
+                       std::string* error = nullptr);
@@ -0,0 +1,35 @@
+// ===============================
+// File: ImageView.h
+// Non-owning view of 4-byte-per-pixel image memory (decoded file, capture
+// frame, shared-memory slot...). The predictor reads straight from it; the
+// caller keeps the memory alive for the duration of the call.
+// ===============================
+#pragma once
+#include <cstddef>
+
+enum class PixelFormat : unsigned char {
+    RGBA8,
+    BGRA8,   // Windows DIBs, most capture APIs
+};
+
+struct ImageView {
+    const unsigned char* data = nullptr;
+    int width = 0;
+    int height = 0;
+    std::size_t stride = 0;              // bytes per row; 0 = tightly packed (width*4)
+    PixelFormat format = PixelFormat::RGBA8;
+
+    ImageView() = default;
+    ImageView(const unsigned char* d, int w, int h, std::size_t strideBytes = 0,
+              PixelFormat fmt = PixelFormat::RGBA8)
+        : data(d), width(w), height(h), stride(strideBytes ? strideBytes : (std::size_t)w * 4), format(fmt) {}
+
+    bool empty() const { return !data || width <= 0 || height <= 0; }
+
+    const unsigned char* row(int y) const { return data + (std::size_t)y * stride; }
+    const unsigned char* at(int x, int y) const { return row(y) + (std::size_t)x * 4; }
+
+    // channel offsets of red/blue inside a pixel
+    int rIndex() const { return format == PixelFormat::BGRA8 ? 2 : 0; }
+    int bIndex() const { return format == PixelFormat::BGRA8 ? 0 : 2; }
+};
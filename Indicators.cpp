@@ -0,0 +1,154 @@
+// ===============================
+// File: Indicators.cpp
+// ===============================
+#include "Indicators.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cmath>
+
+IndicatorStream::IndicatorStream(const IndicatorParams& p) : p_(p) {
+    p_.emaFast = std::max(1, p_.emaFast);
+    p_.emaSlow = std::max(1, p_.emaSlow);
+    p_.macdSignal = std::max(1, p_.macdSignal);
+    p_.rsi = std::max(1, p_.rsi);
+    p_.atr = std::max(1, p_.atr);
+    p_.bollinger = std::max(1, p_.bollinger);
+    window_.assign((std::size_t)p_.bollinger, 0.0);
+}
+
+void IndicatorStream::reset() {
+    v_ = IndicatorValues{};
+    bars_ = 0;
+    emaFast_ = emaSlow_ = signal_ = prevClose_ = 0.0;
+    gain_ = loss_ = tr_ = 0.0;
+    pv_ = vol_ = typical_ = 0.0;
+    head_ = 0;
+    sum_ = sumSq_ = 0.0;
+}
+
+// Wilder-style averages (RSI, ATR) are seeded with the plain mean of their
+// first period, EMAs with the first value.
+const IndicatorValues& IndicatorStream::update(float close, float high, float low, float vol) {
+    const double c = close, h = std::max(high, close), l = std::min(low, close);
+    const std::size_t n = ++bars_;
+
+    // EMAs + MACD
+    if (n == 1) {
+        emaFast_ = emaSlow_ = c;
+    } else {
+        emaFast_ += 2.0 / (p_.emaFast + 1) * (c - emaFast_);
+        emaSlow_ += 2.0 / (p_.emaSlow + 1) * (c - emaSlow_);
+    }
+    const double macd = emaFast_ - emaSlow_;
+    if (n == 1) signal_ = macd;
+    else signal_ += 2.0 / (p_.macdSignal + 1) * (macd - signal_);
+
+    // RSI over close-to-close changes
+    const std::size_t rsiN = (std::size_t)p_.rsi;
+    if (n >= 2) {
+        const double d = c - prevClose_;
+        const double up = d > 0.0 ? d : 0.0, down = d < 0.0 ? -d : 0.0;
+        const std::size_t k = n - 1;
+        if (k <= rsiN) {
+            gain_ += up;
+            loss_ += down;
+            if (k == rsiN) {
+                gain_ /= (double)rsiN;
+                loss_ /= (double)rsiN;
+            }
+        } else {
+            gain_ = (gain_ * (double)(rsiN - 1) + up) / (double)rsiN;
+            loss_ = (loss_ * (double)(rsiN - 1) + down) / (double)rsiN;
+        }
+        if (k >= rsiN) v_.rsi = loss_ == 0.0 ? (gain_ == 0.0 ? 50.f : 100.f) : (float)(100.0 - 100.0 / (1.0 + gain_ / loss_));
+    }
+
+    // ATR over the true range
+    const std::size_t atrN = (std::size_t)p_.atr;
+    double tr = h - l;
+    if (n >= 2) tr = std::max(tr, std::max(std::abs(h - prevClose_), std::abs(l - prevClose_)));
+    if (n <= atrN) {
+        tr_ += tr;
+        if (n == atrN) tr_ /= (double)atrN;
+        v_.atr = (float)(n == atrN ? tr_ : tr_ / (double)n);
+    } else {
+        tr_ = (tr_ * (double)(atrN - 1) + tr) / (double)atrN;
+        v_.atr = (float)tr_;
+    }
+
+    // Bollinger bandwidth over the last `bollinger` closes (fewer while filling)
+    const std::size_t bbN = window_.size();
+    if (n <= bbN) {
+        window_[n - 1] = c;
+    } else {
+        const double old = window_[head_];
+        sum_ -= old;
+        sumSq_ -= old * old;
+        window_[head_] = c;
+        head_ = (head_ + 1) % bbN;
+    }
+    sum_ += c;
+    sumSq_ += c * c;
+    const double m = (double)std::min(n, bbN);
+    const double mean = sum_ / m;
+    const double sd = std::sqrt(std::max(0.0, sumSq_ / m - mean * mean));
+    v_.bollingerWidth = mean > 0.0 ? (float)(2.0 * p_.bollingerK * sd / mean) : 0.f;
+
+    // VWAP on the typical price, unweighted while there is no volume at all
+    const double typical = (h + l + c) / 3.0;
+    pv_ += typical * vol;
+    vol_ += vol;
+    typical_ += typical;
+    v_.vwap = (float)(vol_ > 0.0 ? pv_ / vol_ : typical_ / (double)n);
+
+    prevClose_ = c;
+    v_.emaFast = (float)emaFast_;
+    v_.emaSlow = (float)emaSlow_;
+    v_.macd = (float)macd;
+    v_.macdSignal = (float)signal_;
+    v_.macdHist = (float)(macd - signal_);
+    const std::size_t slowest = std::max({(std::size_t)p_.emaSlow + (std::size_t)p_.macdSignal - 1, rsiN + 1, atrN, bbN});
+    v_.ready = n >= slowest;
+    return v_;
+}
+
+const IndicatorValues& IndicatorStream::replay(const SeriesView& s) {
+    reset();
+    const std::size_t n = s.close.size();
+    const bool hl = s.high.size() == n && s.low.size() == n;
+    const bool hasVol = s.vol.size() == n;
+    for (std::size_t i = 0; i < n; i++)
+        update(s.close[i], hl ? s.high[i] : s.close[i], hl ? s.low[i] : s.close[i], hasVol ? s.vol[i] : 1.f);
+    return v_;
+}
+
+void IndicatorSeries::clear() {
+    for (std::vector<float>* v : {&emaFast, &emaSlow, &macd, &macdSignal, &macdHist, &rsi, &atr, &bollingerWidth, &vwap})
+        v->clear();
+}
+
+void computeIndicators(const SeriesView& s, const IndicatorParams& p, IndicatorSeries& out) {
+    TRACE_SCOPE("computeIndicators");
+    const std::size_t n = s.close.size();
+    for (std::vector<float>* v : {&out.emaFast, &out.emaSlow, &out.macd, &out.macdSignal, &out.macdHist, &out.rsi,
+                                  &out.atr, &out.bollingerWidth, &out.vwap})
+        v->resize(n);
+
+    const bool hl = s.high.size() == n && s.low.size() == n;
+    const bool hasVol = s.vol.size() == n;
+    IndicatorStream st(p);
+    for (std::size_t i = 0; i < n; i++) {
+        const IndicatorValues& v =
+            st.update(s.close[i], hl ? s.high[i] : s.close[i], hl ? s.low[i] : s.close[i], hasVol ? s.vol[i] : 1.f);
+        out.emaFast[i] = v.emaFast;
+        out.emaSlow[i] = v.emaSlow;
+        out.macd[i] = v.macd;
+        out.macdSignal[i] = v.macdSignal;
+        out.macdHist[i] = v.macdHist;
+        out.rsi[i] = v.rsi;
+        out.atr[i] = v.atr;
+        out.bollingerWidth[i] = v.bollingerWidth;
+        out.vwap[i] = v.vwap;
+    }
+}
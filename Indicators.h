@@ -0,0 +1,91 @@
+// ===============================
+// File: Indicators.h
+// Classic technical indicators computed together in one pass over a series:
+// EMA fast/slow, MACD (+ signal, histogram), RSI, ATR, Bollinger bandwidth
+// and VWAP. Every update is O(1) per bar and touches each input once, so
+// enabling all of them costs one walk over the series instead of one each.
+//
+//   IndicatorStream ind;                  // incremental, e.g. live bars
+//   for (...) ind.update(c, h, l, v);
+//   ind.values().rsi ...
+//
+//   IndicatorSeries out;                  // batch, one value per bar
+//   computeIndicators(series, {}, out);
+//
+// EMA/RSI/ATR are recurrences (each bar needs the previous one), so the batch
+// form is the incremental one in a loop; the win is fusion, not SIMD lanes.
+// Without high/low the bar range is the close itself (ATR = average |dclose|,
+// VWAP on closes); without volume VWAP weighs every bar the same.
+// ===============================
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "SeriesView.h"
+
+struct IndicatorParams {
+    int emaFast = 12;
+    int emaSlow = 26;
+    int macdSignal = 9;
+    int rsi = 14;
+    int atr = 14;
+    int bollinger = 20;
+    double bollingerK = 2.0;
+};
+
+// Latest values. RSI is 0..100, bollingerWidth is (upper - lower) / middle,
+// the rest are in the series' units. ready once every period has filled.
+struct IndicatorValues {
+    float emaFast = 0.f, emaSlow = 0.f;
+    float macd = 0.f, macdSignal = 0.f, macdHist = 0.f;
+    float rsi = 50.f;
+    float atr = 0.f;
+    float bollingerWidth = 0.f;
+    float vwap = 0.f;
+    bool ready = false;
+};
+
+class IndicatorStream {
+public:
+    explicit IndicatorStream(const IndicatorParams& p = {});
+
+    const IndicatorParams& params() const { return p_; }
+    const IndicatorValues& values() const { return v_; }
+    std::size_t bars() const { return bars_; }
+
+    // Back to no bars; keeps the Bollinger window's storage.
+    void reset();
+
+    const IndicatorValues& update(float close, float high, float low, float vol);
+    const IndicatorValues& update(float close) { return update(close, close, close, 1.f); }
+
+    // reset() + update() over the whole series (high/low/vol used when they
+    // match close in length)
+    const IndicatorValues& replay(const SeriesView& s);
+
+private:
+    IndicatorParams p_;
+    IndicatorValues v_;
+    std::size_t bars_ = 0;
+
+    double emaFast_ = 0.0, emaSlow_ = 0.0, signal_ = 0.0;
+    double prevClose_ = 0.0;
+    double gain_ = 0.0, loss_ = 0.0;   // RSI averages (plain sums while seeding)
+    double tr_ = 0.0;                  // ATR average (plain sum while seeding)
+    double pv_ = 0.0, vol_ = 0.0, typical_ = 0.0;   // VWAP sums (+ unweighted fallback)
+
+    std::vector<double> window_;       // last `bollinger` closes, ring
+    std::size_t head_ = 0;
+    double sum_ = 0.0, sumSq_ = 0.0;
+};
+
+// One value per bar, oldest first; a bar's values are what IndicatorStream
+// reported after it.
+struct IndicatorSeries {
+    std::vector<float> emaFast, emaSlow, macd, macdSignal, macdHist, rsi, atr, bollingerWidth, vwap;
+
+    std::size_t size() const { return rsi.size(); }
+    void clear();
+};
+
+void computeIndicators(const SeriesView& s, const IndicatorParams& p, IndicatorSeries& out);
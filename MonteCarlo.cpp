@@ -0,0 +1,132 @@
+// ===============================
+// File: MonteCarlo.cpp
+// ===============================
+#include "MonteCarlo.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include "Trace.h"
+
+namespace {
+
+// splitmix64 to seed, xoshiro256** to draw: a few ns per number and
+// independent streams per thread from one seed
+uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+struct Rng {
+    uint64_t s[4];
+
+    explicit Rng(uint64_t seed) {
+        for (auto& v : s) v = splitmix64(seed);
+    }
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    uint64_t next() {
+        const uint64_t result = rotl(s[1] * 5, 7) * 9;
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // [0, n), multiply-shift (bias is < n / 2^32, irrelevant here)
+    uint32_t below(uint32_t n) { return (uint32_t)(((next() >> 32) * (uint64_t)n) >> 32); }
+};
+
+Distribution summarize(std::vector<float>& v) {
+    Distribution d;
+    if (v.empty()) return d;
+    double sum = 0.0, sq = 0.0;
+    for (float x : v) {
+        sum += x;
+        sq += (double)x * x;
+    }
+    d.mean = sum / v.size();
+    d.stddev = std::sqrt(std::max(0.0, sq / v.size() - d.mean * d.mean));
+
+    // ascending quantiles: each nth_element only has to look right of the last one
+    const double qs[] = {0.01, 0.05, 0.25, 0.50, 0.75, 0.95, 0.99};
+    double* outs[] = {&d.p1, &d.p5, &d.p25, &d.p50, &d.p75, &d.p95, &d.p99};
+    auto first = v.begin();
+    for (int i = 0; i < 7; i++) {
+        auto nth = v.begin() + (std::ptrdiff_t)std::min(v.size() - 1, (std::size_t)(qs[i] * (v.size() - 1) + 0.5));
+        std::nth_element(first, nth, v.end());
+        *outs[i] = *nth;
+        first = nth;
+    }
+    return d;
+}
+
+} // namespace
+
+MonteCarloReport runMonteCarlo(const std::vector<double>& pnl, const MonteCarloOptions& opt) {
+    TRACE_SCOPE("runMonteCarlo");
+    const auto t0 = std::chrono::steady_clock::now();
+    MonteCarloReport rep;
+    if (pnl.empty() || opt.resamples == 0) return rep;
+
+    const std::size_t n = opt.shuffle ? pnl.size() : (opt.tradesPerSample ? opt.tradesPerSample : pnl.size());
+    const std::size_t R = opt.resamples;
+    rep.resamples = R;
+    rep.trades = n;
+
+    std::vector<float> equity(R), drawdown(R), winRate(R);
+
+    int threads = opt.threads > 0 ? opt.threads : (int)std::thread::hardware_concurrency();
+    threads = (int)std::max<std::size_t>(1, std::min<std::size_t>((std::size_t)std::max(1, threads), R));
+
+    // fixed split: the same seed and thread count reproduce the same report
+    auto work = [&](int t) {
+        Rng rng(opt.seed * 0x100000001B3ull + (uint64_t)t);
+        std::vector<double> order(pnl);   // shuffle only
+        const uint32_t m = (uint32_t)pnl.size();
+        for (std::size_t r = R * t / threads; r < R * (t + 1) / threads; r++) {
+            double eq = 0.0, peak = 0.0, dd = 0.0;
+            std::size_t wins = 0;
+            if (opt.shuffle) {
+                for (uint32_t i = m - 1; i > 0; i--) std::swap(order[i], order[rng.below(i + 1)]);
+                for (double x : order) {
+                    eq += x;
+                    wins += x > 0.0;
+                    peak = std::max(peak, eq);
+                    dd = std::max(dd, peak - eq);
+                }
+            } else {
+                for (std::size_t i = 0; i < n; i++) {
+                    const double x = pnl[rng.below(m)];
+                    eq += x;
+                    wins += x > 0.0;
+                    peak = std::max(peak, eq);
+                    dd = std::max(dd, peak - eq);
+                }
+            }
+            equity[r] = (float)eq;
+            drawdown[r] = (float)dd;
+            winRate[r] = (float)(100.0 * wins / n);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(work, t);
+    work(0);
+    for (auto& th : pool) th.join();
+
+    rep.finalEquity = summarize(equity);
+    rep.maxDrawdown = summarize(drawdown);
+    rep.winRate = summarize(winRate);
+    rep.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return rep;
+}
@@ -0,0 +1,40 @@
+// ===============================
+// File: MonteCarlo.h
+// Confidence intervals for a backtest: resample the per-trade PnL sequence
+// many times and look at the spread of final equity, max drawdown and win rate.
+//   - bootstrap: draw trades with replacement (how lucky was this sample?)
+//   - shuffle:   same trades, random order (how bad could the path have been?
+//                final equity and win rate are fixed, drawdown is not)
+// Input is a flat PnL array (Predictor::tradePnls()), equity is the running
+// sum. Resamples are split across threads, each with its own RNG stream, so a
+// given seed + thread count always gives the same numbers.
+// ===============================
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct MonteCarloOptions {
+    std::size_t resamples = 100000;
+    std::size_t tradesPerSample = 0;  // 0 = as many as in the input
+    bool shuffle = false;             // false = bootstrap with replacement
+    int threads = 0;                  // 0 = hardware_concurrency
+    uint64_t seed = 1;
+};
+
+struct Distribution {
+    double mean = 0.0;
+    double stddev = 0.0;
+    double p1 = 0.0, p5 = 0.0, p25 = 0.0, p50 = 0.0, p75 = 0.0, p95 = 0.0, p99 = 0.0;
+};
+
+struct MonteCarloReport {
+    std::size_t resamples = 0;
+    std::size_t trades = 0;           // per resample
+    Distribution finalEquity;         // sum of PnL
+    Distribution maxDrawdown;         // largest peak-to-trough drop of the running sum (>= 0)
+    Distribution winRate;             // percent of trades with PnL > 0
+    double ms = 0.0;
+};
+
+MonteCarloReport runMonteCarlo(const std::vector<double>& pnl, const MonteCarloOptions& opt = {});
@@ -0,0 +1,79 @@
+// ===============================
+// File: OhlcvBars.cpp
+// ===============================
+#include "OhlcvBars.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+// offset of the first "HH:MM" in t, npos if there is none
+std::size_t hhmmPos(const std::string& t) {
+    for (std::size_t i = 0; i + 5 <= t.size(); i++) {
+        if (t[i + 2] != ':') continue;
+        const bool digits = std::isdigit((unsigned char)t[i]) && std::isdigit((unsigned char)t[i + 1]) &&
+                            std::isdigit((unsigned char)t[i + 3]) && std::isdigit((unsigned char)t[i + 4]);
+        if (digits && (i == 0 || !std::isdigit((unsigned char)t[i - 1]))) return i;
+    }
+    return std::string::npos;
+}
+
+// Clock bucket of a bar: the date part plus minute-of-day / factor. -1 = no time.
+long clockBucket(const std::string& t, int factor, std::string& day) {
+    const std::size_t i = hhmmPos(t);
+    if (i == std::string::npos) return -1;
+    day.assign(t, 0, i);
+    const int minute = ((t[i] - '0') * 10 + (t[i + 1] - '0')) * 60 + (t[i + 3] - '0') * 10 + (t[i + 4] - '0');
+    return minute / factor;
+}
+
+} // namespace
+
+std::string hhmmFrom(const std::string& t) {
+    const std::size_t i = hhmmPos(t);
+    return i == std::string::npos ? "" : t.substr(i, 5);
+}
+
+std::vector<OhlcvBar> resampleBars(const std::vector<OhlcvBar>& base, int factor) {
+    std::vector<OhlcvBar> out;
+    if (base.empty()) return out;
+    factor = std::max(1, factor);
+    if (factor == 1) return base;
+
+    auto add = [&](OhlcvBar& bar, const OhlcvBar& b, bool first) {
+        if (first) {
+            bar = b;
+            return;
+        }
+        bar.high = std::max(bar.high, b.high);
+        bar.low = std::min(bar.low, b.low);
+        bar.close = b.close;
+        bar.volume += b.volume;
+    };
+
+    std::string day, prevDay;
+    if (clockBucket(base.front().time, factor, day) >= 0) {
+        out.reserve(base.size() / factor + 2);
+        long prev = -1;
+        for (const OhlcvBar& b : base) {
+            const long bucket = clockBucket(b.time, factor, day);
+            const bool first = out.empty() || bucket < 0 || bucket != prev || day != prevDay;
+            if (first) out.emplace_back();
+            add(out.back(), b, first);
+            prev = bucket;
+            prevDay.swap(day);
+        }
+        return out;
+    }
+
+    // no timestamps: count from the newest bar back, the oldest group may be short
+    const std::size_t n = base.size(), f = (std::size_t)factor;
+    out.resize((n + f - 1) / f);
+    for (std::size_t b = 0; b < out.size(); b++) {
+        const std::size_t end = n - (out.size() - 1 - b) * f;
+        const std::size_t begin = end > f ? end - f : 0;
+        for (std::size_t i = begin; i < end; i++) add(out[b], base[i], i == begin);
+    }
+    return out;
+}
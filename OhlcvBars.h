@@ -0,0 +1,24 @@
+// ===============================
+// File: OhlcvBars.h
+// OHLCV bars in prices (CSV rows, or a chart's candles) and the one roll-up
+// from a base timeframe to a coarser one, shared by the predictor's
+// multi-timeframe scoring and the walk-forward / fitting tools.
+// ===============================
+#pragma once
+#include <string>
+#include <vector>
+
+struct OhlcvBar {
+    std::string time;
+    double open = 0.0, high = 0.0, low = 0.0, close = 0.0, volume = 0.0;
+};
+
+// "2024-03-01 09:35:00" / "2024-03-01T09:35" -> "09:35"; anything else -> ""
+std::string hhmmFrom(const std::string& t);
+
+// Roll base bars up by `factor` (5: 1m -> 5m): open of the first bar, max
+// high, min low, close of the last, volume summed; time is the first bar's.
+// Timestamped bars are grouped on clock boundaries (09:30..09:34 is one 5m
+// bar, a gap just makes a shorter group); without times, by count from the
+// newest bar back.
+std::vector<OhlcvBar> resampleBars(const std::vector<OhlcvBar>& base, int factor);
@@ -0,0 +1,208 @@
+// ===============================
+// File: PredictBatch.cpp
+// Predictor::predictBatch: bounded decode -> predict pipeline.
+//
+//   I/O threads      take the next request (in order) once a decode slot is
+//                    free, read + decode into it, queue it as ready
+//   compute threads  pop a ready slot, predict from its pixels, hand the slot
+//                    back, emit the result
+//
+// The slot pool (maxInFlight PixelBuffers, reused for the whole batch) is the
+// backpressure: with every slot decoded and waiting, I/O threads sleep until a
+// compute thread returns one.
+//
+// An exception out of onResult stops the batch: every thread stops taking
+// work, the pipeline is joined, and the first exception is rethrown to the
+// caller of predictBatch.
+// ===============================
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "ImageDecode.h"
+#include "Predictor.h"
+#include "Trace.h"
+
+namespace {
+
+double msSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+} // namespace
+
+void Predictor::predictBatch(const BatchRequest* requests, std::size_t count, const BatchOptions& opt,
+                             const BatchCallback& onResult) const {
+    TRACE_SCOPE("predictBatch");
+    if (count == 0) return;
+
+    const int compute = std::max(1, opt.computeThreads > 0 ? opt.computeThreads
+                                                           : (int)std::thread::hardware_concurrency());
+    const int io = (int)std::min<std::size_t>((std::size_t)std::max(1, opt.ioThreads), count);
+    const std::size_t slots =
+        std::max<std::size_t>(1, std::min(count, opt.maxInFlight ? opt.maxInFlight : (std::size_t)compute * 2));
+
+    struct Ready {
+        std::size_t index;
+        PixelBuffer* buf;
+        double decodeMs;
+    };
+
+    std::mutex mu;
+    std::condition_variable slotFree, readyCv;
+    std::vector<PixelBuffer> buffers(slots);
+    std::vector<PixelBuffer*> freeSlots;
+    for (PixelBuffer& b : buffers) freeSlots.push_back(&b);
+    std::deque<Ready> ready;
+    std::size_t nextRead = 0;
+    int readersLeft = io;
+    bool failed = false;            // mu; set once onResult threw
+    std::exception_ptr failure;     // mu; the first thing onResult threw
+
+    // emission: in request order (results parked until their turn) or as they come
+    std::mutex emitMu;
+    std::vector<BatchResult> parked(opt.ordered ? count : 0);
+    std::vector<char> done(opt.ordered ? count : 0, 0);
+    std::size_t nextEmit = 0;
+    bool emitFailed = false;        // emitMu; nothing is handed out after a throw
+    auto emitLocked = [&](BatchResult&& r) {
+        if (!opt.ordered) {
+            onResult(r);
+            return;
+        }
+        const std::size_t i = r.index;
+        parked[i] = std::move(r);
+        done[i] = 1;
+        while (nextEmit < count && done[nextEmit]) {
+            onResult(parked[nextEmit]);
+            parked[nextEmit] = BatchResult();   // drop the Prediction's vectors
+            nextEmit++;
+        }
+    };
+    // false once the batch is stopping: the calling thread quits
+    auto emit = [&](BatchResult&& r) -> bool {
+        {
+            std::lock_guard<std::mutex> lk(emitMu);
+            if (emitFailed) return false;
+            try {
+                emitLocked(std::move(r));
+                return true;
+            } catch (...) {
+                emitFailed = true;
+                std::lock_guard<std::mutex> lk2(mu);
+                failed = true;
+                failure = std::current_exception();
+            }
+        }
+        slotFree.notify_all();
+        readyCv.notify_all();
+        return false;
+    };
+
+    auto reader = [&]() {
+        for (;;) {
+            std::size_t i;
+            PixelBuffer* buf;
+            {
+                std::unique_lock<std::mutex> lk(mu);
+                slotFree.wait(lk, [&] { return !freeSlots.empty() || nextRead == count || failed; });
+                if (nextRead == count || failed) break;
+                i = nextRead++;
+                buf = freeSlots.back();
+                freeSlots.pop_back();
+                if (nextRead == count) slotFree.notify_all();   // readers waiting on a slot can quit
+            }
+
+            const auto t0 = std::chrono::steady_clock::now();
+            std::string err;
+            bool ok;
+            {
+                TRACE_SCOPE("batchDecode");
+                ok = decodeImageFile(requests[i].imagePath, *buf, &err);
+            }
+            const double ms = msSince(t0);
+            if (ok) {
+                std::lock_guard<std::mutex> lk(mu);
+                ready.push_back({i, buf, ms});
+                readyCv.notify_one();
+                continue;
+            }
+
+            {
+                std::lock_guard<std::mutex> lk(mu);
+                freeSlots.push_back(buf);
+            }
+            slotFree.notify_one();
+            BatchResult r;
+            r.index = i;
+            r.ok = false;
+            r.error = "Could not load image: " + requests[i].imagePath + " (" + err + ")";
+            r.decodeMs = ms;
+            if (!emit(std::move(r))) break;
+        }
+        std::lock_guard<std::mutex> lk(mu);
+        if (--readersLeft == 0) readyCv.notify_all();
+    };
+
+    // predict* is not reentrant on one instance, so each worker copies this
+    // one; the backtest history is of no use to them and may be long
+    Predictor prototype = *this;
+    prototype.history_ = {};
+    auto worker = [&]() {
+        Predictor predictor = prototype;
+        for (;;) {
+            Ready job;
+            {
+                std::unique_lock<std::mutex> lk(mu);
+                readyCv.wait(lk, [&] { return !ready.empty() || readersLeft == 0 || failed; });
+                if (ready.empty() || failed) break;
+                job = ready.front();
+                ready.pop_front();
+            }
+
+            const BatchRequest& req = requests[job.index];
+            BatchResult r;
+            r.index = job.index;
+            r.decodeMs = job.decodeMs;
+            const auto t0 = std::chrono::steady_clock::now();
+            try {
+                const int tf = req.tfMinutes > 0 ? req.tfMinutes : timeframeFromFilename(req.imagePath);
+                r.prediction = predictor.predictImage(job.buf->view(), req.timeStr, tf, req.hasScale,
+                                                      req.minPrice, req.maxPrice);
+            } catch (const std::exception& e) {
+                r.ok = false;
+                r.error = e.what();
+            }
+            r.predictMs = msSince(t0);
+
+            {
+                std::lock_guard<std::mutex> lk(mu);
+                freeSlots.push_back(job.buf);
+            }
+            slotFree.notify_one();
+            if (!emit(std::move(r))) break;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < io; t++) threads.emplace_back(reader);
+    for (int t = 1; t < compute; t++) threads.emplace_back(worker);
+    worker();
+    for (auto& th : threads) th.join();
+    if (failure) std::rethrow_exception(failure);
+}
+
+std::vector<BatchResult> Predictor::predictBatch(const std::vector<BatchRequest>& requests,
+                                                 const BatchOptions& opt) const {
+    // results land at their index anyway, so skip the reorder buffer
+    BatchOptions unordered = opt;
+    unordered.ordered = false;
+    std::vector<BatchResult> out(requests.size());
+    predictBatch(requests.data(), requests.size(), unordered,
+                 [&](const BatchResult& r) { out[r.index] = r; });
+    return out;
+}
@@ -0,0 +1,460 @@
+// ===============================
+// File: PredictDaemon.cpp
+// ===============================
+#include "PredictDaemon.h"
+#include "DaemonProtocol.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace daemonproto;
+
+namespace {
+
+// Replies are queued per connection and written without blocking: whatever
+// the socket does not take right away is flushed by the I/O thread on
+// EPOLLOUT, so a client that stops reading never stalls a worker.
+constexpr std::size_t kMaxQueuedReplyBytes = 8u << 20;   // past this the client is too slow: drop it
+
+struct Conn {
+    Conn(int f, int ep) : fd(f), epollFd(ep) {}
+    ~Conn() { ::close(fd); }
+
+    int fd;
+    int epollFd;
+    std::vector<uint8_t> in;     // I/O thread only
+
+    std::mutex writeMu;          // workers reply concurrently; guards the rest
+    std::deque<std::vector<uint8_t>> out;
+    std::size_t outOff = 0;      // bytes of out.front() already sent
+    std::size_t outBytes = 0;
+    bool wantOut = false;        // EPOLLOUT armed
+    bool dead = false;           // dropped by the I/O thread, or too slow
+
+    void watch(bool writable) {
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP | (writable ? EPOLLOUT : 0u);
+        ev.data.fd = fd;
+        ::epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &ev);   // ENOENT once dropped: fine
+        wantOut = writable;
+    }
+
+    // writeMu held. Sends what the socket takes now; false on a dead socket.
+    bool flushLocked() {
+        while (!out.empty()) {
+            const std::vector<uint8_t>& f = out.front();
+            ssize_t k = ::send(fd, f.data() + outOff, f.size() - outOff, MSG_DONTWAIT | MSG_NOSIGNAL);
+            if (k < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                return false;
+            }
+            outOff += (std::size_t)k;
+            outBytes -= (std::size_t)k;
+            if (outOff == f.size()) {
+                out.pop_front();
+                outOff = 0;
+            }
+        }
+        if (out.empty() != !wantOut) watch(!out.empty());
+        return true;
+    }
+
+    // I/O thread, on EPOLLOUT
+    bool flush() {
+        std::lock_guard<std::mutex> lock(writeMu);
+        return !dead && flushLocked();
+    }
+
+    void drop() {
+        std::lock_guard<std::mutex> lock(writeMu);
+        dead = true;
+        out.clear();
+        outBytes = outOff = 0;
+    }
+};
+
+struct Pending {
+    std::shared_ptr<Conn> conn;
+    Request req;
+};
+
+void sendReply(Conn& c, const Reply& r) {
+    std::vector<uint8_t> frame = encodeReply(r);
+    std::lock_guard<std::mutex> lock(c.writeMu);
+    if (c.dead) return;
+    c.outBytes += frame.size();
+    c.out.push_back(std::move(frame));
+    if (c.outBytes > kMaxQueuedReplyBytes || !c.flushLocked()) {
+        // the I/O thread sees the hang-up and drops the connection
+        c.dead = true;
+        c.out.clear();
+        c.outBytes = c.outOff = 0;
+        ::shutdown(c.fd, SHUT_RDWR);
+    }
+}
+
+// OHLCV bars -> normalized close/volume/high/low series (the same 0..1 space
+// the chart extractor produces). Without an explicit scale, the bar range
+// becomes the scale.
+void ohlcvToSeries(Request& req, std::vector<float>& close01, std::vector<float>& vol01,
+                   std::vector<float>& high01, std::vector<float>& low01) {
+    const std::size_t bars = req.ohlcv.size() / 5;
+    double lo = 1e300, hi = -1e300, vmax = 0.0;
+    for (std::size_t i = 0; i < bars; i++) {
+        const float* b = &req.ohlcv[i * 5];
+        lo = std::min(lo, (double)std::min(b[2], b[3]));
+        hi = std::max(hi, (double)std::max(b[1], b[3]));
+        vmax = std::max(vmax, (double)b[4]);
+    }
+    if (!req.hasScale) {
+        req.hasScale = hi > lo;
+        req.minPrice = lo;
+        req.maxPrice = hi;
+    }
+    close01.resize(bars);
+    vol01.resize(bars);
+    high01.resize(bars);
+    low01.resize(bars);
+    auto norm = [&](float price) {
+        return (float)std::max(0.0, std::min(1.0, Predictor::realToNorm(price, req.minPrice, req.maxPrice)));
+    };
+    for (std::size_t i = 0; i < bars; i++) {
+        const float* b = &req.ohlcv[i * 5];
+        close01[i] = norm(b[3]);
+        // a bar whose high/low do not bracket its close is taken at the close
+        high01[i] = std::max(norm(b[1]), close01[i]);
+        low01[i] = std::min(norm(b[2]), close01[i]);
+        vol01[i] = vmax > 0.0 ? (float)(b[4] / vmax) : 0.f;
+    }
+}
+
+// A daemon already answering on the path: connect() goes through. A socket
+// file left behind by one that died refuses (ECONNREFUSED) and can go.
+bool socketInUse(const sockaddr_un& addr) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    const bool live = ::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+    ::close(fd);
+    return live;
+}
+
+std::string batchKey(const Request& r) {
+    return r.path + '\n' + std::to_string(r.tfMinutes) + '\n' + r.timeStr + '\n' +
+           (r.hasScale ? std::to_string(r.minPrice) + ':' + std::to_string(r.maxPrice) : std::string("-"));
+}
+
+} // namespace
+
+struct PredictDaemon::Impl {
+    Impl(const Predictor& proto, DaemonOptions o) : prototype(proto), opt(std::move(o)) {}
+
+    Predictor prototype;
+    DaemonOptions opt;
+
+    int listenFd = -1;
+    int epollFd = -1;
+    int stopFd = -1;
+    std::atomic<bool> stopping{false};
+
+    std::thread ioThread;
+    std::vector<std::thread> workers;
+
+    std::mutex qMu;
+    std::condition_variable qCv;
+    std::deque<Pending> queue;
+
+    std::atomic<uint64_t> nRequests{0}, nBatches{0}, nDeduped{0}, nErrors{0};
+
+    // ---------- I/O ----------
+    void ioLoop() {
+        trace::setThreadName("daemon-io");
+        std::map<int, std::shared_ptr<Conn>> conns;
+        epoll_event events[64];
+        uint8_t chunk[64 * 1024];
+
+        while (!stopping.load()) {
+            int n = ::epoll_wait(epollFd, events, 64, -1);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            for (int i = 0; i < n; i++) {
+                const int fd = events[i].data.fd;
+                if (fd == stopFd) return;
+
+                if (fd == listenFd) {
+                    for (;;) {
+                        int cfd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+                        if (cfd < 0) break;
+                        epoll_event ev{};
+                        ev.events = EPOLLIN | EPOLLRDHUP;
+                        ev.data.fd = cfd;
+                        ::epoll_ctl(epollFd, EPOLL_CTL_ADD, cfd, &ev);
+                        conns[cfd] = std::make_shared<Conn>(cfd, epollFd);
+                    }
+                    continue;
+                }
+
+                auto it = conns.find(fd);
+                if (it == conns.end()) continue;
+                std::shared_ptr<Conn> c = it->second;
+
+                bool closed = false;
+                if ((events[i].events & EPOLLOUT) && !c->flush()) closed = true;
+                for (;;) {
+                    ssize_t k = ::recv(fd, chunk, sizeof(chunk), MSG_DONTWAIT);
+                    if (k > 0) { c->in.insert(c->in.end(), chunk, chunk + k); continue; }
+                    if (k < 0 && errno == EINTR) continue;
+                    if (k == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) closed = true;
+                    break;
+                }
+                if (!parseFrames(c)) closed = true;
+
+                if (closed) {
+                    ::epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+                    c->drop();
+                    conns.erase(it);  // fd closes once in-flight replies drop their reference
+                }
+            }
+        }
+    }
+
+    // false on a corrupt stream (connection gets dropped)
+    bool parseFrames(const std::shared_ptr<Conn>& c) {
+        std::size_t off = 0;
+        std::vector<Pending> ready;
+        while (c->in.size() - off >= sizeof(FrameHeader)) {
+            FrameHeader h;
+            std::memcpy(&h, c->in.data() + off, sizeof(h));
+            if (h.magic != kMagic || h.payloadBytes > kMaxPayload) return false;
+            if (c->in.size() - off - sizeof(h) < h.payloadBytes) break;
+
+            Pending p;
+            p.conn = c;
+            const uint8_t* payload = c->in.data() + off + sizeof(h);
+            if (!decodeRequest(h, payload, h.payloadBytes, p.req)) {
+                Reply r;
+                r.id = h.requestId;
+                r.ok = false;
+                r.error = "malformed request";
+                sendReply(*c, r);
+                nErrors++;
+            } else {
+                ready.push_back(std::move(p));
+            }
+            off += sizeof(h) + h.payloadBytes;
+        }
+        c->in.erase(c->in.begin(), c->in.begin() + (std::ptrdiff_t)off);
+
+        if (!ready.empty()) {
+            {
+                std::lock_guard<std::mutex> lock(qMu);
+                for (auto& p : ready) queue.push_back(std::move(p));
+            }
+            if (ready.size() > 1) qCv.notify_all();
+            else qCv.notify_one();
+        }
+        return true;
+    }
+
+    // ---------- workers ----------
+    void workerLoop(int idx, int nWorkers) {
+        trace::setThreadName("daemon-worker-" + std::to_string(idx));
+        Predictor predictor = prototype;   // warm, per worker
+        std::vector<Pending> batch;
+
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(qMu);
+                qCv.wait(lock, [&] { return !queue.empty() || stopping.load(); });
+                if (stopping.load()) return;
+
+                // Under load (more than one waiting), give the batch a moment to fill.
+                if (queue.size() > 1 && (int)queue.size() < opt.maxBatch && opt.batchWindowUs > 0) {
+                    qCv.wait_for(lock, std::chrono::microseconds(opt.batchWindowUs), [&] {
+                        return (int)queue.size() >= opt.maxBatch || stopping.load();
+                    });
+                    if (queue.empty()) continue;
+                }
+
+                // fair share so one worker does not swallow the whole queue
+                std::size_t share = (queue.size() + (std::size_t)nWorkers - 1) / (std::size_t)nWorkers;
+                std::size_t take = std::min<std::size_t>(std::max<std::size_t>(1, share), (std::size_t)opt.maxBatch);
+                batch.clear();
+                for (std::size_t i = 0; i < take; i++) {
+                    batch.push_back(std::move(queue.front()));
+                    queue.pop_front();
+                }
+                if (!queue.empty()) qCv.notify_one();
+            }
+            runBatch(predictor, batch);
+        }
+    }
+
+    void runBatch(Predictor& predictor, std::vector<Pending>& batch) {
+        TRACE_SCOPE("daemonBatch");
+        nBatches++;
+        std::map<std::string, Reply> byKey;   // identical path requests inside this batch
+
+        for (auto& p : batch) {
+            nRequests++;
+            Reply r;
+            std::string key;
+            if (p.req.kind == Kind::Path) {
+                key = batchKey(p.req);
+                auto hit = byKey.find(key);
+                if (hit != byKey.end()) {
+                    r = hit->second;
+                    r.id = p.req.id;
+                    nDeduped++;
+                    sendReply(*p.conn, r);
+                    continue;
+                }
+            }
+
+            r.id = p.req.id;
+            try {
+                r.prediction = run(predictor, p.req);
+            } catch (const std::exception& e) {
+                r.ok = false;
+                r.error = e.what();
+                nErrors++;
+            }
+            if (!key.empty()) byKey.emplace(key, r);
+            sendReply(*p.conn, r);
+        }
+        batch.clear();
+    }
+
+    static Prediction run(Predictor& predictor, Request& req) {
+        switch (req.kind) {
+        case Kind::Path:
+            return predictor.predictWithTime(req.path, req.timeStr, req.tfMinutes,
+                                             req.hasScale, req.minPrice, req.maxPrice);
+        case Kind::Pixels:
+            return predictor.predictRGBA(req.rgba.data(), req.width, req.height, req.timeStr,
+                                         req.tfMinutes, req.hasScale, req.minPrice, req.maxPrice);
+        case Kind::Ohlcv: {
+            std::vector<float> close01, vol01, high01, low01;
+            ohlcvToSeries(req, close01, vol01, high01, low01);
+            return predictor.predictSeries(SeriesView{close01, vol01, high01, low01}, req.timeStr,
+                                           req.tfMinutes, req.hasScale, req.minPrice, req.maxPrice);
+        }
+        }
+        throw std::runtime_error("unknown request kind");
+    }
+};
+
+PredictDaemon::PredictDaemon(const Predictor& prototype, DaemonOptions opt)
+    : impl_(new Impl(prototype, std::move(opt))) {}
+
+PredictDaemon::~PredictDaemon() {
+    stop();
+}
+
+bool PredictDaemon::start(std::string* error) {
+    if (running_.load()) return true;
+    Impl& im = *impl_;
+    auto fail = [&](const std::string& what) {
+        if (error) *error = what + ": " + std::strerror(errno);
+        if (im.listenFd >= 0) ::close(im.listenFd);
+        if (im.epollFd >= 0) ::close(im.epollFd);
+        if (im.stopFd >= 0) ::close(im.stopFd);
+        im.listenFd = im.epollFd = im.stopFd = -1;
+        return false;
+    };
+
+    sockaddr_un addr{};
+    if (im.opt.socketPath.size() >= sizeof(addr.sun_path)) {
+        if (error) *error = "socket path too long";
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, im.opt.socketPath.c_str(), im.opt.socketPath.size() + 1);
+
+    struct stat st{};
+    if (::lstat(im.opt.socketPath.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            if (error) *error = im.opt.socketPath + " exists and is not a socket";
+            return false;
+        }
+        if (socketInUse(addr)) {
+            if (error) *error = "another daemon is listening on " + im.opt.socketPath;
+            return false;
+        }
+        ::unlink(im.opt.socketPath.c_str());   // stale socket from a previous run
+    }
+
+    im.listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (im.listenFd < 0) return fail("socket");
+    if (::bind(im.listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) return fail("bind " + im.opt.socketPath);
+    if (::listen(im.listenFd, 128) != 0) return fail("listen");
+
+    im.epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    im.stopFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (im.epollFd < 0 || im.stopFd < 0) return fail("epoll/eventfd");
+    for (int fd : {im.listenFd, im.stopFd}) {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        ::epoll_ctl(im.epollFd, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    im.stopping.store(false);
+    int n = im.opt.workers > 0 ? im.opt.workers : (int)std::thread::hardware_concurrency();
+    n = std::max(1, n);
+    im.opt.maxBatch = std::max(1, im.opt.maxBatch);
+    for (int i = 0; i < n; i++) im.workers.emplace_back([&im, i, n] { im.workerLoop(i, n); });
+    im.ioThread = std::thread([&im] { im.ioLoop(); });
+
+    running_.store(true);
+    return true;
+}
+
+void PredictDaemon::stop() {
+    if (!running_.exchange(false)) return;
+    Impl& im = *impl_;
+
+    im.stopping.store(true);
+    uint64_t one = 1;
+    (void)!::write(im.stopFd, &one, sizeof(one));
+    { std::lock_guard<std::mutex> lock(im.qMu); }
+    im.qCv.notify_all();
+
+    if (im.ioThread.joinable()) im.ioThread.join();
+    for (auto& t : im.workers) t.join();
+    im.workers.clear();
+    im.queue.clear();
+
+    ::close(im.listenFd);
+    ::close(im.epollFd);
+    ::close(im.stopFd);
+    im.listenFd = im.epollFd = im.stopFd = -1;
+    ::unlink(im.opt.socketPath.c_str());
+}
+
+DaemonStats PredictDaemon::stats() const {
+    DaemonStats s;
+    s.requests = impl_->nRequests.load();
+    s.batches = impl_->nBatches.load();
+    s.deduped = impl_->nDeduped.load();
+    s.errors = impl_->nErrors.load();
+    return s;
+}
@@ -0,0 +1,51 @@
+// ===============================
+// File: PredictDaemon.h
+// Long-running prediction server on a Unix domain socket (see DaemonProtocol.h).
+// Keeps one warm Predictor per worker so callers skip process start-up and
+// cold caches. Requests from all connections land in one queue; a worker takes
+// up to maxBatch at a time and computes identical path requests only once.
+// Sockets are non-blocking: replies queue per connection, a client that stops
+// reading is dropped once 8 MB are waiting. start() refuses a socket path a
+// live daemon answers on; a stale one is replaced.
+// ===============================
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "Predictor.h"
+
+struct DaemonOptions {
+    std::string socketPath = "/tmp/stockpredictd.sock";
+    int workers = 0;            // 0 = hardware_concurrency
+    int maxBatch = 32;          // requests a worker takes per wake-up
+    int batchWindowUs = 200;    // wait this long for a batch to fill when under load
+};
+
+struct DaemonStats {
+    uint64_t requests = 0;
+    uint64_t batches = 0;
+    uint64_t deduped = 0;       // answered from another identical request in the same batch
+    uint64_t errors = 0;
+};
+
+class PredictDaemon {
+public:
+    PredictDaemon(const Predictor& prototype, DaemonOptions opt);
+    ~PredictDaemon();
+
+    PredictDaemon(const PredictDaemon&) = delete;
+    PredictDaemon& operator=(const PredictDaemon&) = delete;
+
+    bool start(std::string* error = nullptr);
+    void stop();
+    bool running() const { return running_.load(); }
+
+    DaemonStats stats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+    std::atomic<bool> running_{false};
+};
@@ -2,7 +2,10 @@
 // File: Predictor.cpp
 // ===============================
 #include "Predictor.h"
-#include <SFML/Graphics.hpp>
+#include "Trace.h"
+#include "ExtractKernels.h"
+#include "ImageDecode.h"
+#include "OhlcvBars.h"
 #include <cmath>
 #include <algorithm>
 #include <stdexcept>
@@ -10,8 +13,10 @@
 #include <fstream>
 #include <sstream>
 #include <limits>
+#include <chrono>
+#include <atomic>
 
-Predictor::Predictor() = default;
+Predictor::Predictor() : layoutCache_(std::make_shared<ChartLayoutCache>()) {}
 
 // ---------- utils ----------
 double Predictor::clamp(double x, double lo, double hi) {
@@ -59,6 +64,31 @@ void Predictor::setCandleColors(unsigned char bullR, unsigned char bullG, unsign
     color_.tolerance = tolerance;
 }
 
+namespace {
+template <class Theme>
+bool applyTheme(const std::string& name, unsigned char* bull, unsigned char* bear, int& tol) {
+    if (name != Theme::name) return false;
+    bull[0] = Theme::bull.r; bull[1] = Theme::bull.g; bull[2] = Theme::bull.b;
+    bear[0] = Theme::bear.r; bear[1] = Theme::bear.g; bear[2] = Theme::bear.b;
+    tol = Theme::tolerance;
+    return true;
+}
+
+template <class... Themes>
+bool applyRegisteredTheme(const std::string& name, unsigned char* bull, unsigned char* bear, int& tol,
+                          ThemeList<Themes...>) {
+    return (applyTheme<Themes>(name, bull, bear, tol) || ...);
+}
+}
+
+bool Predictor::setColorTheme(const std::string& name) {
+    unsigned char bull[3], bear[3];
+    int tol = 0;
+    if (!applyRegisteredTheme(name, bull, bear, tol, RegisteredThemes{})) return false;
+    setCandleColors(bull[0], bull[1], bull[2], bear[0], bear[1], bear[2], tol);
+    return true;
+}
+
 void Predictor::setWeights(double trendW, double momentumW, double reversalW, double srW) {
     w_.trend = trendW;
     w_.momentum = momentumW;
@@ -70,6 +100,70 @@ void Predictor::setConfidenceThreshold(double threshold) {
     confidenceThreshold_ = clamp(threshold, 0.0, 100.0);
 }
 
+void Predictor::setScoreCalibration(const ScoreCalibration& c) {
+    calib_.scale = c.scale > 0.0 ? c.scale : ScoreCalibration{}.scale;
+    calib_.bias = c.bias;
+}
+
+void Predictor::applyConfig(const PredictorConfig& cfg) {
+    setWeights(cfg.trend, cfg.momentum, cfg.reversal, cfg.sr);
+    setConfidenceThreshold(cfg.confidenceThreshold);
+    timeframes_ = cfg.timeframes;
+    setCandleColors(cfg.bull.r, cfg.bull.g, cfg.bull.b, cfg.bear.r, cfg.bear.g, cfg.bear.b, cfg.tolerance);
+    volUp_ = cfg.volUp;
+    volDown_ = cfg.volDown;
+    volTolerance_ = cfg.volTolerance;
+    setAutoLayout(cfg.autoLayout);
+    setCandleSegmentation(cfg.candleSegmentation);
+    cuts_ = cfg.cuts;
+    gates_ = cfg.gates;
+    w_.indicators = cfg.indicators;
+    setScoreCalibration(cfg.calibration);
+}
+
+PredictorConfig Predictor::config() const {
+    PredictorConfig cfg;
+    cfg.trend = w_.trend;
+    cfg.momentum = w_.momentum;
+    cfg.reversal = w_.reversal;
+    cfg.sr = w_.sr;
+    cfg.indicators = w_.indicators;
+    cfg.confidenceThreshold = confidenceThreshold_;
+    cfg.timeframes = timeframes_;
+    cfg.bull = {color_.bullR, color_.bullG, color_.bullB};
+    cfg.bear = {color_.bearR, color_.bearG, color_.bearB};
+    cfg.tolerance = color_.tolerance;
+    cfg.volUp = volUp_;
+    cfg.volDown = volDown_;
+    cfg.volTolerance = volTolerance_;
+    cfg.autoLayout = autoLayout_;
+    cfg.candleSegmentation = candleSegmentation_;
+    cfg.cuts = cuts_;
+    cfg.gates = gates_;
+    cfg.calibration = calib_;
+    return cfg;
+}
+
+void Predictor::setConfigStore(std::shared_ptr<ConfigStore> store) {
+    configStore_ = std::move(store);
+    configVersion_ = 0;
+    syncConfig();
+}
+
+// The version is bumped after the snapshot is stored, so current() is at
+// least as new as v; if it is newer the next call just applies it again.
+void Predictor::syncConfig() {
+    if (!configStore_) return;
+    const uint64_t v = configStore_->version();
+    if (v == configVersion_) return;
+    applyConfig(*configStore_->current());
+    configVersion_ = v;
+}
+
+void Predictor::setAutoLayout(bool enabled) {
+    autoLayout_ = enabled;
+}
+
 // ---------- image helpers ----------
 bool Predictor::nearColor(unsigned char r, unsigned char g, unsigned char b,
                           unsigned char tr, unsigned char tg, unsigned char tb,
@@ -79,64 +173,113 @@ bool Predictor::nearColor(unsigned char r, unsigned char g, unsigned char b,
            (std::abs((int)b - (int)tb) <= tol);
 }
 
-// Improved: estimate CLOSE per column using bull/bear majority and extremum.
-std::vector<float> Predictor::extractCloseSeries(const std::string& imagePath) const {
-    sf::Image img;
-    if (!img.loadFromFile(imagePath)) {
-        throw std::runtime_error("Could not load image: " + imagePath);
+namespace {
+// Decodes into a per-thread buffer that is reused by the next call on the same
+// thread; the reference is only good until then.
+const PixelBuffer& loadImage(const std::string& imagePath) {
+    thread_local PixelBuffer buf;
+    std::string err;
+    if (!decodeImageFile(imagePath, buf, &err)) {
+        throw std::runtime_error("Could not load image: " + imagePath + " (" + err + ")");
     }
+    return buf;
+}
 
-    const int W = (int)img.getSize().x;
-    const int H = (int)img.getSize().y;
-
-    const int topCut    = (int)(0.10 * H);
-    const int bottomCut = (int)(0.25 * H); // exclude MACD/RSI panels
-    const int leftCut   = (int)(0.03 * W);
-    const int rightCut  = (int)(0.02 * W);
+struct Pixel { unsigned char r, g, b; };
 
-    const int y0 = topCut;
-    const int y1 = H - bottomCut;
-    const int x0 = leftCut;
-    const int x1 = W - rightCut;
+inline Pixel pixelAt(const ImageView& img, int x, int y) {
+    const unsigned char* p = img.at(x, y);
+    return {p[img.rIndex()], p[1], p[img.bIndex()]};
+}
 
-    std::vector<float> series;
-    series.reserve(std::max(0, x1 - x0));
-
-    for (int x = x0; x < x1; x++) {
-        int bullCount = 0, bearCount = 0;
-        int bullMinY =  std::numeric_limits<int>::max();
-        int bearMaxY = -1;
-
-        for (int y = y0; y < y1; y++) {
-            sf::Color c = img.getPixel((unsigned)x, (unsigned)y);
-
-            bool isBull = nearColor(c.r, c.g, c.b,
-                                    color_.bullR, color_.bullG, color_.bullB,
-                                    color_.tolerance);
-            bool isBear = nearColor(c.r, c.g, c.b,
-                                    color_.bearR, color_.bearG, color_.bearB,
-                                    color_.tolerance);
-
-            if (isBull) {
-                bullCount++;
-                bullMinY = std::min(bullMinY, y);
-            } else if (isBear) {
-                bearCount++;
-                bearMaxY = std::max(bearMaxY, y);
-            }
+// Preview extraction samples every k-th column; stretch back to one value per
+// column (linear between samples) so smoothing/swing windows mean the same thing.
+// In place: v holds the coarse samples on entry, n values on return.
+void expandStrided(std::vector<float>& v, int k, int n) {
+    if (v.empty()) {
+        v.assign((size_t)n, 0.5f);
+        return;
+    }
+    const int last = (int)v.size() - 1;
+    v.resize((size_t)std::max(n, last + 1));
+    // back to front: for i off a sample point, samples j and j+1 sit at or
+    // before i, so they are read before being overwritten
+    for (int i = n - 1; i >= 0; i--) {
+        const int j = std::min(i / k, last);
+        if (j == last || i == j * k) {
+            v[(size_t)i] = v[(size_t)j];
+            continue;
         }
+        const float t = (float)(i - j * k) / (float)k;
+        v[(size_t)i] = v[(size_t)j] + t * (v[(size_t)j + 1] - v[(size_t)j]);
+    }
+    v.resize((size_t)n);
+}
+}
 
-        int closeY = -1;
-        if (bullCount == 0 && bearCount == 0) closeY = -1;
-        else if (bullCount >= bearCount) closeY = bullMinY; // bull close near top
-        else closeY = bearMaxY; // bear close near bottom
+Predictor::Scratch& Predictor::scratch() {
+    thread_local Scratch s;
+    return s;
+}
 
-        if (closeY < 0) series.push_back(-1.f);
-        else {
-            float norm = 1.f - (float)(closeY - y0) / (float)(y1 - y0);
-            series.push_back((float)clamp(norm, 0.0, 1.0));
-        }
+// Fixed cuts unless auto layout is on; detected layouts are cached per fingerprint.
+ChartLayout Predictor::fixedLayout(int W, int H) const {
+    ChartLayout L = legacyChartLayout(W, H, cuts_);
+    L.volUp = volUp_;
+    L.volDown = volDown_;
+    L.volTolerance = volTolerance_;
+    return L;
+}
+
+ChartLayout Predictor::layoutFor(const ImageView& img) const {
+    ChartLayout fixed = fixedLayout(img.width, img.height);
+    if (!autoLayout_) return fixed;
+    return layoutCache_->get(img, color_.tolerance, fixed);
+}
+
+// detected candle colours override the configured ones (tolerance stays configured)
+DynamicColors Predictor::candleColors(const ChartLayout& layout) const {
+    DynamicColors colors{{color_.bullR, color_.bullG, color_.bullB},
+                         {color_.bearR, color_.bearG, color_.bearB}, color_.tolerance};
+    if (layout.hasCandleColors) {
+        colors.a = layout.bull;
+        colors.b = layout.bear;
     }
+    return colors;
+}
+
+ChartLayout Predictor::analyzeLayout(const std::string& imagePath) const {
+    const PixelBuffer& img = loadImage(imagePath);
+    return analyzeChartLayout(img.view(), color_.tolerance, fixedLayout(img.width, img.height));
+}
+
+std::vector<float> Predictor::extractCloseSeries(const std::string& imagePath) const {
+    const PixelBuffer& img = loadImage(imagePath);
+    std::vector<float> series;
+    extractCloseSeries(img.view(), layoutFor(img.view()), 1, series);
+    return series;
+}
+
+// Improved: estimate CLOSE per column using bull/bear majority and extremum.
+void Predictor::extractCloseSeries(const ImageView& img, const ChartLayout& layout, int stride,
+                                   std::vector<float>& series) const {
+    TRACE_SCOPE("extractCloseSeries");
+    const int k = std::max(1, stride);
+    const int W = img.width, H = img.height;
+
+    // plot area only (legacy: 10% top, 25% bottom, 3%/2% sides)
+    const int y0 = std::max(0, layout.plot.y0);
+    const int y1 = std::min(H, layout.plot.y1);
+    const int x0 = std::max(0, layout.plot.x0);
+    const int x1 = std::min(W, layout.plot.x1);
+
+    const DynamicColors colors = candleColors(layout);
+
+    // registered theme colours get the compile-time specialized scan
+    const PixelRect rect{x0, y0, x1, y1};
+    std::vector<int>& work = scratch().columns;
+    if (!withCandleTheme(colors, RegisteredThemes{}, [&](auto theme) { scanClose(img, rect, k, theme, work, series); }))
+        scanClose(img, rect, k, colors, work, series);
 
     // Gap fill
     float last = -1.f;
@@ -151,61 +294,48 @@ std::vector<float> Predictor::extractCloseSeries(const std::string& imagePath) c
         else series[i] = 0.5f;
     }
 
-    return series;
+    if (k > 1) expandStrided(series, k, std::max(0, x1 - x0));
 }
 
 // NOTE: ADDED HERE — Extract volume per column (normalized 0..1)
 // Assumes volume bars are in a lower panel (above MACD), colored green/red on dark background.
 // Returns one value per candle column, aligned to the same x-range trimming style as extractCloseSeries().
 std::vector<float> Predictor::extractVolumeSeries(const std::string& imagePath) const {
-    sf::Image img;
-    if (!img.loadFromFile(imagePath)) {
-        throw std::runtime_error("Could not load image: " + imagePath);
-    }
+    const PixelBuffer& img = loadImage(imagePath);
+    std::vector<float> vol;
+    extractVolumeSeries(img.view(), layoutFor(img.view()), 1, vol);
+    return vol;
+}
 
-    const int W = (int)img.getSize().x;
-    const int H = (int)img.getSize().y;
+void Predictor::extractVolumeSeries(const ImageView& img, const ChartLayout& layout, int stride,
+                                    std::vector<float>& vol) const {
+    TRACE_SCOPE("extractVolumeSeries");
+    const int k = std::max(1, stride);
+    const int W = img.width, H = img.height;
 
     // match the same horizontal trimming as close extraction
-    const int leftCut   = (int)(0.03 * W);
-    const int rightCut  = (int)(0.02 * W);
-    const int x0 = leftCut;
-    const int x1 = W - rightCut;
-
-    // volume panel band (tuned for your screenshots)
-    const int volTop    = (int)(0.74 * H);
-    const int volBottom = (int)(0.89 * H);
+    const int x0 = std::max(0, layout.plot.x0);
+    const int x1 = std::min(W, layout.plot.x1);
 
-    std::vector<float> vol;
+    vol.clear();
     vol.reserve(std::max(0, x1 - x0));
 
-    // volume bar colors (green/red) + generous tolerance
-    const unsigned char gR = 0,   gG = 200, gB = 120;
-    const unsigned char rR = 200, rG = 60,  rB = 60;
-    const int tol = 70;
-
-    for (int x = x0; x < x1; x++) {
-        int barHeightPx = 0;
-        bool started = false;
-
-        for (int y = volBottom; y >= volTop; y--) {
-            sf::Color c = img.getPixel((unsigned)x, (unsigned)y);
-
-            bool isVolGreen = nearColor(c.r, c.g, c.b, gR, gG, gB, tol);
-            bool isVolRed   = nearColor(c.r, c.g, c.b, rR, rG, rB, tol);
+    // no volume panel on this layout: flat zero volume, still column-aligned
+    if (layout.volume.empty()) {
+        vol.assign(std::max(0, x1 - x0), 0.f);
+        return;
+    }
 
-            if (isVolGreen || isVolRed) {
-                started = true;
-                barHeightPx++;
-            } else {
-                if (started) break;
-            }
-        }
+    // volume panel band (legacy: 74..89% of height, bottom row inclusive)
+    const int volTop    = std::max(0, layout.volume.y0);
+    const int volBottom = std::min(H, layout.volume.y1) - 1;
 
-        double panelH = std::max(1, (volBottom - volTop));
-        double v01 = (double)barHeightPx / panelH;
-        vol.push_back((float)clamp(v01, 0.0, 1.0));
-    }
+    // volume bar colors (green/red) + generous tolerance
+    const DynamicColors colors{layout.volUp, layout.volDown, layout.volTolerance};
+    const PixelRect rect{x0, volTop, x1, volBottom + 1};
+    std::vector<int>& work = scratch().columns;
+    if (!withVolumeTheme(colors, RegisteredThemes{}, [&](auto theme) { scanVolume(img, rect, k, theme, work, vol); }))
+        scanVolume(img, rect, k, colors, work, vol);
 
     // light gap fill: if totally missing, treat as 0
     float last = -1.f;
@@ -220,7 +350,7 @@ std::vector<float> Predictor::extractVolumeSeries(const std::string& imagePath)
         else vol[i] = 0.f;
     }
 
-    return vol;
+    if (k > 1) expandStrided(vol, k, std::max(0, x1 - x0));
 }
 
 static double clamp01(double x) {
@@ -245,9 +375,13 @@ static void applyNeutralCalibration(Prediction& out, double adjustedScore) {
     out.signal = "NEUTRAL";
 }
 
-std::vector<float> Predictor::smoothSeries(const std::vector<float>& s, int window) {
-    if (window <= 1) return s;
-    std::vector<float> out(s.size(), 0.f);
+void Predictor::smoothSeries(SeriesSpan s, int window, std::vector<float>& out) {
+    TRACE_SCOPE("smoothSeries");
+    if (window <= 1) {
+        out.assign(s.begin(), s.end());
+        return;
+    }
+    out.assign(s.size(), 0.f);
 
     int w = std::max(1, window);
     for (int i = 0; i < (int)s.size(); i++) {
@@ -257,12 +391,12 @@ std::vector<float> Predictor::smoothSeries(const std::vector<float>& s, int wind
         for (int j = a; j <= b; j++) sum += s[j];
         out[i] = sum / (float)(b - a + 1);
     }
-    return out;
 }
 
-std::vector<Predictor::SwingPoint> Predictor::findSwings(const std::vector<float>& s, int window) {
-    std::vector<SwingPoint> swings;
-    if ((int)s.size() < 2 * window + 1) return swings;
+void Predictor::findSwings(SeriesSpan s, int window, std::vector<SwingPoint>& swings) {
+    TRACE_SCOPE("findSwings");
+    swings.clear();
+    if ((int)s.size() < 2 * window + 1) return;
 
     for (int i = window; i < (int)s.size() - window; i++) {
         float v = s[i];
@@ -279,41 +413,43 @@ std::vector<Predictor::SwingPoint> Predictor::findSwings(const std::vector<float
         else if (isMin) swings.push_back({i, v, false});
     }
 
-    std::vector<SwingPoint> cleaned;
+    // clean in place: the write index never passes the read index
+    size_t kept = 0;
     const float minMove = 0.02f;
-    for (const auto& sp : swings) {
-        if (cleaned.empty()) { cleaned.push_back(sp); continue; }
+    for (size_t i = 0; i < swings.size(); i++) {
+        const SwingPoint sp = swings[i];
+        if (kept == 0) { swings[kept++] = sp; continue; }
 
-        auto& last = cleaned.back();
+        auto& last = swings[kept - 1];
         if (sp.isHigh == last.isHigh) {
             if (sp.isHigh && sp.value > last.value) last = sp;
             if (!sp.isHigh && sp.value < last.value) last = sp;
         } else {
-            if (std::abs(sp.value - last.value) >= minMove) cleaned.push_back(sp);
+            if (std::abs(sp.value - last.value) >= minMove) swings[kept++] = sp;
         }
     }
-
-    return cleaned;
+    swings.resize(kept);
 }
 
 // ---------- features ----------
 double Predictor::trendScoreFromSwings(const std::vector<SwingPoint>& swings, FeatureBreakdown& bd) {
     if (swings.size() < 4) return 0.0;
 
+    // last two highs / lows among the last 10 swings
     int N = std::min(10, (int)swings.size());
-    std::vector<SwingPoint> tail(swings.end() - N, swings.end());
-
-    std::vector<float> highs, lows;
-    for (auto& sp : tail) {
-        if (sp.isHigh) highs.push_back(sp.value);
-        else lows.push_back(sp.value);
+    float highs[2], lows[2];
+    int nh = 0, nl = 0;
+    for (int i = (int)swings.size() - 1; i >= (int)swings.size() - N; i--) {
+        const auto& sp = swings[i];
+        if (sp.isHigh) { if (nh < 2) highs[nh++] = sp.value; }
+        else if (nl < 2) lows[nl++] = sp.value;
     }
-    if (highs.size() < 2 || lows.size() < 2) return 0.0;
+    if (nh < 2 || nl < 2) return 0.0;
 
-    float lastHigh = highs.back();
-    float prevHigh = highs[highs.size() - 2];
-    float lastLow  = lows.back();
-    float prevLow  = lows[lows.size() - 2];
+    float lastHigh = highs[0];
+    float prevHigh = highs[1];
+    float lastLow  = lows[0];
+    float prevLow  = lows[1];
 
     double score = 0.0;
     bool hh = (lastHigh > prevHigh);
@@ -330,7 +466,7 @@ double Predictor::trendScoreFromSwings(const std::vector<SwingPoint>& swings, Fe
     return score; // ~[-2,+2]
 }
 
-double Predictor::momentumScoreFromSeries(const std::vector<float>& s) {
+double Predictor::momentumScoreFromSeries(SeriesSpan s) {
     if (s.size() < 30) return 0.0;
 
     int n = (int)s.size();
@@ -341,41 +477,67 @@ double Predictor::momentumScoreFromSeries(const std::vector<float>& s) {
     float end   = s[b];
     float slope = end - start;
 
-    std::vector<float> deltas;
-    deltas.reserve(b - a);
-    for (int i = a + 1; i <= b; i++) deltas.push_back(s[i] - s[i - 1]);
-
-    float mean = std::accumulate(deltas.begin(), deltas.end(), 0.f) / (float)deltas.size();
+    // step deltas s[i]-s[i-1], two passes (same order as before, no buffer)
+    const float count = (float)(b - a);
+    float sum = 0.f;
+    for (int i = a + 1; i <= b; i++) sum += s[i] - s[i - 1];
+    float mean = sum / count;
     float var = 0.f;
-    for (float d : deltas) var += (d - mean) * (d - mean);
-    var /= (float)deltas.size();
+    for (int i = a + 1; i <= b; i++) {
+        float d = s[i] - s[i - 1];
+        var += (d - mean) * (d - mean);
+    }
+    var /= count;
     float stdev = std::sqrt(var);
 
     double score = 6.0 * (double)slope - 4.0 * (double)stdev;
     return clamp(score, -1.5, 1.5);
 }
 
+// MACD histogram in ATRs and RSI follow the trend, RSI fades it past 70/30
+// (continuous: +1 at 70 down to -1 at 100), and the close sits above/below
+// VWAP by up to two ATRs.
+double Predictor::indicatorScoreFromValues(const IndicatorValues& v, float lastClose, FeatureBreakdown& bd) {
+    if (!v.ready) return 0.0;
+    const double atr = std::max((double)v.atr, 1e-4);
+    const double rsi = v.rsi;
+
+    const double macdTerm = clamp((double)v.macdHist / atr, -1.0, 1.0);
+    double rsiTerm = (rsi - 50.0) / 20.0;
+    if (rsi > 70.0) {
+        rsiTerm = 1.0 - 2.0 * (rsi - 70.0) / 30.0;
+        bd.patterns.push_back("RSI_OVERBOUGHT");
+    } else if (rsi < 30.0) {
+        rsiTerm = -1.0 + 2.0 * (30.0 - rsi) / 30.0;
+        bd.patterns.push_back("RSI_OVERSOLD");
+    }
+    const double vwapTerm = clamp(((double)lastClose - (double)v.vwap) / (2.0 * atr), -1.0, 1.0);
+
+    return 0.6 * macdTerm + 0.5 * rsiTerm + 0.4 * vwapTerm; // ~[-1.5,+1.5]
+}
+
 double Predictor::doubleTopBottomScore(const std::vector<SwingPoint>& swings, FeatureBreakdown& bd) {
     if (swings.size() < 6) return 0.0;
 
-    std::vector<SwingPoint> highs, lows;
-    for (auto& sp : swings) (sp.isHigh ? highs : lows).push_back(sp);
+    // last two highs (h[0] newest) and last two lows
+    float h[2], l[2];
+    int nh = 0, nl = 0;
+    for (int i = (int)swings.size() - 1; i >= 0 && (nh < 2 || nl < 2); i--) {
+        if (swings[i].isHigh) { if (nh < 2) h[nh++] = swings[i].value; }
+        else if (nl < 2) l[nl++] = swings[i].value;
+    }
 
     const float tol = 0.015f;
     double score = 0.0;
 
-    if (highs.size() >= 2) {
-        auto h1 = highs[highs.size() - 2];
-        auto h2 = highs[highs.size() - 1];
-        if (std::abs(h2.value - h1.value) <= tol) {
+    if (nh >= 2) {
+        if (std::abs(h[0] - h[1]) <= tol) {
             score -= 1.2;
             bd.patterns.push_back("DOUBLE_TOP");
         }
     }
-    if (lows.size() >= 2) {
-        auto l1 = lows[lows.size() - 2];
-        auto l2 = lows[lows.size() - 1];
-        if (std::abs(l2.value - l1.value) <= tol) {
+    if (nl >= 2) {
+        if (std::abs(l[0] - l[1]) <= tol) {
             score += 1.2;
             bd.patterns.push_back("DOUBLE_BOTTOM");
         }
@@ -383,9 +545,10 @@ double Predictor::doubleTopBottomScore(const std::vector<SwingPoint>& swings, Fe
     return score;
 }
 
-std::vector<Predictor::Level> Predictor::findSupportResistance(const std::vector<SwingPoint>& swings) {
-    std::vector<Level> levels;
-    if (swings.size() < 6) return levels;
+void Predictor::findSupportResistance(const std::vector<SwingPoint>& swings, std::vector<Level>& levels) {
+    TRACE_SCOPE("findSupportResistance");
+    levels.clear();
+    if (swings.size() < 6) return;
 
     const float tol = 0.012f;
 
@@ -421,11 +584,9 @@ std::vector<Predictor::Level> Predictor::findSupportResistance(const std::vector
     std::sort(levels.begin(), levels.end(), [](const Level& a, const Level& b) {
         return a.price < b.price;
     });
-
-    return levels;
 }
 
-double Predictor::srScoreFromLevels(const std::vector<float>& series,
+double Predictor::srScoreFromLevels(SeriesSpan series,
                                    const std::vector<Level>& levels,
                                    FeatureBreakdown& bd) {
     if (series.empty() || levels.empty()) return 0.0;
@@ -463,8 +624,8 @@ double Predictor::srScoreFromLevels(const std::vector<float>& series,
 // -------------------------------
 // 🔴 BUY TYPE 2 — Breakout Buy (missing)  ✅ added
 // -------------------------------
-void Predictor::detectBreakoutBuy(const Series& s,
-                                 const std::vector<double>& resistanceLevels,
+void Predictor::detectBreakoutBuy(SeriesSpan close,
+                                 const std::vector<float>& resistanceLevels,
                                  double trendScore,
                                  bool& outBreakout,
                                  double& outScore,
@@ -474,9 +635,9 @@ void Predictor::detectBreakoutBuy(const Series& s,
     outR = 0.0;
 
     // We only need close for this simple breakout detector.
-    if (s.close.size() < 25 || resistanceLevels.empty()) return;
+    if (close.size() < 25 || resistanceLevels.empty()) return;
 
-    const double last = s.close.back();
+    const double last = close.back();
 
     // Find nearest resistance >= last (or nearest above in general)
     double r = 2.0;
@@ -498,9 +659,9 @@ void Predictor::detectBreakoutBuy(const Series& s,
     // Confirm we were "below/at" resistance recently (consolidation), then broke above
     const int K = 12;
     int belowCount = 0;
-    for (int i = (int)s.close.size() - K - 1; i < (int)s.close.size() - 1; i++) {
+    for (int i = (int)close.size() - K - 1; i < (int)close.size() - 1; i++) {
         if (i < 0) continue;
-        if (s.close[i] <= (r - holdBelowMargin)) belowCount++;
+        if (close[i] <= (r - holdBelowMargin)) belowCount++;
     }
 
     const bool brokeAbove = (last >= (r + clearMargin));
@@ -512,8 +673,8 @@ void Predictor::detectBreakoutBuy(const Series& s,
     double above = clamp((last - r) / 0.05, 0.0, 1.0); // normalize above-distance
     double mom = 0.0;
     {
-        int n = (int)s.close.size();
-        double prev = s.close[n - 6];
+        int n = (int)close.size();
+        double prev = close[n - 6];
         mom = clamp((last - prev) / 0.05, 0.0, 1.0);
     }
 
@@ -528,7 +689,7 @@ void Predictor::detectBreakoutBuy(const Series& s,
 
 // ---------- trade plan ----------
 void Predictor::buildTradePlan(Prediction& out,
-                               const std::vector<float>& series,
+                               SeriesSpan series,
                                const std::vector<Level>& levels) {
     if (series.empty()) return;
     double last = series.back();
@@ -563,9 +724,9 @@ void Predictor::buildTradePlan(Prediction& out,
     }
 }
 
-std::string Predictor::signalFromConfidence(double conf, const std::string& label) {
-    if (conf >= 80.0) return (label == "Bullish") ? "STRONG_BUY" : "STRONG_SELL";
-    if (conf >= 65.0) return (label == "Bullish") ? "BUY" : "SELL";
+std::string Predictor::signalFromConfidence(double conf, const std::string& label) const {
+    if (conf >= gates_.strongConfidence) return (label == "Bullish") ? "STRONG_BUY" : "STRONG_SELL";
+    if (conf >= gates_.buyConfidence) return (label == "Bullish") ? "BUY" : "SELL";
     return "NEUTRAL";
 }
 
@@ -577,18 +738,8 @@ int Predictor::timeframeFromFilename(const std::string& path) {
     return -1;
 }
 
-void Predictor::applyTimeframeWeights(int tfMinutes, double& tW, double& mW, double& rW, double& srW) {
-    if (tfMinutes == 1) {
-        tW *= 1.0;  mW *= 1.35; rW *= 1.10; srW *= 0.80;
-    } else if (tfMinutes == 5) {
-        tW *= 1.1;  mW *= 1.15; rW *= 1.10; srW *= 1.00;
-    } else if (tfMinutes == 30) {
-        tW *= 1.35; mW *= 0.85; rW *= 1.00; srW *= 1.35;
-    }
-}
-
 namespace {
-static double nearestDistanceToLevels(double x, const std::vector<double>& levels) {
+static double nearestDistanceToLevels(double x, const std::vector<float>& levels) {
     if (levels.empty()) return 1.0;
     double best = 1e9;
     for (double L : levels) best = std::min(best, std::abs(L - x));
@@ -636,113 +787,257 @@ static void suppressPlanIfNoTrade(Prediction& out) {
 }
 
 // ---------- core scoring ----------
-double Predictor::computeRawScore(const std::string& imagePath, FeatureBreakdown& bd,
-                                 std::vector<double>& supports, std::vector<double>& resistances) const {
-    auto close = extractCloseSeries(imagePath);
-    auto smooth = smoothSeries(close, 3);
-    auto swings = findSwings(smooth, 8);
-
-    auto levels = findSupportResistance(swings);
-    supports.clear(); resistances.clear();
-    for (auto& L : levels) {
-        if (L.isSupport) supports.push_back(L.price);
-        else resistances.push_back(L.price);
+double Predictor::combineScores(const FeatureBreakdown& bd, const Weights& w) {
+    double raw = w.trend * bd.trendScore + w.momentum * bd.momentumScore
+               + w.reversal * bd.reversalScore + w.sr * bd.srScore
+               + w.indicators * bd.indicatorScore;
+    return clamp(raw, -8.0, 8.0);
+}
+
+void Predictor::scoreTerms(const FeatureBreakdown& bd, const std::string& timeStr, int tfMinutes,
+                           double terms[kScoreTerms]) const {
+    Weights unit;
+    unit.trend = unit.momentum = unit.reversal = unit.sr = unit.indicators = 1.0;
+    for (const TimeframeMultipliers& s : timeframes_) {
+        if (s.minutes != tfMinutes) continue;
+        unit.trend = s.trend; unit.momentum = s.momentum; unit.reversal = s.reversal; unit.sr = s.sr;
+        break;
     }
+    const int minutes = timeToMinutes(timeStr);
+    const double m = timeAdjustmentMultiplier(minutes) * openConfidenceDecayMultiplier(minutes);
+    terms[kTermTrend] = bd.trendScore * unit.trend * m;
+    terms[kTermMomentum] = bd.momentumScore * unit.momentum * m;
+    terms[kTermReversal] = bd.reversalScore * unit.reversal * m;
+    terms[kTermSr] = bd.srScore * unit.sr * m;
+    terms[kTermIndicators] = bd.indicatorScore * unit.indicators * m;
+}
 
-    bd = FeatureBreakdown{};
-    double t  = trendScoreFromSwings(swings, bd);
-    double m  = momentumScoreFromSeries(smooth);
-    double r  = doubleTopBottomScore(swings, bd);
-    double sr = srScoreFromLevels(smooth, levels, bd);
+Predictor::Weights Predictor::weightsForTimeframe(int tfMinutes) const {
+    Weights w = w_;
+    for (const TimeframeMultipliers& s : timeframes_) {
+        if (s.minutes != tfMinutes) continue;
+        w.trend *= s.trend; w.momentum *= s.momentum; w.reversal *= s.reversal; w.sr *= s.sr;
+        break;
+    }
+    return w;
+}
 
-    bd.trendScore = t;
-    bd.momentumScore = m;
-    bd.reversalScore = r;
-    bd.srScore = sr;
+Prediction Predictor::predictFromPixels(const ImageView& img,
+                                        const std::string& timeStr,
+                                        bool hasScale, double minPrice, double maxPrice,
+                                        const Weights& w, int stride) const {
+    const ChartLayout layout = layoutFor(img);
+    Scratch& sc = scratch();
+    if (candleSegmentation_ && stride <= 1 &&
+        segmentCandles(img, layout, candleColors(layout), {layout.volUp, layout.volDown, layout.volTolerance},
+                       sc.candles, sc.columns)) {
+        Prediction out = predictFromSeries(sc.candles.view(), timeStr, hasScale, minPrice, maxPrice, w);
+        if (captureOverlay_) fillOverlay(out, sc.candles.close, &layout, hasScale, minPrice, maxPrice, &sc.candles);
+        return out;
+    }
 
-    double raw = w_.trend * t + w_.momentum * m + w_.reversal * r + w_.sr * sr;
-    raw = clamp(raw, -8.0, 8.0);
-    return raw;
+    SeriesBuffer& sb = sc.series;
+    extractCloseSeries(img, layout, stride, sb.close);
+    // volume is only read by the indicator pass (VWAP, see extractFeatures);
+    // at indicator weight 0 skip the scan
+    if (w_.indicators != 0.0)
+        extractVolumeSeries(img, layout, stride, sb.vol);
+    else
+        sb.vol.clear();
+    Prediction out = predictFromSeries(sb.view(), timeStr, hasScale, minPrice, maxPrice, w);
+    out.extractStride = std::max(1, stride);
+    if (captureOverlay_) fillOverlay(out, sb.close, &layout, hasScale, minPrice, maxPrice);
+    return out;
 }
 
-double Predictor::computeRawScore(const std::string& imagePath) const {
-    FeatureBreakdown bd;
-    std::vector<double> sup, res;
-    return computeRawScore(imagePath, bd, sup, res);
+// smooth/swings/levels are still in the scratch from the predictFromSeries call
+// that produced `out`; plan prices are mapped back to 0..1 if they were scaled.
+void Predictor::fillOverlay(Prediction& out, SeriesSpan close,
+                            const ChartLayout* layout, bool hasScale, double minPrice, double maxPrice,
+                            const CandleSeries* candles) {
+    const Scratch& sc = scratch();
+    PredictionOverlay& ov = out.overlay;
+    ov.valid = true;
+    if (layout) {
+        ov.imageWidth = layout->width;
+        ov.imageHeight = layout->height;
+        ov.plot = layout->plot;
+    }
+    ov.close.assign(close.begin(), close.end());
+    ov.smooth.assign(sc.features.smooth.begin(), sc.features.smooth.end());
+
+    ov.swings.clear();
+    for (const SwingPoint& sp : sc.features.swings) ov.swings.push_back({sp.idx, sp.value, sp.isHigh});
+
+    // one value per plot column again: each candle's value over its columns,
+    // held across the gaps; swings at the candle's middle column
+    if (candles && layout && candles->size() == close.size() && !close.empty()) {
+        const int x0 = layout->plot.x0, cols = std::max(0, layout->plot.width());
+        auto spread = [&](std::vector<float>& v) {
+            std::vector<float> perCandle;
+            perCandle.swap(v);
+            v.assign((size_t)cols, perCandle.front());
+            for (size_t k = 0; k < perCandle.size(); k++) {
+                const int end = k + 1 < perCandle.size() ? candles->x0[k + 1] : x0 + cols;
+                for (int x = std::max(x0, candles->x0[k]); x < std::min(x0 + cols, end); x++)
+                    v[(size_t)(x - x0)] = perCandle[k];
+            }
+        };
+        spread(ov.close);
+        spread(ov.smooth);
+        for (PredictionOverlay::Swing& sw : ov.swings)
+            sw.idx = (candles->x0[(size_t)sw.idx] + candles->x1[(size_t)sw.idx]) / 2 - x0;
+    }
+    ov.supports.clear();
+    ov.resistances.clear();
+    for (const Level& L : sc.features.levels) (L.isSupport ? ov.supports : ov.resistances).push_back(L.price);
+
+    auto norm = [&](double v) { return (hasScale && v != 0.0) ? realToNorm(v, minPrice, maxPrice) : v; };
+    ov.breakoutLevel = out.breakdown.breakoutBuy ? norm(out.breakdown.breakoutLevel) : 0.0;
+    const bool hasPlan = (out.label != "Neutral") && (out.riskRewardRatio > 0.0);
+    ov.stopLoss = hasPlan ? norm(out.stopLoss) : 0.0;
+    ov.target1 = hasPlan ? norm(out.target1) : 0.0;
+    ov.target2 = hasPlan ? norm(out.target2) : 0.0;
 }
 
-// ---------- public API ----------
-Prediction Predictor::predictWithTime(const std::string& imagePath,
-                                      const std::string& timeStr,
-                                      bool hasScale,
-                                      double minPrice,
-                                      double maxPrice) {
+// Everything after extraction: features (weight independent), then scoring.
+Prediction Predictor::predictFromSeries(const SeriesView& series,
+                                        const std::string& timeStr,
+                                        bool hasScale, double minPrice, double maxPrice,
+                                        const Weights& w) const {
+    TRACE_SCOPE("predictFromSeries");
+    // intermediates live in the per-thread scratch (series may view scratch().series)
+    Features& f = scratch().features;
+    extractFeatures(series, f);
+    return predictFromFeatures(f, timeStr, hasScale, minPrice, maxPrice, w, outputs_);
+}
+
+// Smoothing, swings, S/R, the component scores and the breakout check. Only
+// the configured indicator weight matters (zero skips the indicator pass);
+// the per-timeframe Weights and the confidence threshold do not.
+void Predictor::extractFeatures(SeriesSpan close01, SeriesSpan vol01, Features& f) const {
+    extractFeatures(SeriesView{close01, vol01}, f);
+}
+
+void Predictor::extractFeatures(const SeriesView& series, Features& f) const {
+    TRACE_SCOPE("extractFeatures");
+    const SeriesSpan close = series.close;
+    smoothSeries(close, 3, f.smooth);
+    findSwings(f.smooth, 8, f.swings);
+
+    // with real highs/lows, put each swing on the wick extreme around the turn
+    // (within the smoothing window)
+    if (series.high.size() == close.size() && series.low.size() == close.size()) {
+        const int last = (int)close.size() - 1;
+        for (SwingPoint& sp : f.swings) {
+            const SeriesSpan& ext = sp.isHigh ? series.high : series.low;
+            float v = ext[(size_t)sp.idx];
+            for (int i = std::max(0, sp.idx - 3); i <= std::min(last, sp.idx + 3); i++)
+                v = sp.isHigh ? std::max(v, ext[(size_t)i]) : std::min(v, ext[(size_t)i]);
+            sp.value = v;
+        }
+    }
+
+    findSupportResistance(f.swings, f.levels);
+
+    f.supports.clear();
+    f.resistances.clear();
+    for (auto& L : f.levels) {
+        if (L.isSupport) f.supports.push_back(L.price);
+        else f.resistances.push_back(L.price);
+    }
+
+    // reset field by field so patterns keeps its capacity
+    FeatureBreakdown& bd = f.breakdown;
+    bd.patterns.clear();
+    bd.rawScore = 0.0;
+    bd.trendScore = trendScoreFromSwings(f.swings, bd);
+    bd.momentumScore = momentumScoreFromSeries(f.smooth);
+    bd.reversalScore = doubleTopBottomScore(f.swings, bd);
+    bd.srScore = srScoreFromLevels(f.smooth, f.levels, bd);
+
+    // all indicators in one pass over the raw series (not the smoothed one:
+    // the EMAs smooth already)
+    bd.indicatorScore = 0.0;
+    if (w_.indicators != 0.0 && !close.empty())
+        bd.indicatorScore = indicatorScoreFromValues(f.indicators.replay(series), close.back(), bd);
+
+    // -------------------------------
+    // 🔴 BUY TYPE 2 — Breakout Buy (missing)  ✅ added
+    // -------------------------------
+    {
+        TRACE_SCOPE("detectBreakoutBuy");
+        detectBreakoutBuy(f.smooth, f.resistances, bd.trendScore, bd.breakoutBuy, bd.breakoutScore, bd.breakoutLevel);
+        if (bd.breakoutBuy) bd.patterns.push_back("TYPE2_BREAKOUT");
+    }
+}
+
+Prediction Predictor::predictFromFeatures(const Features& f,
+                                          const std::string& timeStr,
+                                          bool hasScale, double minPrice, double maxPrice,
+                                          const Weights& w, unsigned outputs) const {
+    // ids are unique across threads, so a prediction made on another thread
+    // never matches this thread's scratch
+    static std::atomic<std::uint64_t> nextExplainId{1};
+    auto& last = scratch().last;
+    last.id = nextExplainId.fetch_add(1, std::memory_order_relaxed);
+    last.features = &f;
+    last.timeStr = timeStr;
+    last.hasScale = hasScale;
+    last.minPrice = minPrice;
+    last.maxPrice = maxPrice;
+    last.w = w;
+
     int minutes = timeToMinutes(timeStr);
+    const std::vector<float>& smooth = f.smooth;
+    const std::vector<Level>& levels = f.levels;
 
-    FeatureBreakdown bd;
-    std::vector<double> supports, resistances;
-    double rawScore = computeRawScore(imagePath, bd, supports, resistances);
+    double rawScore = combineScores(f.breakdown, w);
 
     double m1 = timeAdjustmentMultiplier(minutes);
     double m2 = openConfidenceDecayMultiplier(minutes);
     double adjustedScore = rawScore * m1 * m2;
 
-    double compressed = adjustedScore / 2.5;
+    double compressed = adjustedScore / calib_.scale + calib_.bias;
     double pBull = sigmoid(compressed);
     double pBear = 1.0 - pBull;
 
     Prediction out;
+    out.explainId = last.id;
     out.pBull = pBull;
     out.pBear = pBear;
     out.label = (pBull >= 0.5) ? "Bullish" : "Bearish";
     out.confidence = 100.0 * std::max(pBull, pBear);
 
     // confidence calibration
-    const double neutralThreshold = 2.0;
-    if (std::abs(adjustedScore) < neutralThreshold) {
+    if (std::abs(adjustedScore) < gates_.neutralScore) {
         applyNeutralCalibration(out, adjustedScore);
     }
 
-    // Explainability
-    out.supportLevels = supports;
-    out.resistanceLevels = resistances;
-    bd.rawScore = adjustedScore;
-    out.breakdown = bd;
-
-    // Rebuild same pipeline (for plan + SR tagging)
-    auto close = extractCloseSeries(imagePath);
-    auto smooth = smoothSeries(close, 3);
-    auto swings = findSwings(smooth, 8);
-    auto levels = findSupportResistance(swings);
+    // Explainability (breakout fields/pattern come with the features); the
+    // level/pattern copies only when asked for, see setOutputs
+    if (outputs & kPredictPatterns) {
+        out.breakdown = f.breakdown;
+    } else {
+        FeatureBreakdown& bd = out.breakdown;
+        bd.trendScore = f.breakdown.trendScore;
+        bd.momentumScore = f.breakdown.momentumScore;
+        bd.reversalScore = f.breakdown.reversalScore;
+        bd.srScore = f.breakdown.srScore;
+        bd.indicatorScore = f.breakdown.indicatorScore;
+        bd.breakoutBuy = f.breakdown.breakoutBuy;
+        bd.breakoutScore = f.breakdown.breakoutScore;
+        bd.breakoutLevel = f.breakdown.breakoutLevel;
+    }
+    out.breakdown.rawScore = adjustedScore;
 
     double lastN = smooth.empty() ? 0.5 : (double)smooth.back();
 
     // ✅ (1) Active S/R tagging
-    tagActiveSR(out, lastN);
-
-    // -------------------------------
-    // 🔴 BUY TYPE 2 — Breakout Buy (missing)  ✅ added
-    // -------------------------------
-    {
-        Series s;
-        s.close.reserve(smooth.size());
-        for (float v : smooth) s.close.push_back((double)v);
-
-        // NOTE: ADDED HERE — extract volume aligned per column and attach to Series
-        auto vol = extractVolumeSeries(imagePath);
-        s.vol01.reserve(vol.size());
-        for (float vv : vol) s.vol01.push_back((double)vv);
-
-        bool breakout = false;
-        double bScore = 0.0;
-        double bLevel = 0.0;
-        detectBreakoutBuy(s, out.resistanceLevels, out.breakdown.trendScore, breakout, bScore, bLevel);
-
-        // Store in breakdown for UI/debug
-        out.breakdown.breakoutBuy = breakout;
-        out.breakdown.breakoutScore = bScore;
-        out.breakdown.breakoutLevel = bLevel;
-        if (breakout) out.breakdown.patterns.push_back("TYPE2_BREAKOUT");
+    if (outputs & kPredictLevels) {
+        out.supportLevels.assign(f.supports.begin(), f.supports.end());
+        out.resistanceLevels.assign(f.resistances.begin(), f.resistances.end());
+        tagActiveSR(out, lastN);
     }
 
     // If neutral, normally force no-trade plan
@@ -767,14 +1062,17 @@ Prediction Predictor::predictWithTime(const std::string& imagePath,
     }
 
     // Build plan
-    buildTradePlan(out, smooth, levels);
+    {
+        TRACE_SCOPE("buildTradePlan");
+        buildTradePlan(out, smooth, levels);
+    }
 
     // Penalize confidence if too close to barrier
-    double distToRes = nearestDistanceToLevels(lastN, out.resistanceLevels);
-    double distToSup = nearestDistanceToLevels(lastN, out.supportLevels);
+    double distToRes = nearestDistanceToLevels(lastN, f.resistances);
+    double distToSup = nearestDistanceToLevels(lastN, f.supports);
 
-    const double near   = 0.015;
-    const double closeT = 0.030;
+    const double near   = gates_.nearBarrier;
+    const double closeT = gates_.closeBarrier;
 
     if (out.label == "Bullish") {
         if (distToRes < near) out.confidence *= 0.65;
@@ -787,17 +1085,17 @@ Prediction Predictor::predictWithTime(const std::string& imagePath,
 
     // ✅ (2) R:R gating + plan suppression
     // HARD rule: if RR < 1.0 => no trade (prevents nonsense like 0.07 RR)
-    if (out.riskRewardRatio < 1.0) {
+    if (out.riskRewardRatio < gates_.minRR) {
         out.signal = "NEUTRAL";
         suppressPlanIfNoTrade(out);
     } else {
         // RR-aware signal gating
         double rr = out.riskRewardRatio;
-        if (rr < 1.2) out.signal = "NEUTRAL";
-        else if (rr < 1.8) out.signal = (out.label == "Bullish") ? "BUY" : "SELL";
+        if (rr < gates_.buyRR) out.signal = "NEUTRAL";
+        else if (rr < gates_.strongRR) out.signal = (out.label == "Bullish") ? "BUY" : "SELL";
         else {
-            if (out.confidence >= 80.0) out.signal = (out.label == "Bullish") ? "STRONG_BUY" : "STRONG_SELL";
-            else if (out.confidence >= 65.0) out.signal = (out.label == "Bullish") ? "BUY" : "SELL";
+            if (out.confidence >= gates_.strongConfidence) out.signal = (out.label == "Bullish") ? "STRONG_BUY" : "STRONG_SELL";
+            else if (out.confidence >= gates_.buyConfidence) out.signal = (out.label == "Bullish") ? "BUY" : "SELL";
             else out.signal = "NEUTRAL";
         }
 
@@ -806,9 +1104,9 @@ Prediction Predictor::predictWithTime(const std::string& imagePath,
         // 🔴 BUY TYPE 2 — Breakout Buy (missing)  ✅ added:
         // If breakout triggered, allow BUY even if the general confidenceThreshold would suppress it,
         // but ONLY when RR is acceptable.
-        if (out.breakdown.breakoutBuy && out.label == "Bullish" && out.riskRewardRatio >= 1.2) {
+        if (out.breakdown.breakoutBuy && out.label == "Bullish" && out.riskRewardRatio >= gates_.buyRR) {
             if (out.signal == "NEUTRAL") {
-                out.signal = (out.confidence >= 80.0) ? "STRONG_BUY" : "BUY";
+                out.signal = (out.confidence >= gates_.strongConfidence) ? "STRONG_BUY" : "BUY";
             }
         }
 
@@ -840,26 +1138,175 @@ Prediction Predictor::predictWithTime(const std::string& imagePath,
     return out;
 }
 
+// ---------- public API ----------
+Prediction Predictor::predictWithTime(const std::string& imagePath,
+                                      const std::string& timeStr,
+                                      bool hasScale,
+                                      double minPrice,
+                                      double maxPrice) {
+    TRACE_SCOPE("predictWithTime");
+    ConfigScope cs(*this);
+    return predictFromPixels(loadImage(imagePath).view(), timeStr, hasScale, minPrice, maxPrice, w_);
+}
+
 // ✅ TF-aware overload: adjusts weights depending on TF
 Prediction Predictor::predictWithTime(const std::string& imagePath,
                                       const std::string& timeStr,
                                       int tfMinutes) {
-    // Save current weights
-    Weights saved = w_;
+    // predict normalized (no scale)
+    return predictWithTime(imagePath, timeStr, tfMinutes, false, 0.0, 0.0);
+}
 
-    // Apply TF scaling to local weights then install
-    double tW = w_.trend, mW = w_.momentum, rW = w_.reversal, srW = w_.sr;
-    applyTimeframeWeights(tfMinutes, tW, mW, rW, srW);
-    w_.trend = tW; w_.momentum = mW; w_.reversal = rW; w_.sr = srW;
+Prediction Predictor::predictWithTime(const std::string& imagePath,
+                                      const std::string& timeStr,
+                                      int tfMinutes,
+                                      bool hasScale,
+                                      double minPrice,
+                                      double maxPrice) {
+    TRACE_SCOPE("predictWithTime");
+    return predictImage(loadImage(imagePath).view(), timeStr, tfMinutes, hasScale, minPrice, maxPrice);
+}
 
-    // predict normalized (no scale)
-    Prediction out = predictWithTime(imagePath, timeStr, false, 0.0, 0.0);
+// Everything that has pixels ends up here; nothing is copied out of the view.
+Prediction Predictor::predictImage(const ImageView& img,
+                                   const std::string& timeStr, int tfMinutes,
+                                   bool hasScale, double minPrice, double maxPrice) {
+    TRACE_SCOPE("predictImage");
+    ConfigScope cs(*this);
+    if (img.empty()) {
+        throw std::invalid_argument("predictImage: empty image view");
+    }
+    if (img.stride < (size_t)img.width * 4) {
+        throw std::invalid_argument("predictImage: stride smaller than width*4");
+    }
+    return predictFromPixels(img, timeStr, hasScale, minPrice, maxPrice, weightsForTimeframe(tfMinutes));
+}
 
-    // restore
-    w_ = saved;
+Prediction Predictor::predictRGBA(const unsigned char* rgba, int width, int height,
+                                  const std::string& timeStr, int tfMinutes,
+                                  bool hasScale, double minPrice, double maxPrice) {
+    return predictImage(ImageView(rgba, width, height), timeStr, tfMinutes, hasScale, minPrice, maxPrice);
+}
+
+Prediction Predictor::predictSeries(SeriesSpan close01,
+                                    SeriesSpan vol01,
+                                    const std::string& timeStr, int tfMinutes,
+                                    bool hasScale, double minPrice, double maxPrice) {
+    return predictSeries(SeriesView{close01, vol01}, timeStr, tfMinutes, hasScale, minPrice, maxPrice);
+}
+
+Prediction Predictor::predictSeries(const SeriesView& series,
+                                    const std::string& timeStr, int tfMinutes,
+                                    bool hasScale, double minPrice, double maxPrice) {
+    ConfigScope cs(*this);
+    Prediction out = predictFromSeries(series, timeStr, hasScale, minPrice, maxPrice, weightsForTimeframe(tfMinutes));
+    if (captureOverlay_) fillOverlay(out, series.close, nullptr, hasScale, minPrice, maxPrice);
     return out;
 }
 
+Prediction Predictor::predictFeatures(const Features& f, const std::string& timeStr, int tfMinutes,
+                                      bool hasScale, double minPrice, double maxPrice) const {
+    Prediction p = predictFromFeatures(f, timeStr, hasScale, minPrice, maxPrice, weightsForTimeframe(tfMinutes), outputs_);
+    // f is the caller's and may be gone by the time explain runs
+    scratch().last.features = nullptr;
+    p.explainId = 0;
+    return p;
+}
+
+// Scoring is cheap next to extraction: re-run it on the kept features with
+// everything switched on and take the parts the fast pass skipped.
+bool Predictor::explain(Prediction& p) const {
+    const auto& last = scratch().last;
+    if (!last.features || p.explainId == 0 || p.explainId != last.id) return false;
+    Prediction full = predictFromFeatures(*last.features, last.timeStr, last.hasScale, last.minPrice,
+                                          last.maxPrice, last.w, kPredictAll);
+    p.explainId = full.explainId;   // so explaining it again still matches
+    p.supportLevels = std::move(full.supportLevels);
+    p.resistanceLevels = std::move(full.resistanceLevels);
+    p.hasActiveSupport = full.hasActiveSupport;
+    p.hasActiveResistance = full.hasActiveResistance;
+    p.activeSupport = full.activeSupport;
+    p.activeResistance = full.activeResistance;
+    p.distToSupport = full.distToSupport;
+    p.distToResistance = full.distToResistance;
+    p.breakdown.patterns = std::move(full.breakdown.patterns);
+    return true;
+}
+
+void Predictor::extractSeries(const ImageView& img, std::vector<float>& close01,
+                              std::vector<float>& vol01) const {
+    const ChartLayout layout = layoutFor(img);
+    extractCloseSeries(img, layout, 1, close01);
+    extractVolumeSeries(img, layout, 1, vol01);
+}
+
+Prediction Predictor::predictPreview(const std::string& imagePath,
+                                     const std::string& timeStr, int tfMinutes, int stride,
+                                     bool hasScale, double minPrice, double maxPrice) {
+    TRACE_SCOPE("predictPreview");
+    ConfigScope cs(*this);
+    return predictFromPixels(loadImage(imagePath).view(), timeStr, hasScale, minPrice, maxPrice,
+                             weightsForTimeframe(tfMinutes), stride);
+}
+
+Prediction Predictor::predictTwoPass(const std::string& imagePath,
+                                     const std::string& timeStr, int tfMinutes, int stride,
+                                     bool hasScale, double minPrice, double maxPrice) {
+    TRACE_SCOPE("predictTwoPass");
+    ConfigScope cs(*this);
+    const ImageView img = loadImage(imagePath).view();
+    const Weights w = weightsForTimeframe(tfMinutes);
+
+    Prediction preview = predictFromPixels(img, timeStr, hasScale, minPrice, maxPrice, w, stride);
+    if (stride <= 1 || preview.signal == "NEUTRAL") return preview;
+    return predictFromPixels(img, timeStr, hasScale, minPrice, maxPrice, w, 1);
+}
+
+PreviewError Predictor::measurePreviewError(const std::string& imagePath, int tfMinutes, int stride) const {
+    return measurePreviewError(loadImage(imagePath).view(), tfMinutes, stride);
+}
+
+PreviewError Predictor::measurePreviewError(const ImageView& img, int tfMinutes, int stride) const {
+    using clock = std::chrono::steady_clock;
+    auto ms = [](clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+    PreviewError e;
+    e.stride = std::max(1, stride);
+    const ChartLayout layout = layoutFor(img);
+    const Weights w = weightsForTimeframe(tfMinutes);
+
+    std::vector<float> fullClose, fullVol, prevClose, prevVol;
+    auto t0 = clock::now();
+    extractCloseSeries(img, layout, 1, fullClose);
+    extractVolumeSeries(img, layout, 1, fullVol);
+    Prediction full = predictFromSeries({fullClose, fullVol}, "", false, 0.0, 0.0, w);
+    auto t1 = clock::now();
+    extractCloseSeries(img, layout, e.stride, prevClose);
+    extractVolumeSeries(img, layout, e.stride, prevVol);
+    Prediction prev = predictFromSeries({prevClose, prevVol}, "", false, 0.0, 0.0, w);
+    auto t2 = clock::now();
+
+    e.fullMs = ms(t1 - t0);
+    e.previewMs = ms(t2 - t1);
+
+    const size_t n = std::min(fullClose.size(), prevClose.size());
+    for (size_t i = 0; i < n; i++) {
+        double d = std::abs((double)prevClose[i] - (double)fullClose[i]);
+        e.closeMeanAbs += d;
+        e.closeMaxAbs = std::max(e.closeMaxAbs, d);
+    }
+    if (n) e.closeMeanAbs /= (double)n;
+
+    const size_t nv = std::min(fullVol.size(), prevVol.size());
+    for (size_t i = 0; i < nv; i++) e.volMeanAbs += std::abs((double)prevVol[i] - (double)fullVol[i]);
+    if (nv) e.volMeanAbs /= (double)nv;
+
+    e.pBullDelta = prev.pBull - full.pBull;
+    e.sameLabel = prev.label == full.label;
+    e.sameSignal = prev.signal == full.signal;
+    return e;
+}
+
 Prediction Predictor::predictAutoTF(const std::string& imagePath,
                                    const std::string& timeStr) {
     int tf = timeframeFromFilename(imagePath);
@@ -872,10 +1319,116 @@ Prediction Predictor::predictMultiTimeframe(const std::string& path1m,
                                            const std::string& path5m,
                                            const std::string& path30m,
                                            const std::string& timeStr) {
-    Prediction p1  = predictWithTime(path1m,  timeStr, 1);
-    Prediction p5  = predictWithTime(path5m,  timeStr, 5);
-    Prediction p30 = predictWithTime(path30m, timeStr, 30);
+    TRACE_SCOPE("predictMultiTimeframe");
+    ConfigScope cs(*this);
+    Prediction p1, p5, p30;
+    {
+        TRACE_SCOPE("tf1m");
+        p1 = predictWithTime(path1m, timeStr, 1);
+    }
+    {
+        TRACE_SCOPE("tf5m");
+        p5 = predictWithTime(path5m, timeStr, 5);
+    }
+    {
+        TRACE_SCOPE("tf30m");
+        p30 = predictWithTime(path30m, timeStr, 30);
+    }
+    return fuseTimeframes(p1, p5, p30);
+}
+
+Prediction Predictor::predictMultiTimeframeFromBase(const std::string& path1m, const std::string& timeStr,
+                                                    bool hasScale, double minPrice, double maxPrice) {
+    TRACE_SCOPE("predictMultiTimeframeFromBase");
+    return predictMultiTimeframeFromBase(loadImage(path1m).view(), timeStr, hasScale, minPrice, maxPrice);
+}
 
+// The 1m bars of a chart are its candles: 5m/30m group 5/30 candles. Plot
+// columns are not bars (their pitch has nothing to do with time), so a chart
+// that does not segment has none. Either way a single screenshot rarely holds
+// enough bars for a 30m view (see kMultiTimeframeMinBars).
+Prediction Predictor::predictMultiTimeframeFromBase(const ImageView& img1m, const std::string& timeStr,
+                                                    bool hasScale, double minPrice, double maxPrice) {
+    ConfigScope cs(*this);
+    Scratch& sc = scratch();
+    const ChartLayout layout = layoutFor(img1m);
+    {
+        TRACE_SCOPE("extract1m");
+        if (!segmentCandles(img1m, layout, candleColors(layout), {layout.volUp, layout.volDown, layout.volTolerance},
+                            sc.candles, sc.columns))
+            sc.candles.clear();   // no bars: insufficient data below
+    }
+    return multiTimeframeFromBars(sc.candles.view(), sc.candles.open, timeStr, hasScale, minPrice, maxPrice);
+}
+
+Prediction Predictor::predictMultiTimeframeFromBase(SeriesSpan close01, SeriesSpan vol01, const std::string& timeStr,
+                                                    bool hasScale, double minPrice, double maxPrice) {
+    return predictMultiTimeframeFromBase(SeriesView{close01, vol01}, timeStr, hasScale, minPrice, maxPrice);
+}
+
+Prediction Predictor::predictMultiTimeframeFromBase(const SeriesView& bars1m, const std::string& timeStr,
+                                                    bool hasScale, double minPrice, double maxPrice) {
+    ConfigScope cs(*this);
+    return multiTimeframeFromBars(bars1m, {}, timeStr, hasScale, minPrice, maxPrice);
+}
+
+// As predictMultiTimeframeBars (WalkForward.cpp) does for OHLCV files: the
+// bars go through resampleBars (no times, so grouped from the newest bar
+// back) and each view scores its last kMultiTimeframeLookback bars. The
+// values stay on the chart's 0..1 axis, so hasScale maps them as before.
+Prediction Predictor::multiTimeframeFromBars(const SeriesView& bars1m, SeriesSpan open1m, const std::string& timeStr,
+                                             bool hasScale, double minPrice, double maxPrice) const {
+    TRACE_SCOPE("predictMultiTimeframeFromBase");
+    const std::size_t n = bars1m.close.size();
+    if (n < (std::size_t)kMultiTimeframeMinBars * 30) {
+        // a 30m view shorter than the scoring windows is noise, and it anchors
+        // the fused bias + plan: say so instead of fusing it
+        Prediction out;
+        out.label = "Neutral";
+        out.signal = "NEUTRAL";
+        out.insufficientData = true;
+        return out;
+    }
+
+    const bool haveHL = bars1m.high.size() == n && bars1m.low.size() == n;
+    const bool haveVol = bars1m.vol.size() == n;
+    std::vector<OhlcvBar> base(n);
+    for (std::size_t i = 0; i < n; i++) {
+        OhlcvBar& b = base[i];
+        b.close = bars1m.close[i];
+        b.open = open1m.size() == n ? open1m[i] : bars1m.close[i > 0 ? i - 1 : 0];
+        b.high = haveHL ? bars1m.high[i] : std::max(b.open, b.close);
+        b.low = haveHL ? bars1m.low[i] : std::min(b.open, b.close);
+        b.volume = haveVol ? bars1m.vol[i] : 0.0;
+    }
+
+    Prediction views[3];
+    const int tfs[3] = {1, 5, 30};
+    std::vector<float> close, vol, high, low;
+    for (int k = 0; k < 3; k++) {
+        TRACE_SCOPE(k == 0 ? "tf1m" : k == 1 ? "tf5m" : "tf30m");
+        const std::vector<OhlcvBar> bars = resampleBars(base, tfs[k]);
+        const std::size_t begin =
+            bars.size() > (std::size_t)kMultiTimeframeLookback ? bars.size() - kMultiTimeframeLookback : 0;
+        close.clear();
+        vol.clear();
+        high.clear();
+        low.clear();
+        double vmax = 0.0;
+        for (std::size_t i = begin; i < bars.size(); i++) vmax = std::max(vmax, bars[i].volume);
+        for (std::size_t i = begin; i < bars.size(); i++) {
+            close.push_back((float)bars[i].close);
+            high.push_back((float)bars[i].high);
+            low.push_back((float)bars[i].low);
+            if (vmax > 0.0) vol.push_back((float)(bars[i].volume / vmax));
+        }
+        views[k] = predictFromSeries(SeriesView{close, vol, high, low}, timeStr, hasScale, minPrice, maxPrice,
+                                     weightsForTimeframe(tfs[k]));
+    }
+    return fuseTimeframes(views[0], views[1], views[2]);
+}
+
+Prediction Predictor::fuseTimeframes(const Prediction& p1, const Prediction& p5, const Prediction& p30) const {
     int bullCount = 0;
     bullCount += (p1.label == "Bullish");
     bullCount += (p5.label == "Bullish");
@@ -930,17 +1483,17 @@ Prediction Predictor::predictMultiTimeframe(const std::string& path1m,
             } else if (p30.label == "Neutral") {
                 // bias from 5m: require 1m agrees too
                 if (!agree15) out.signal = "NEUTRAL";
-                else out.signal = (rr >= 1.8 && out.confidence >= 80.0)
+                else out.signal = (rr >= gates_.strongRR && out.confidence >= gates_.strongConfidence)
                                   ? ((out.label == "Bullish") ? "STRONG_BUY" : "STRONG_SELL")
-                                  : ((rr >= 1.2) ? ((out.label == "Bullish") ? "BUY" : "SELL") : "NEUTRAL");
+                                  : ((rr >= gates_.buyRR) ? ((out.label == "Bullish") ? "BUY" : "SELL") : "NEUTRAL");
             } else {
                 // normal case: 30m bias
-                if (rr < 1.0) out.signal = "NEUTRAL";
-                else if (rr < 1.2) out.signal = "NEUTRAL";
-                else if (rr < 1.8) out.signal = (out.label == "Bullish") ? "BUY" : "SELL";
+                if (rr < gates_.minRR) out.signal = "NEUTRAL";
+                else if (rr < gates_.buyRR) out.signal = "NEUTRAL";
+                else if (rr < gates_.strongRR) out.signal = (out.label == "Bullish") ? "BUY" : "SELL";
                 else {
-                    if (out.confidence >= 80.0) out.signal = (out.label == "Bullish") ? "STRONG_BUY" : "STRONG_SELL";
-                    else if (out.confidence >= 65.0) out.signal = (out.label == "Bullish") ? "BUY" : "SELL";
+                    if (out.confidence >= gates_.strongConfidence) out.signal = (out.label == "Bullish") ? "STRONG_BUY" : "STRONG_SELL";
+                    else if (out.confidence >= gates_.buyConfidence) out.signal = (out.label == "Bullish") ? "BUY" : "SELL";
                     else out.signal = "NEUTRAL";
                 }
             }
@@ -1004,3 +1557,12 @@ std::map<std::string, double> Predictor::performanceMetrics() const {
     m["win_rate"] = (trades > 0) ? (100.0 * (double)wins / (double)trades) : 0.0;
     return m;
 }
+
+std::vector<double> Predictor::tradePnls() const {
+    std::vector<double> pnl;
+    pnl.reserve(history_.size());
+    for (const auto& r : history_) {
+        if (r.prediction.signal != "NEUTRAL") pnl.push_back(r.pnl);
+    }
+    return pnl;
+}
@@ -2,15 +2,26 @@
 // File: Predictor.h
 // ===============================
 #pragma once
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
+
+#include "CandleSegment.h"
+#include "ChartLayout.h"
+#include "ImageView.h"
+#include "Indicators.h"
+#include "PredictorConfig.h"
+#include "SeriesView.h"
 
 struct FeatureBreakdown {
     double trendScore = 0.0;
     double momentumScore = 0.0;
     double reversalScore = 0.0;
     double srScore = 0.0;
+    double indicatorScore = 0.0;       // MACD/RSI/VWAP term, 0 unless setIndicatorWeight
     double rawScore = 0.0;
     std::vector<std::string> patterns; // e.g. "HH_HL", "DOUBLE_BOTTOM"
 
@@ -20,6 +31,33 @@ struct FeatureBreakdown {
     double breakoutLevel = 0.0;        // normalized resistance used for breakout (0..1)
 };
 
+// What the extractor actually saw, for drawing over the chart. Only filled
+// when Predictor::setCaptureOverlay(true); costs a few copies per prediction.
+// Values are normalized 0..1 (1 = top of the plot), index = plot column.
+struct PredictionOverlay {
+    bool valid = false;
+    int imageWidth = 0, imageHeight = 0;   // 0 for predictSeries (no image)
+    PixelRect plot;                        // image pixels the series maps onto
+
+    std::vector<float> close;              // one value per plot column
+    std::vector<float> smooth;
+
+    struct Swing {
+        int idx = 0;
+        float value = 0.f;
+        bool isHigh = false;
+    };
+    std::vector<Swing> swings;
+
+    std::vector<float> supports, resistances;
+
+    // 0 = not set. Normalized even when the Prediction itself is in real prices.
+    double breakoutLevel = 0.0;
+    double stopLoss = 0.0;
+    double target1 = 0.0;
+    double target2 = 0.0;
+};
+
 struct Prediction {
     double pBull = 0.5;
     double pBear = 0.5;
@@ -58,6 +96,51 @@ struct Prediction {
     // (so they compare across scales).
     double distToSupport = 1.0;
     double distToResistance = 1.0;
+
+    // 1 = full resolution; k > 1 = fast preview that sampled every k-th column/row
+    int extractStride = 1;
+
+    PredictionOverlay overlay;  // see Predictor::setCaptureOverlay
+
+    // predictMultiTimeframeFromBase: too few bars for the 30m view, nothing scored
+    bool insufficientData = false;
+
+    // which predict* call made this, for Predictor::explain (0 = nothing to explain)
+    std::uint64_t explainId = 0;
+};
+
+// Prediction parts a caller can ask for (Predictor::setOutputs). Without them a
+// prediction is label/signal/pBull/pBear/confidence, the component scores,
+// breakout fields and trade plan; nothing else is copied or tagged.
+// Predictor::explain fills the rest in afterwards.
+enum PredictOutputs : unsigned {
+    kPredictSignal   = 0,
+    kPredictLevels   = 1u << 0,   // supportLevels/resistanceLevels, active S/R + distances
+    kPredictPatterns = 1u << 1,   // breakdown.patterns
+    kPredictAll      = kPredictLevels | kPredictPatterns,
+};
+
+// The weighted terms of the score, in Predictor::scoreTerms order.
+enum ScoreTerm : int {
+    kTermTrend,
+    kTermMomentum,
+    kTermReversal,
+    kTermSr,
+    kTermIndicators,
+    kScoreTerms
+};
+
+// Preview (stride k) vs full-resolution extraction of the same chart.
+struct PreviewError {
+    int stride = 1;
+    double closeMeanAbs = 0.0;  // mean |preview - full| over the close series (0..1 units)
+    double closeMaxAbs = 0.0;
+    double volMeanAbs = 0.0;
+    double pBullDelta = 0.0;    // preview.pBull - full.pBull
+    bool sameLabel = true;
+    bool sameSignal = true;
+    double previewMs = 0.0;     // extraction + scoring, decode excluded
+    double fullMs = 0.0;
 };
 
 struct BacktestResult {
@@ -73,6 +156,32 @@ struct BacktestResult {
     int barsHeld = 0;
 };
 
+// predictBatch input/output. tfMinutes <= 0: taken from the file name
+// (test5, _30m...), as predictAutoTF does; none there = untuned weights.
+struct BatchRequest {
+    std::string imagePath;
+    std::string timeStr;
+    int tfMinutes = -1;
+    bool hasScale = false;
+    double minPrice = 0.0, maxPrice = 0.0;
+};
+
+struct BatchResult {
+    std::size_t index = 0;      // position in the request list
+    bool ok = true;
+    std::string error;          // decode / prediction failure
+    Prediction prediction;
+    double decodeMs = 0.0;      // file read + decode, on an I/O thread
+    double predictMs = 0.0;     // extraction + scoring, on a compute thread
+};
+
+struct BatchOptions {
+    int ioThreads = 2;                // read + decode
+    int computeThreads = 0;           // 0 = hardware_concurrency
+    std::size_t maxInFlight = 0;      // decoded images held at once; 0 = 2 per compute thread
+    bool ordered = true;              // emit in request order (else as they finish)
+};
+
 class Predictor {
 public:
     Predictor();
@@ -89,6 +198,14 @@ public:
                                const std::string& timeStr,
                                int tfMinutes);
 
+    // TF weighting + real-price scale together
+    Prediction predictWithTime(const std::string& imagePath,
+                               const std::string& timeStr,
+                               int tfMinutes,
+                               bool hasScale,
+                               double minPrice,
+                               double maxPrice);
+
     static double normToReal(double n, double minP, double maxP) {
         return minP + n * (maxP - minP);
     }
@@ -96,6 +213,69 @@ public:
         return (maxP <= minP) ? 0.5 : (p - minP) / (maxP - minP);
     }
 
+    // In-memory pixels, read in place (no copy, no encode/decode round trip).
+    // Any stride, RGBA or BGRA. tfMinutes <= 0 means no TF weighting.
+    // The path-based overloads decode and then call this.
+    Prediction predictImage(const ImageView& img,
+                            const std::string& timeStr, int tfMinutes,
+                            bool hasScale = false, double minPrice = 0.0, double maxPrice = 0.0);
+
+    // Same, for tightly packed RGBA (width*height*4 bytes, top row first).
+    Prediction predictRGBA(const unsigned char* rgba, int width, int height,
+                           const std::string& timeStr, int tfMinutes,
+                           bool hasScale = false, double minPrice = 0.0, double maxPrice = 0.0);
+
+    // Pre-extracted series, normalized 0..1, oldest first. vol01 may be empty.
+    // Read in place (SeriesView.h); a std::vector<float> converts.
+    Prediction predictSeries(SeriesSpan close01,
+                             SeriesSpan vol01,
+                             const std::string& timeStr, int tfMinutes,
+                             bool hasScale = false, double minPrice = 0.0, double maxPrice = 0.0);
+    // With per-bar high/low too (same length as close): swing levels then sit
+    // on the wick extremes instead of the closes.
+    Prediction predictSeries(const SeriesView& series,
+                             const std::string& timeStr, int tfMinutes,
+                             bool hasScale = false, double minPrice = 0.0, double maxPrice = 0.0);
+
+    // predictSeries in two halves, for evaluating many parameter sets on the same
+    // data (walk-forward tuning): extractFeatures does smoothing, swings, S/R,
+    // the component scores and the breakout check, none of which depend on
+    // weights or the threshold (the indicator pass only runs at a non-zero
+    // indicator weight); predictFeatures applies this Predictor's
+    // weights/threshold. extractFeatures + predictFeatures == predictSeries.
+    struct Features;
+    void extractFeatures(SeriesSpan close01, SeriesSpan vol01, Features& out) const;
+    void extractFeatures(const SeriesView& series, Features& out) const;
+    Prediction predictFeatures(const Features& f, const std::string& timeStr, int tfMinutes,
+                               bool hasScale = false, double minPrice = 0.0, double maxPrice = 0.0) const;
+
+    // What predictFeatures multiplies each base weight by: component score x
+    // timeframe multiplier x session multipliers, so the adjusted score is
+    // sum(weight[k] * terms[k]) up to the +-8 clamp. The weight fitter's
+    // design matrix (WeightFit.h).
+    void scoreTerms(const FeatureBreakdown& bd, const std::string& timeStr, int tfMinutes,
+                    double terms[kScoreTerms]) const;
+
+    // Pixels -> what predictSeries takes (close and volume per plot column).
+    void extractSeries(const ImageView& img, std::vector<float>& close01, std::vector<float>& vol01) const;
+
+    // Fast preview: extraction samples every stride-th column and row (stride 2
+    // reads ~1/4 of the pixels, 4 ~1/16). Scores are coarser; use it to triage.
+    Prediction predictPreview(const std::string& imagePath,
+                              const std::string& timeStr, int tfMinutes, int stride,
+                              bool hasScale = false, double minPrice = 0.0, double maxPrice = 0.0);
+
+    // Preview first; full resolution only when the preview signal is not NEUTRAL.
+    // The image is decoded once. extractStride on the result says which one you got.
+    Prediction predictTwoPass(const std::string& imagePath,
+                              const std::string& timeStr, int tfMinutes, int stride,
+                              bool hasScale = false, double minPrice = 0.0, double maxPrice = 0.0);
+
+    // Run both extractions on one chart and report how far the preview drifts,
+    // to pick stride per timeframe.
+    PreviewError measurePreviewError(const std::string& imagePath, int tfMinutes, int stride) const;
+    PreviewError measurePreviewError(const ImageView& img, int tfMinutes, int stride) const;
+
     // Convenience: parse TF from filename like test1/test5/test30
     Prediction predictAutoTF(const std::string& imagePath,
                              const std::string& timeStr);
@@ -106,18 +286,132 @@ public:
                                      const std::string& path30m,
                                      const std::string& timeStr);
 
+    // Same decision from the finest timeframe only: the 1m bars are rolled up
+    // into 5m and 30m bars (resampleBars, OhlcvBars.h) and the last
+    // kMultiTimeframeLookback bars of each view are scored with its TF
+    // weights, as predictMultiTimeframeBars does for OHLCV files. Groups are
+    // built from the newest bar backwards, so the last bar of every view ends
+    // on the latest 1m bar.
+    // Every view needs kMultiTimeframeMinBars bars for the scoring windows, so
+    // fewer than 30x that many 1m bars gives a NEUTRAL result with
+    // insufficientData set and nothing scored. On a chart image the 1m bars are
+    // its candles (CandleSegment.h), whatever setCandleSegmentation says; a
+    // chart that does not segment has none. A screenshot's ~150 candles are
+    // far too few anyway: use predictMultiTimeframe with one chart per
+    // timeframe there.
+    Prediction predictMultiTimeframeFromBase(const std::string& path1m, const std::string& timeStr,
+                                             bool hasScale = false, double minPrice = 0.0,
+                                             double maxPrice = 0.0);
+    Prediction predictMultiTimeframeFromBase(const ImageView& img1m, const std::string& timeStr,
+                                             bool hasScale = false, double minPrice = 0.0,
+                                             double maxPrice = 0.0);
+    // 1m bars given directly; with high/low (OHLCV bars) the rolled-up bars
+    // keep the wick extremes.
+    Prediction predictMultiTimeframeFromBase(SeriesSpan close01, SeriesSpan vol01, const std::string& timeStr,
+                                             bool hasScale = false, double minPrice = 0.0,
+                                             double maxPrice = 0.0);
+    Prediction predictMultiTimeframeFromBase(const SeriesView& bars1m, const std::string& timeStr,
+                                             bool hasScale = false, double minPrice = 0.0,
+                                             double maxPrice = 0.0);
+
+    static constexpr int kMultiTimeframeMinBars = 30;    // momentum's window, the longest
+    static constexpr int kMultiTimeframeLookback = 120;  // bars scored per view
+
+    // The fusion step of predictMultiTimeframe, for callers that score the
+    // three views themselves (e.g. OHLCV bars resampled with resampleBars).
+    Prediction fuseTimeframes(const Prediction& p1, const Prediction& p5, const Prediction& p30) const;
+
+    // Many charts through a two-stage pipeline: I/O threads read + decode, compute
+    // threads (each with a copy of this Predictor) extract + score. Decoding
+    // stalls once maxInFlight decoded images are waiting, so memory stays
+    // bounded however long the list is, and decode overlaps with scoring
+    // instead of alternating with it. onResult runs on pipeline threads, one
+    // call at a time; returns when every request has been emitted. If onResult
+    // throws, the rest of the batch is dropped and the exception is rethrown
+    // here once the pipeline has stopped.
+    // Defined in PredictBatch.cpp: link stockpredict_batch.
+    using BatchCallback = std::function<void(const BatchResult&)>;
+    void predictBatch(const BatchRequest* requests, std::size_t count, const BatchOptions& opt,
+                      const BatchCallback& onResult) const;
+    std::vector<BatchResult> predictBatch(const std::vector<BatchRequest>& requests,
+                                          const BatchOptions& opt = {}) const;
+
     // Backtesting hooks (simple CSV)
     void addBacktestResult(const BacktestResult& r);
     void saveBacktestCSV(const std::string& filename) const;
     std::map<std::string, double> performanceMetrics() const;
+    // PnL of every non-NEUTRAL result in history order (what runMonteCarlo takes)
+    std::vector<double> tradePnls() const;
 
     // Configuration
     void setCandleColors(unsigned char bullR, unsigned char bullG, unsigned char bullB,
                          unsigned char bearR, unsigned char bearG, unsigned char bearB,
                          int tolerance);
+    // Candle colours of a registered theme (ExtractKernels.h: "default",
+    // "tradingview"); false if unknown. Registered colours get the
+    // compile-time specialized extraction, any other colours the generic one.
+    bool setColorTheme(const std::string& name);
     void setWeights(double trendW, double momentumW, double reversalW, double srW);
     void setConfidenceThreshold(double threshold);
 
+    // Weight of the indicator term (Indicators.h: MACD histogram vs ATR, RSI,
+    // close vs VWAP; ~[-1.5,+1.5] like momentum). 0, the default, leaves the
+    // indicators out entirely: extractFeatures skips the pass. Not scaled per
+    // timeframe.
+    void setIndicatorWeight(double w) { w_.indicators = w; }
+    double indicatorWeight() const { return w_.indicators; }
+
+    // pBull = sigmoid(adjusted score / scale + bias); 2.5 / 0 by default.
+    void setScoreCalibration(const ScoreCalibration& c);
+    const ScoreCalibration& scoreCalibration() const { return calib_; }
+
+    // All of the above plus the timeframe multipliers, volume colours, fixed
+    // layout cuts and signal gates, as one value (PredictorConfig.h).
+    void applyConfig(const PredictorConfig& cfg);
+    PredictorConfig config() const;
+
+    // Follow a ConfigStore: every predict* call first picks up a snapshot
+    // published since the last one (one atomic load when nothing changed), so
+    // a prediction, multi-timeframe ones included, runs on a single config.
+    // Copies made afterwards follow the same store. The const calls
+    // (predictFeatures, fuseTimeframes, predictBatch's caller) use whatever
+    // was picked up last. nullptr stops following.
+    void setConfigStore(std::shared_ptr<ConfigStore> store);
+
+    // Detect plot/volume panels + candle colours per chart layout instead of the
+    // fixed percentage cuts (off by default; config key layout = auto).
+    // Detection runs once per layout fingerprint; copies of this Predictor
+    // share the cache.
+    void setAutoLayout(bool enabled);
+    bool autoLayout() const { return autoLayout_; }
+    ChartLayout analyzeLayout(const std::string& imagePath) const;
+
+    // One point per candle instead of one per plot column (CandleSegment.h):
+    // real OHLC + volume, a series shorter by the candle width, swing levels
+    // on the wicks. Off by default; charts that don't segment cleanly (line
+    // charts, candles too dense to tell apart) and preview strides fall back
+    // to the column series. Config key series = candles.
+    void setCandleSegmentation(bool enabled) { candleSegmentation_ = enabled; }
+    bool candleSegmentation() const { return candleSegmentation_; }
+
+    // Copy the extracted series, swings, levels and plan into Prediction::overlay
+    // so a UI can draw them over the chart (off by default).
+    void setCaptureOverlay(bool enabled) { captureOverlay_ = enabled; }
+    bool captureOverlay() const { return captureOverlay_; }
+
+    // Which optional parts predictions fill (PredictOutputs mask, default all).
+    // kPredictSignal is the scanning mode: same signal, fewer copies.
+    void setOutputs(unsigned outputs) { outputs_ = outputs; }
+    unsigned outputs() const { return outputs_; }
+
+    // Fill the parts setOutputs left out, from the features the last
+    // single-chart predict* call on this thread kept (same rule as the overlay:
+    // call right after, on the same thread). p must be that call's result:
+    // anything else (an older prediction, another thread's, a predictFeatures
+    // one, whose Features are the caller's) is left as it is and false is
+    // returned. Multi-timeframe results only get the last view's parts.
+    bool explain(Prediction& p) const;
+
 private:
     struct ColorConfig {
         unsigned char bullR = 40,  bullG = 220, bullB = 140;
@@ -130,11 +424,40 @@ private:
         double momentum = 0.35;
         double reversal = 1.2;
         double sr = 0.6;
+        double indicators = 0.0;
     } w_;
 
     double confidenceThreshold_ = 60.0;
+    ScoreCalibration calib_;
     std::vector<BacktestResult> history_;
 
+    std::vector<TimeframeMultipliers> timeframes_ = PredictorConfig().timeframes;
+    RGB volUp_{0, 200, 120}, volDown_{200, 60, 60};
+    int volTolerance_ = 70;
+    LayoutCuts cuts_;
+    SignalGates gates_;
+
+    std::shared_ptr<ConfigStore> configStore_;
+    uint64_t configVersion_ = 0;
+    int configDepth_ = 0;
+
+    // Picks up a new store snapshot at the outermost predict* call only.
+    void syncConfig();
+    struct ConfigScope {
+        explicit ConfigScope(Predictor& p) : p(p) {
+            if (p.configDepth_++ == 0) p.syncConfig();
+        }
+        ~ConfigScope() { p.configDepth_--; }
+        Predictor& p;
+    };
+
+    bool autoLayout_ = false;
+    std::shared_ptr<ChartLayoutCache> layoutCache_;
+
+    bool captureOverlay_ = false;
+    bool candleSegmentation_ = false;
+    unsigned outputs_ = kPredictAll;
+
     struct SwingPoint {
         int idx = 0;
         float value = 0.f; // normalized 0..1
@@ -148,19 +471,44 @@ private:
         bool isSupport = false;
     };
 
+public:
+    // declared above; defined here, after SwingPoint/Level
+    struct Features {
+        std::vector<float> smooth;
+        std::vector<SwingPoint> swings;
+        std::vector<Level> levels;
+        std::vector<float> supports, resistances;   // normalized, split from levels
+        FeatureBreakdown breakdown;                 // component scores + breakout; rawScore unset
+        IndicatorStream indicators;                 // after the last bar (only run at indicator weight != 0)
+    };
+
+private:
+    // Per-thread buffers reused by every prediction on that thread: they grow to
+    // the high-water mark once and are then recycled (decoded pixels live in
+    // the thread's PixelBuffer, see loadImage in Predictor.cpp).
+    struct Scratch {
+        SeriesBuffer series;        // extracted close/vol
+        CandleSeries candles;       // or per-candle, see setCandleSegmentation
+        std::vector<int> columns;   // per-column tallies of the extraction scans
+        Features features;
+
+        // what the last predictFromFeatures scored, for explain()
+        struct {
+            std::uint64_t id = 0;                   // Prediction::explainId it was scored for
+            const Features* features = nullptr;
+            std::string timeStr;
+            bool hasScale = false;
+            double minPrice = 0.0, maxPrice = 0.0;
+            Weights w;
+        } last;
+    };
+    static Scratch& scratch();
+
     // -------------------------------
     // 🔴 BUY TYPE 2 — Breakout Buy (missing)  ✅ added
     // -------------------------------
-    struct Series {
-        std::vector<double> open;   // normalized 0..1
-        std::vector<double> high;   // normalized 0..1
-        std::vector<double> low;    // normalized 0..1
-        std::vector<double> close;  // normalized 0..1
-        std::vector<double> vol01;  // optional normalized 0..1; can be empty
-    };
-
-    void detectBreakoutBuy(const Series& s,
-                           const std::vector<double>& resistanceLevels,
+    void detectBreakoutBuy(SeriesSpan close,
+                           const std::vector<float>& resistanceLevels,
                            double trendScore,
                            bool& outBreakout,
                            double& outScore,
@@ -178,39 +526,69 @@ private:
                           unsigned char tr, unsigned char tg, unsigned char tb,
                           int tol);
 
+    ChartLayout layoutFor(const ImageView& img) const;
+    // the configured cuts and volume colours (layout = fixed, and what auto falls back to)
+    ChartLayout fixedLayout(int W, int H) const;
+    // configured candle colours, or the layout's detected ones
+    DynamicColors candleColors(const ChartLayout& layout) const;
+
     std::vector<float> extractCloseSeries(const std::string& imagePath) const;
+    void extractCloseSeries(const ImageView& img, const ChartLayout& layout, int stride,
+                            std::vector<float>& out) const;
     // NOTE: ADDED HERE — volume extraction (normalized 0..1)
     std::vector<float> extractVolumeSeries(const std::string& imagePath) const;
+    void extractVolumeSeries(const ImageView& img, const ChartLayout& layout, int stride,
+                             std::vector<float>& out) const;
 
-    static std::vector<float> smoothSeries(const std::vector<float>& s, int window);
-    static std::vector<SwingPoint> findSwings(const std::vector<float>& s, int window);
+    static void smoothSeries(SeriesSpan s, int window, std::vector<float>& out);
+    static void findSwings(SeriesSpan s, int window, std::vector<SwingPoint>& out);
 
     // Features
     static double trendScoreFromSwings(const std::vector<SwingPoint>& swings, FeatureBreakdown& bd);
-    static double momentumScoreFromSeries(const std::vector<float>& s);
+    static double momentumScoreFromSeries(SeriesSpan s);
     static double doubleTopBottomScore(const std::vector<SwingPoint>& swings, FeatureBreakdown& bd);
-    static std::vector<Level> findSupportResistance(const std::vector<SwingPoint>& swings);
-    static double srScoreFromLevels(const std::vector<float>& series,
+    static void findSupportResistance(const std::vector<SwingPoint>& swings, std::vector<Level>& out);
+    static double srScoreFromLevels(SeriesSpan series,
                                     const std::vector<Level>& levels,
                                     FeatureBreakdown& bd);
+    static double indicatorScoreFromValues(const IndicatorValues& v, float lastClose, FeatureBreakdown& bd);
 
     // Risk plan + signal
     static void buildTradePlan(Prediction& out,
-                               const std::vector<float>& series,
+                               SeriesSpan series,
                                const std::vector<Level>& levels);
 
-    static std::string signalFromConfidence(double conf, const std::string& label);
-
-    // Core scoring
-    double computeRawScore(const std::string& imagePath, FeatureBreakdown& bd,
-                           std::vector<double>& supports, std::vector<double>& resistances) const;
-
-    // convenience
-    double computeRawScore(const std::string& imagePath) const;
+    std::string signalFromConfidence(double conf, const std::string& label) const;
+
+    // Prediction::overlay from the current thread's scratch (call right after
+    // scoring). Per-candle series are spread back over the candles' columns.
+    static void fillOverlay(Prediction& out, SeriesSpan close,
+                            const ChartLayout* layout, bool hasScale, double minPrice, double maxPrice,
+                            const CandleSeries* candles = nullptr);
+
+    // Core scoring: weighted sum of the component scores, clamped
+    static double combineScores(const FeatureBreakdown& bd, const Weights& w);
+
+    // Pipeline after decode / after extraction (weights passed in, members untouched)
+    Prediction predictFromPixels(const ImageView& img,
+                                 const std::string& timeStr,
+                                 bool hasScale, double minPrice, double maxPrice,
+                                 const Weights& w, int stride = 1) const;
+    // predictMultiTimeframeFromBase's scoring; open1m may be empty
+    Prediction multiTimeframeFromBars(const SeriesView& bars1m, SeriesSpan open1m, const std::string& timeStr,
+                                      bool hasScale, double minPrice, double maxPrice) const;
+    Prediction predictFromSeries(const SeriesView& series,
+                                 const std::string& timeStr,
+                                 bool hasScale, double minPrice, double maxPrice,
+                                 const Weights& w) const;
+    Prediction predictFromFeatures(const Features& f,
+                                   const std::string& timeStr,
+                                   bool hasScale, double minPrice, double maxPrice,
+                                   const Weights& w, unsigned outputs) const;
 
     // Timeframe handling
     static int timeframeFromFilename(const std::string& path);
-    static void applyTimeframeWeights(int tfMinutes, double& tW, double& mW, double& rW, double& srW);
+    Weights weightsForTimeframe(int tfMinutes) const;
 };
 
 
@@ -0,0 +1,343 @@
+// ===============================
+// File: PredictorConfig.cpp
+// ===============================
+#include "PredictorConfig.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "ExtractKernels.h"
+
+namespace {
+
+std::string trim(const std::string& s) {
+    std::size_t a = 0, b = s.size();
+    while (a < b && (s[a] == ' ' || s[a] == '\t')) a++;
+    while (b > a && (s[b - 1] == ' ' || s[b - 1] == '\t' || s[b - 1] == '\r')) b--;
+    return s.substr(a, b - a);
+}
+
+bool parseDoubles(const std::string& v, double* out, int n) {
+    std::stringstream ss(v);
+    std::string cell;
+    int i = 0;
+    while (std::getline(ss, cell, ',')) {
+        cell = trim(cell);
+        if (i >= n || cell.empty()) return false;
+        char* end = nullptr;
+        out[i++] = std::strtod(cell.c_str(), &end);
+        if (!end || *end != '\0') return false;
+    }
+    return i == n;
+}
+
+bool parseRGB(const std::string& v, RGB& out) {
+    double c[3];
+    if (!parseDoubles(v, c, 3)) return false;
+    for (double x : c)
+        if (x < 0.0 || x > 255.0 || x != (int)x) return false;
+    out = {(unsigned char)c[0], (unsigned char)c[1], (unsigned char)c[2]};
+    return true;
+}
+
+template <class Theme>
+bool applyTheme(const std::string& name, PredictorConfig& c) {
+    if (name != Theme::name) return false;
+    c.bull = Theme::bull;
+    c.bear = Theme::bear;
+    c.tolerance = Theme::tolerance;
+    c.volUp = Theme::volUp;
+    c.volDown = Theme::volDown;
+    c.volTolerance = Theme::volTolerance;
+    return true;
+}
+
+template <class... Themes>
+bool applyNamedTheme(const std::string& name, PredictorConfig& c, ThemeList<Themes...>) {
+    return (applyTheme<Themes>(name, c) || ...);
+}
+
+// the checks that would otherwise show up as an empty plot or nonsense signals
+std::string validate(const PredictorConfig& c) {
+    const LayoutCuts& k = c.cuts;
+    auto frac = [](double x) { return x >= 0.0 && x < 1.0; };
+    if (!frac(k.top) || !frac(k.bottom) || !frac(k.left) || !frac(k.right) || !frac(k.volumeTop) ||
+        !frac(k.volumeBottom))
+        return "cut.* must be in [0, 1)";
+    if (k.top + k.bottom >= 1.0 || k.left + k.right >= 1.0) return "cuts leave no plot area";
+    if (k.volumeTop > k.volumeBottom) return "cut.volume_top is below cut.volume_bottom";
+    if (c.tolerance < 0 || c.tolerance > 255 || c.volTolerance < 0 || c.volTolerance > 255)
+        return "tolerances must be 0..255";
+    const SignalGates& g = c.gates;
+    if (!(g.minRR <= g.buyRR && g.buyRR <= g.strongRR)) return "need gate.min_rr <= gate.buy_rr <= gate.strong_rr";
+    if (g.nearBarrier > g.closeBarrier) return "gate.near_barrier is above gate.close_barrier";
+    if (!(c.calibration.scale > 0.0)) return "calib.scale must be > 0";
+    return "";
+}
+
+} // namespace
+
+bool parsePredictorConfig(const std::string& text, PredictorConfig& out, std::string* error) {
+    PredictorConfig c;
+    std::stringstream in(text);
+    std::string line;
+    int lineNo = 0;
+    auto fail = [&](const std::string& msg) {
+        if (error) *error = "line " + std::to_string(lineNo) + ": " + msg;
+        return false;
+    };
+
+    while (std::getline(in, line)) {
+        lineNo++;
+        const std::size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        line = trim(line);
+        if (line.empty()) continue;
+        const std::size_t eq = line.find('=');
+        if (eq == std::string::npos) return fail("expected key = value");
+        const std::string key = trim(line.substr(0, eq)), v = trim(line.substr(eq + 1));
+
+        double d[4];
+        double* num = nullptr;
+        if (key == "trend") num = &c.trend;
+        else if (key == "momentum") num = &c.momentum;
+        else if (key == "reversal") num = &c.reversal;
+        else if (key == "sr") num = &c.sr;
+        else if (key == "indicators") num = &c.indicators;
+        else if (key == "threshold") num = &c.confidenceThreshold;
+        else if (key == "calib.scale") num = &c.calibration.scale;
+        else if (key == "calib.bias") num = &c.calibration.bias;
+        else if (key == "cut.top") num = &c.cuts.top;
+        else if (key == "cut.bottom") num = &c.cuts.bottom;
+        else if (key == "cut.left") num = &c.cuts.left;
+        else if (key == "cut.right") num = &c.cuts.right;
+        else if (key == "cut.volume_top") num = &c.cuts.volumeTop;
+        else if (key == "cut.volume_bottom") num = &c.cuts.volumeBottom;
+        else if (key == "gate.neutral_score") num = &c.gates.neutralScore;
+        else if (key == "gate.min_rr") num = &c.gates.minRR;
+        else if (key == "gate.buy_rr") num = &c.gates.buyRR;
+        else if (key == "gate.strong_rr") num = &c.gates.strongRR;
+        else if (key == "gate.buy_confidence") num = &c.gates.buyConfidence;
+        else if (key == "gate.strong_confidence") num = &c.gates.strongConfidence;
+        else if (key == "gate.near_barrier") num = &c.gates.nearBarrier;
+        else if (key == "gate.close_barrier") num = &c.gates.closeBarrier;
+
+        if (num) {
+            if (!parseDoubles(v, num, 1)) return fail("expected a number for " + key);
+        } else if (key == "tolerance" || key == "vol_tolerance") {
+            if (!parseDoubles(v, d, 1) || d[0] != (int)d[0]) return fail("expected an integer for " + key);
+            (key == "tolerance" ? c.tolerance : c.volTolerance) = (int)d[0];
+        } else if (key == "bull" || key == "bear" || key == "vol_up" || key == "vol_down") {
+            RGB& dst = key == "bull" ? c.bull : key == "bear" ? c.bear : key == "vol_up" ? c.volUp : c.volDown;
+            if (!parseRGB(v, dst)) return fail("expected r,g,b (0..255) for " + key);
+        } else if (key == "layout") {
+            if (v != "fixed" && v != "auto") return fail("expected fixed or auto for layout");
+            c.autoLayout = v == "auto";
+        } else if (key == "series") {
+            if (v != "columns" && v != "candles") return fail("expected columns or candles for series");
+            c.candleSegmentation = v == "candles";
+        } else if (key == "theme") {
+            if (!applyNamedTheme(v, c, RegisteredThemes{})) return fail("unknown theme '" + v + "'");
+        } else if (key.compare(0, 3, "tf.") == 0) {
+            char* end = nullptr;
+            const long minutes = std::strtol(key.c_str() + 3, &end, 10);
+            if (!end || *end != '\0' || minutes <= 0) return fail("expected tf.<minutes>");
+            if (!parseDoubles(v, d, 4)) return fail("expected trend, momentum, reversal, sr for " + key);
+            const TimeframeMultipliers m{(int)minutes, d[0], d[1], d[2], d[3]};
+            bool replaced = false;
+            for (TimeframeMultipliers& t : c.timeframes)
+                if (t.minutes == m.minutes) t = m, replaced = true;
+            if (!replaced) c.timeframes.push_back(m);
+        } else {
+            return fail("unknown key '" + key + "'");
+        }
+    }
+
+    const std::string bad = validate(c);
+    if (!bad.empty()) {
+        if (error) *error = bad;
+        return false;
+    }
+    out = std::move(c);
+    return true;
+}
+
+bool loadPredictorConfig(const std::string& path, PredictorConfig& out, std::string* error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    std::stringstream ss;
+    ss << in.rdbuf();
+    if (!parsePredictorConfig(ss.str(), out, error)) {
+        if (error) *error = path + ": " + *error;
+        return false;
+    }
+    return true;
+}
+
+std::string formatPredictorConfig(const PredictorConfig& c) {
+    std::ostringstream o;
+    o.precision(10);
+    auto rgb = [](RGB x) {
+        return std::to_string(x.r) + "," + std::to_string(x.g) + "," + std::to_string(x.b);
+    };
+    o << "# weights\n"
+      << "trend = " << c.trend << "\nmomentum = " << c.momentum << "\nreversal = " << c.reversal
+      << "\nsr = " << c.sr << "\nindicators = " << c.indicators << "\nthreshold = " << c.confidenceThreshold
+      << "\ncalib.scale = " << c.calibration.scale << "\ncalib.bias = " << c.calibration.bias
+      << "\n\n# timeframe multipliers: trend, momentum, reversal, sr\n";
+    for (const TimeframeMultipliers& t : c.timeframes)
+        o << "tf." << t.minutes << " = " << t.trend << ", " << t.momentum << ", " << t.reversal << ", " << t.sr << "\n";
+    o << "\n# colours\n"
+      << "bull = " << rgb(c.bull) << "\nbear = " << rgb(c.bear) << "\ntolerance = " << c.tolerance
+      << "\nvol_up = " << rgb(c.volUp) << "\nvol_down = " << rgb(c.volDown) << "\nvol_tolerance = " << c.volTolerance
+      << "\n\n# layout: fixed cuts (fractions of the image), or auto-detected per chart;\n"
+      << "# series: one point per plot column, or per candle\n"
+      << "layout = " << (c.autoLayout ? "auto" : "fixed") << "\nseries = " << (c.candleSegmentation ? "candles" : "columns")
+      << "\ncut.top = " << c.cuts.top << "\ncut.bottom = " << c.cuts.bottom << "\ncut.left = " << c.cuts.left
+      << "\ncut.right = " << c.cuts.right << "\ncut.volume_top = " << c.cuts.volumeTop
+      << "\ncut.volume_bottom = " << c.cuts.volumeBottom << "\n\n# signal gating\n"
+      << "gate.neutral_score = " << c.gates.neutralScore << "\ngate.min_rr = " << c.gates.minRR
+      << "\ngate.buy_rr = " << c.gates.buyRR << "\ngate.strong_rr = " << c.gates.strongRR
+      << "\ngate.buy_confidence = " << c.gates.buyConfidence << "\ngate.strong_confidence = " << c.gates.strongConfidence
+      << "\ngate.near_barrier = " << c.gates.nearBarrier << "\ngate.close_barrier = " << c.gates.closeBarrier << "\n";
+    return o.str();
+}
+
+bool savePredictorConfig(const std::string& path, const PredictorConfig& cfg, std::string* error) {
+    // write + rename, so a watcher never reads half a file
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out << formatPredictorConfig(cfg);
+        if (!out) {
+            if (error) *error = "cannot write " + tmp;
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        if (error) *error = "cannot replace " + path + ": " + ec.message();
+        return false;
+    }
+    return true;
+}
+
+// ---------- ConfigStore ----------
+
+ConfigStore::ConfigStore(PredictorConfig initial)
+    : cfg_(std::make_shared<const PredictorConfig>(std::move(initial))) {}
+
+std::shared_ptr<const PredictorConfig> ConfigStore::current() const {
+    return std::atomic_load(&cfg_);
+}
+
+void ConfigStore::publish(PredictorConfig cfg) {
+    std::atomic_store(&cfg_, std::shared_ptr<const PredictorConfig>(std::make_shared<const PredictorConfig>(std::move(cfg))));
+    version_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+// ---------- ConfigWatcher ----------
+
+struct ConfigWatcher::Impl {
+    std::shared_ptr<ConfigStore> store;
+    std::string path;
+    int pollMs;
+    Callback cb;
+
+    Impl(std::shared_ptr<ConfigStore> store, std::string path, int pollMs, Callback cb)
+        : store(std::move(store)), path(std::move(path)), pollMs(pollMs), cb(std::move(cb)) {}
+
+    std::thread thread;
+    std::mutex mu;
+    std::condition_variable cv;
+    bool quit = false;
+
+    // serializes loads (watcher thread vs reload()) and guards the stamp
+    std::mutex loadMu;
+    // last stamp that was tried (good or bad): only a change triggers a retry
+    std::filesystem::file_time_type mtime{};
+    uintmax_t size = 0;
+
+    bool stamp(std::filesystem::file_time_type& t, uintmax_t& s) const {
+        std::error_code ec;
+        t = std::filesystem::last_write_time(path, ec);
+        if (ec) return false;
+        s = std::filesystem::file_size(path, ec);
+        return !ec;
+    }
+
+    bool load(std::string* error) {
+        std::lock_guard<std::mutex> lk(loadMu);
+        return loadLocked(error);
+    }
+
+    bool loadLocked(std::string* error) {
+        const bool exists = stamp(mtime, size);
+        PredictorConfig cfg;
+        std::string err;
+        // an editor that truncates before writing: parsing that would reset everything to defaults
+        const bool empty = exists && size == 0;
+        if (empty) err = path + ": empty, keeping the current config";
+        if (empty || !loadPredictorConfig(path, cfg, &err)) {
+            if (cb) cb(false, err);
+            if (error) *error = err;
+            return false;
+        }
+        store->publish(std::move(cfg));
+        if (cb) cb(true, "loaded " + path);
+        return true;
+    }
+
+    void poll() {
+        std::lock_guard<std::mutex> lk(loadMu);
+        std::filesystem::file_time_type t;
+        uintmax_t s = 0;
+        if (!stamp(t, s) || (t == mtime && s == size)) return;
+        loadLocked(nullptr);
+    }
+
+    void loop() {
+        std::unique_lock<std::mutex> lk(mu);
+        while (!cv.wait_for(lk, std::chrono::milliseconds(pollMs), [&] { return quit; })) {
+            lk.unlock();
+            poll();
+            lk.lock();
+        }
+    }
+};
+
+ConfigWatcher::ConfigWatcher(std::shared_ptr<ConfigStore> store, std::string path, int pollMs, Callback cb)
+    : impl_(std::make_unique<Impl>(std::move(store), std::move(path), std::max(10, pollMs), std::move(cb))) {}
+
+ConfigWatcher::~ConfigWatcher() { stop(); }
+
+bool ConfigWatcher::start(std::string* error) {
+    if (impl_->thread.joinable()) return true;
+    if (!impl_->load(error)) return false;
+    impl_->quit = false;
+    impl_->thread = std::thread([this] { impl_->loop(); });
+    return true;
+}
+
+void ConfigWatcher::stop() {
+    if (!impl_->thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lk(impl_->mu);
+        impl_->quit = true;
+    }
+    impl_->cv.notify_all();
+    impl_->thread.join();
+}
+
+bool ConfigWatcher::reload(std::string* error) { return impl_->load(error); }
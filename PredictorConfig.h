@@ -0,0 +1,145 @@
+// ===============================
+// File: PredictorConfig.h
+// Everything tunable about a Predictor in one value type, a text file format
+// for it, and hot reload:
+//
+//   auto store = std::make_shared<ConfigStore>();
+//   ConfigWatcher watcher(store, "stockpredict.conf");
+//   watcher.start();
+//   predictor.setConfigStore(store);   // copies made afterwards share it
+//
+// A reload publishes a new immutable snapshot (shared_ptr<const>) and bumps a
+// version counter. Predictors check the counter (one atomic load) at the start
+// of each predict* call and copy the new values into themselves only when it
+// moved, so a running prediction never sees a half-applied config and the
+// reloading thread never waits on predictors (or they on it).
+//
+// File: "key = value" lines, '#' comments, unknown keys are errors:
+//   trend = 1.6           momentum = 0.35      reversal = 1.2     sr = 0.6
+//   indicators = 0        # Indicators.h score term, 0 = off
+//   threshold = 60
+//   calib.scale = 2.5  calib.bias = 0     # pBull = sigmoid(score / scale + bias)
+//   tf.5 = 1.1, 1.15, 1.10, 1.00          # trend, momentum, reversal, sr multipliers
+//   theme = tradingview                   # registered theme (ExtractKernels.h), then:
+//   bull = 40,220,140   bear = 220,60,220   tolerance = 45
+//   vol_up = 0,200,120  vol_down = 200,60,60  vol_tolerance = 70
+//   layout = fixed                        # or auto: detect panels + candle colours per chart
+//   series = columns                      # or candles: one OHLC point per candle (CandleSegment.h)
+//   cut.top = 0.10  cut.bottom = 0.25  cut.left = 0.03  cut.right = 0.02
+//   cut.volume_top = 0.74  cut.volume_bottom = 0.89
+//   gate.neutral_score = 2.0  gate.min_rr = 1.0  gate.buy_rr = 1.2  gate.strong_rr = 1.8
+//   gate.buy_confidence = 65  gate.strong_confidence = 80
+//   gate.near_barrier = 0.015  gate.close_barrier = 0.030
+// (one key per line in the file). Keys left out keep their defaults.
+// ===============================
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ChartLayout.h"
+
+struct TimeframeMultipliers {
+    int minutes = 0;
+    double trend = 1.0, momentum = 1.0, reversal = 1.0, sr = 1.0;
+};
+
+// Signal gating. Scores with |adjusted| < neutralScore are Neutral; a trade
+// needs R:R >= minRR, BUY/SELL from buyRR, STRONG_* from strongRR at
+// strongConfidence (BUY/SELL there from buyConfidence). Confidence is cut to
+// x0.65 / x0.80 when price sits within nearBarrier / closeBarrier of the S/R
+// level in the way.
+struct SignalGates {
+    double neutralScore = 2.0;
+    double minRR = 1.0;
+    double buyRR = 1.2;
+    double strongRR = 1.8;
+    double buyConfidence = 65.0;
+    double strongConfidence = 80.0;
+    double nearBarrier = 0.015;
+    double closeBarrier = 0.030;
+};
+
+// Score -> probability: pBull = sigmoid(adjusted / scale + bias). The weight
+// fitter (WeightFit.h) sets both; the hand-picked default is /2.5, no bias.
+struct ScoreCalibration {
+    double scale = 2.5;
+    double bias = 0.0;
+};
+
+struct PredictorConfig {
+    double trend = 1.6, momentum = 0.35, reversal = 1.2, sr = 0.6;
+    double indicators = 0.0;
+    double confidenceThreshold = 60.0;
+    std::vector<TimeframeMultipliers> timeframes = {
+        {1, 1.0, 1.35, 1.10, 0.80},
+        {5, 1.1, 1.15, 1.10, 1.00},
+        {30, 1.35, 0.85, 1.00, 1.35},
+    };
+
+    RGB bull{40, 220, 140}, bear{220, 60, 220};
+    int tolerance = 45;
+    RGB volUp{0, 200, 120}, volDown{200, 60, 60};
+    int volTolerance = 70;
+
+    // Fixed by default: the cuts below fit the bundled screenshots exactly and
+    // cost nothing. Auto (ChartLayout.h) is for captures from other layouts;
+    // detection runs once per layout and falls back to the cuts.
+    bool autoLayout = false;
+    // Columns by default: one close per plot column, what the weights were
+    // tuned on. Candles only pays off with the candle colours right (auto
+    // layout, or bull/bear set for the chart); charts that do not segment
+    // fall back to columns either way.
+    bool candleSegmentation = false;
+    LayoutCuts cuts;
+    SignalGates gates;
+    ScoreCalibration calibration;
+};
+
+// false + *error (with the line number) on a bad file; out is only written on success.
+bool parsePredictorConfig(const std::string& text, PredictorConfig& out, std::string* error = nullptr);
+bool loadPredictorConfig(const std::string& path, PredictorConfig& out, std::string* error = nullptr);
+std::string formatPredictorConfig(const PredictorConfig& cfg);
+bool savePredictorConfig(const std::string& path, const PredictorConfig& cfg, std::string* error = nullptr);
+
+// The current snapshot. Readers never lock anything they could wait on for
+// long: version() is one atomic load, current() an atomic shared_ptr load.
+class ConfigStore {
+public:
+    explicit ConfigStore(PredictorConfig initial = {});
+
+    std::shared_ptr<const PredictorConfig> current() const;
+    uint64_t version() const { return version_.load(std::memory_order_acquire); }
+    void publish(PredictorConfig cfg);
+
+private:
+    std::shared_ptr<const PredictorConfig> cfg_;   // std::atomic_load / atomic_store only
+    std::atomic<uint64_t> version_{1};
+};
+
+// Polls the file's mtime/size and publishes it to the store when it changes.
+// A file that fails to parse (or is caught half-written) keeps the previous
+// snapshot; the next change is tried again.
+class ConfigWatcher {
+public:
+    // Called from the watcher thread (and from start()/reload()).
+    using Callback = std::function<void(bool ok, const std::string& message)>;
+
+    ConfigWatcher(std::shared_ptr<ConfigStore> store, std::string path, int pollMs = 500, Callback cb = {});
+    ~ConfigWatcher();
+
+    ConfigWatcher(const ConfigWatcher&) = delete;
+    ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+    // Loads the file once (fails if it does not parse), then starts polling.
+    bool start(std::string* error = nullptr);
+    void stop();
+    bool reload(std::string* error = nullptr);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
@@ -0,0 +1,52 @@
+// ===============================
+// File: SeriesView.h
+// Non-owning float32 views of price/volume series (normalized 0..1, oldest
+// first), the series counterpart of ImageView. Everything after extraction
+// reads through these, so no stage copies a series or widens it to double:
+// a std::vector<float>, a slice of one or someone else's buffer all work.
+// The caller keeps the memory alive for the duration of the call.
+// ===============================
+#pragma once
+#include <cstddef>
+#include <vector>
+
+struct SeriesSpan {
+    SeriesSpan() = default;
+    SeriesSpan(const float* data, std::size_t size) : data_(data), size_(size) {}
+    // implicit, so every std::vector<float> caller keeps working
+    SeriesSpan(const std::vector<float>& v) : data_(v.data()), size_(v.size()) {}
+
+    const float* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const float& operator[](std::size_t i) const { return data_[i]; }
+    const float& back() const { return data_[size_ - 1]; }
+    const float* begin() const { return data_; }
+    const float* end() const { return data_ + size_; }
+
+    // [first, first + count), clipped to the span
+    SeriesSpan sub(std::size_t first, std::size_t count) const {
+        if (first > size_) first = size_;
+        if (count > size_ - first) count = size_ - first;
+        return SeriesSpan(data_ + first, count);
+    }
+
+private:
+    const float* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+// Close and volume side by side; vol is empty when there is none. high/low
+// only come with per-candle series (CandleSegment.h, OHLCV bars).
+struct SeriesView {
+    SeriesSpan close, vol;
+    SeriesSpan high{}, low{};
+};
+
+// Owning storage for a SeriesView that keeps its capacity between uses.
+struct SeriesBuffer {
+    std::vector<float> close, vol;
+
+    SeriesView view() const { return {close, vol}; }
+};
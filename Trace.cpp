@@ -0,0 +1,172 @@
+// ===============================
+// File: Trace.cpp
+// ===============================
+#include "Trace.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace trace {
+
+namespace {
+
+struct Event {
+    const char* name = nullptr;
+    uint64_t beginNs = 0;
+    uint64_t endNs = 0;
+};
+
+// One ring per thread. Only the owning thread writes; head is published with
+// release so a dump sees fully written slots.
+struct ThreadBuffer {
+    explicit ThreadBuffer(std::size_t capacity, int tidIn)
+        : events(capacity), mask(capacity - 1), tid(tidIn) {}
+
+    std::vector<Event> events;
+    std::size_t mask;
+    std::atomic<uint64_t> head{0};
+    int tid;
+    std::string name;
+};
+
+struct Registry {
+    std::mutex mu;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::size_t capacity = 1u << 16;
+    int nextTid = 1;
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+const std::chrono::steady_clock::time_point& epoch() {
+    static const auto t0 = std::chrono::steady_clock::now();
+    return t0;
+}
+
+std::size_t roundUpPow2(std::size_t n) {
+    std::size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+// Buffers are owned by the registry so events survive thread exit.
+ThreadBuffer& localBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buf;
+    if (!buf) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mu);
+        buf = std::make_shared<ThreadBuffer>(r.capacity, r.nextTid++);
+        r.buffers.push_back(buf);
+    }
+    return *buf;
+}
+
+void writeEscaped(std::ostream& os, const std::string& s) {
+    for (char c : s) {
+        if (c == '"' || c == '\\') os << '\\' << c;
+        else if ((unsigned char)c < 0x20) os << ' ';
+        else os << c;
+    }
+}
+
+} // namespace
+
+namespace detail {
+
+std::atomic<bool> g_enabled{false};
+
+uint64_t nowNs() {
+    auto d = std::chrono::steady_clock::now() - epoch();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+}
+
+void record(const char* name, uint64_t beginNs, uint64_t endNs) {
+    ThreadBuffer& b = localBuffer();
+    uint64_t h = b.head.load(std::memory_order_relaxed);
+    Event& e = b.events[h & b.mask];
+    e.name = name;
+    e.beginNs = beginNs;
+    e.endNs = endNs;
+    b.head.store(h + 1, std::memory_order_release);
+}
+
+} // namespace detail
+
+void enable(std::size_t eventsPerThread) {
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mu);
+        r.capacity = roundUpPow2(eventsPerThread < 16 ? 16 : eventsPerThread);
+    }
+    (void)epoch();
+    detail::g_enabled.store(true, std::memory_order_relaxed);
+}
+
+void disable() {
+    detail::g_enabled.store(false, std::memory_order_relaxed);
+}
+
+void clear() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mu);
+    for (auto& b : r.buffers) b->head.store(0, std::memory_order_relaxed);
+}
+
+void setThreadName(const std::string& name) {
+    ThreadBuffer& b = localBuffer();
+    std::lock_guard<std::mutex> lock(registry().mu);
+    b.name = name;
+}
+
+bool writeChromeJson(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) return false;
+
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mu);
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first = true;
+    char num[64];
+
+    for (const auto& b : r.buffers) {
+        if (!b->name.empty()) {
+            if (!first) out << ",\n";
+            first = false;
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << b->tid
+                << ",\"args\":{\"name\":\"";
+            writeEscaped(out, b->name);
+            out << "\"}}";
+        }
+
+        const uint64_t h = b->head.load(std::memory_order_acquire);
+        const uint64_t cap = (uint64_t)b->events.size();
+        const uint64_t n = (h < cap) ? h : cap;
+
+        for (uint64_t i = h - n; i < h; i++) {
+            const Event& e = b->events[i & b->mask];
+            if (!e.name) continue;
+            if (!first) out << ",\n";
+            first = false;
+
+            // ts/dur are microseconds; keep ns precision as decimals
+            out << "{\"name\":\"";
+            writeEscaped(out, e.name);
+            std::snprintf(num, sizeof(num), "%.3f", (double)e.beginNs / 1000.0);
+            out << "\",\"cat\":\"predictor\",\"ph\":\"X\",\"ts\":" << num;
+            std::snprintf(num, sizeof(num), "%.3f", (double)(e.endNs - e.beginNs) / 1000.0);
+            out << ",\"dur\":" << num << ",\"pid\":1,\"tid\":" << b->tid << "}";
+        }
+    }
+
+    out << "\n]}\n";
+    return (bool)out;
+}
+
+} // namespace trace
@@ -0,0 +1,63 @@
+// ===============================
+// File: Trace.h
+// Opt-in Chrome/Perfetto trace export.
+//   trace::enable();                 // or set STOCKPREDICT_TRACE=out.json for the GUI
+//   { TRACE_SCOPE("extractCloseSeries"); ... }
+//   trace::writeChromeJson("out.json");  // open in ui.perfetto.dev / chrome://tracing
+//
+// Each thread records into its own fixed-size ring buffer (no locks, no allocation
+// after the first event on that thread). When tracing is off a scope costs one
+// relaxed atomic load.
+// ===============================
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace trace {
+
+namespace detail {
+extern std::atomic<bool> g_enabled;
+uint64_t nowNs();
+void record(const char* name, uint64_t beginNs, uint64_t endNs);
+}
+
+// Start recording. eventsPerThread is rounded up to a power of two; once a
+// thread's ring is full the oldest events are overwritten.
+void enable(std::size_t eventsPerThread = 1u << 16);
+void disable();
+inline bool enabled() { return detail::g_enabled.load(std::memory_order_relaxed); }
+
+// Drop everything recorded so far (buffers stay allocated).
+void clear();
+
+// Optional label shown for the calling thread in the trace viewer.
+void setThreadName(const std::string& name);
+
+// Write all recorded events as Chrome trace-event JSON.
+// Call once traced work has quiesced; rings are read without stopping writers.
+bool writeChromeJson(const std::string& path);
+
+// RAII begin/end pair. `name` must outlive the trace (use string literals).
+class Scope {
+public:
+    explicit Scope(const char* name)
+        : name_(enabled() ? name : nullptr),
+          beginNs_(name_ ? detail::nowNs() : 0) {}
+    ~Scope() {
+        if (name_) detail::record(name_, beginNs_, detail::nowNs());
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* name_;
+    uint64_t beginNs_;
+};
+
+} // namespace trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) ::trace::Scope TRACE_CONCAT(traceScope_, __LINE__)(name)
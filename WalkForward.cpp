@@ -0,0 +1,356 @@
+// ===============================
+// File: WalkForward.cpp
+// ===============================
+#include "WalkForward.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "ImageDecode.h"
+#include "Trace.h"
+#include "WorkStealingPool.h"
+
+namespace {
+
+double msSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+std::vector<std::string> splitCsv(const std::string& line) {
+    std::vector<std::string> out;
+    std::stringstream ss(line);
+    std::string cell;
+    while (std::getline(ss, cell, ',')) {
+        while (!cell.empty() && (cell.back() == '\r' || cell.back() == ' ')) cell.pop_back();
+        while (!cell.empty() && cell.front() == ' ') cell.erase(cell.begin());
+        out.push_back(cell);
+    }
+    return out;
+}
+
+bool parseNumber(const std::string& s, double& out) {
+    if (s.empty()) return false;
+    char* end = nullptr;
+    out = std::strtod(s.c_str(), &end);
+    return end && *end == '\0';
+}
+
+struct Tally {
+    int trades = 0;
+    int wins = 0;
+    double pnl = 0.0;
+};
+
+// percent of entry, signed by the trade direction; 0 for NEUTRAL
+double tradePnl(const Prediction& p, const WalkSample& s) {
+    if (p.signal == "NEUTRAL" || s.entryPrice <= 0.0) return 0.0;
+    const bool isLong = (p.signal == "BUY" || p.signal == "STRONG_BUY");
+    const double ret = 100.0 * (s.exitPrice - s.entryPrice) / s.entryPrice;
+    return isLong ? ret : -ret;
+}
+
+void addTally(Tally& t, const Prediction& p, const WalkSample& s) {
+    if (p.signal == "NEUTRAL") return;
+    const double pnl = tradePnl(p, s);
+    t.trades++;
+    if (pnl > 0.0) t.wins++;
+    t.pnl += pnl;
+}
+
+std::map<std::string, double> tallyMetrics(const Tally& t) {
+    std::map<std::string, double> m;
+    m["trades"] = (double)t.trades;
+    m["win_rate"] = t.trades > 0 ? 100.0 * t.wins / t.trades : 0.0;
+    m["pnl"] = t.pnl;
+    m["avg_pnl"] = t.trades > 0 ? t.pnl / t.trades : 0.0;
+    return m;
+}
+
+// Same numbers Predictor::performanceMetrics gives for these results, plus pnl.
+std::map<std::string, double> resultMetrics(const std::vector<BacktestResult>& results) {
+    Predictor book;
+    double pnl = 0.0;
+    for (const BacktestResult& r : results) {
+        book.addBacktestResult(r);
+        if (r.prediction.signal != "NEUTRAL") pnl += r.pnl;
+    }
+    std::map<std::string, double> m = book.performanceMetrics();
+    m["pnl"] = pnl;
+    m["avg_pnl"] = m["trades"] > 0 ? pnl / m["trades"] : 0.0;
+    return m;
+}
+
+bool better(const Tally& a, const Tally& b) {
+    if (a.pnl != b.pnl) return a.pnl > b.pnl;
+    return a.wins * (b.trades ? b.trades : 1) > b.wins * (a.trades ? a.trades : 1);
+}
+
+} // namespace
+
+bool loadOhlcvCsv(const std::string& path, std::vector<OhlcvBar>& out, std::string* error) {
+    std::ifstream in(path);
+    if (!in) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    out.clear();
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        lineNo++;
+        if (line.empty() || line[0] == '#') continue;
+        const std::vector<std::string> c = splitCsv(line);
+        OhlcvBar b;
+        if (c.size() < 5 || !parseNumber(c[1], b.open) || !parseNumber(c[2], b.high) ||
+            !parseNumber(c[3], b.low) || !parseNumber(c[4], b.close)) {
+            if (out.empty()) continue;   // header
+            if (error) *error = path + ":" + std::to_string(lineNo) + ": expected time,open,high,low,close[,volume]";
+            return false;
+        }
+        if (c.size() > 5) parseNumber(c[5], b.volume);
+        b.time = c[0];
+        out.push_back(std::move(b));
+    }
+    if (out.empty()) {
+        if (error) *error = "no bars in " + path;
+        return false;
+    }
+    return true;
+}
+
+void barsToSeries(const std::vector<OhlcvBar>& bars, std::size_t begin, std::size_t end,
+                  std::vector<float>& close01, std::vector<float>& vol01, double* lo, double* hi) {
+    close01.clear();
+    vol01.clear();
+    if (begin >= end || end > bars.size()) return;
+    double low = bars[begin].low, high = bars[begin].high, vmax = 0.0;
+    for (std::size_t i = begin; i < end; i++) {
+        low = std::min(low, bars[i].low);
+        high = std::max(high, bars[i].high);
+        vmax = std::max(vmax, bars[i].volume);
+    }
+    const double range = high > low ? high - low : 1.0;
+    close01.reserve(end - begin);
+    for (std::size_t i = begin; i < end; i++) close01.push_back((float)((bars[i].close - low) / range));
+    if (vmax > 0.0) {
+        vol01.reserve(end - begin);
+        for (std::size_t i = begin; i < end; i++) vol01.push_back((float)(bars[i].volume / vmax));
+    }
+    if (lo) *lo = low;
+    if (hi) *hi = high > low ? high : low + 1.0;
+}
+
+Prediction predictMultiTimeframeBars(Predictor& predictor, const std::vector<OhlcvBar>& bars1m,
+                                     const std::string& timeStr, int lookback) {
+    TRACE_SCOPE("predictMultiTimeframeBars");
+    lookback = std::max(2, lookback);
+    std::vector<float> close, vol;
+    Prediction views[3];
+    const int tfs[3] = {1, 5, 30};
+    for (int k = 0; k < 3; k++) {
+        const std::vector<OhlcvBar> bars = resampleBars(bars1m, tfs[k]);
+        const std::size_t begin = bars.size() > (std::size_t)lookback ? bars.size() - lookback : 0;
+        double lo = 0.0, hi = 0.0;
+        barsToSeries(bars, begin, bars.size(), close, vol, &lo, &hi);
+        const std::string t = timeStr.empty() && !bars1m.empty() ? hhmmFrom(bars1m.back().time) : timeStr;
+        views[k] = predictor.predictSeries(close, vol, t, tfs[k], !close.empty(), lo, hi);
+    }
+    return predictor.fuseTimeframes(views[0], views[1], views[2]);
+}
+
+void sampleFromBars(const std::vector<OhlcvBar>& bars, std::size_t t, int lookback, int horizon, WalkSample& s) {
+    lookback = std::max(2, lookback);
+    horizon = std::max(1, horizon);
+    s.timestamp = bars[t].time;
+    s.timeStr = hhmmFrom(bars[t].time);
+    s.imagePath.clear();
+    barsToSeries(bars, t + 1 - lookback, t + 1, s.close01, s.vol01);
+    s.entryPrice = bars[t].close;
+    s.exitPrice = bars[t + horizon].close;
+    s.barsHeld = horizon;
+}
+
+std::vector<WalkSample> samplesFromBars(const std::vector<OhlcvBar>& bars, int lookback, int horizon, int step) {
+    std::vector<WalkSample> out;
+    lookback = std::max(2, lookback);
+    horizon = std::max(1, horizon);
+    step = std::max(1, step);
+    for (std::size_t t = (std::size_t)lookback - 1; t + horizon < bars.size(); t += step) {
+        WalkSample s;
+        sampleFromBars(bars, t, lookback, horizon, s);
+        out.push_back(std::move(s));
+    }
+    return out;
+}
+
+bool loadChartSamples(const std::string& listPath, std::vector<WalkSample>& out, std::string* error) {
+    namespace fs = std::filesystem;
+    std::ifstream in(listPath);
+    if (!in) {
+        if (error) *error = "cannot open " + listPath;
+        return false;
+    }
+    const fs::path base = fs::path(listPath).parent_path();
+    out.clear();
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        lineNo++;
+        if (line.empty() || line[0] == '#') continue;
+        const std::vector<std::string> c = splitCsv(line);
+        WalkSample s;
+        double tf = -1.0;
+        if (c.size() < 5 || !parseNumber(c[2], tf) || !parseNumber(c[3], s.entryPrice) ||
+            !parseNumber(c[4], s.exitPrice)) {
+            if (out.empty()) continue;   // header
+            if (error) *error = listPath + ":" + std::to_string(lineNo) +
+                                ": expected timestamp,imagePath,tfMinutes,entryPrice,exitPrice";
+            return false;
+        }
+        s.timestamp = c[0];
+        s.timeStr = hhmmFrom(c[0]);
+        fs::path img(c[1]);
+        s.imagePath = img.is_absolute() ? img.string() : (base / img).string();
+        s.tfMinutes = (int)tf;
+        out.push_back(std::move(s));
+    }
+    if (out.empty()) {
+        if (error) *error = "no samples in " + listPath;
+        return false;
+    }
+    return true;
+}
+
+bool extractSampleFeatures(const Predictor& predictor, const WalkSample& s, Predictor::Features& out) {
+    if (!s.imagePath.empty()) {
+        thread_local PixelBuffer pixels;
+        thread_local std::vector<float> close, vol;
+        if (!decodeImageFile(s.imagePath, pixels, nullptr)) return false;
+        predictor.extractSeries(pixels.view(), close, vol);
+        predictor.extractFeatures(close, vol, out);
+        return true;
+    }
+    if (s.close01.size() < 2) return false;
+    predictor.extractFeatures(s.close01, s.vol01, out);
+    return true;
+}
+
+std::vector<WalkParams> defaultWalkGrid() {
+    std::vector<WalkParams> grid;
+    for (double t : {1.0, 1.6, 2.2})
+        for (double m : {0.2, 0.35, 0.6})
+            for (double r : {0.8, 1.2})
+                for (double sr : {0.4, 0.6, 0.9})
+                    for (double th : {55.0, 60.0, 65.0}) grid.push_back({t, m, r, sr, th});
+    return grid;
+}
+
+WalkForwardReport runWalkForward(const Predictor& prototype, const std::vector<WalkSample>& samples,
+                                 const WalkForwardOptions& opt) {
+    TRACE_SCOPE("runWalkForward");
+    WalkForwardReport report;
+    report.samples = samples.size();
+    const std::size_t n = samples.size();
+    const std::size_t trainN = (std::size_t)std::max(1, opt.trainSamples);
+    const std::size_t testN = (std::size_t)std::max(1, opt.testSamples);
+    const std::size_t stepN = opt.stepSamples > 0 ? (std::size_t)opt.stepSamples : testN;
+
+    WorkStealingPool pool(opt.threads);
+
+    // 1) features once per sample (decode + extract for charts)
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<Predictor::Features> features(n);
+    std::vector<char> valid(n, 0);
+    pool.forEach(n, [&](std::size_t i) { valid[i] = extractSampleFeatures(prototype, samples[i], features[i]); });
+    report.extractMs = msSince(t0);
+    for (char v : valid) report.failed += v ? 0 : 1;
+
+    // 2) windows
+    for (std::size_t start = 0; start + trainN < n; start += stepN) {
+        WalkWindow w;
+        w.trainBegin = start;
+        w.trainEnd = start + trainN;
+        w.testBegin = w.trainEnd;
+        w.testEnd = std::min(n, w.testBegin + testN);
+        report.windows.push_back(w);
+    }
+    // step < test: windows would test the same samples twice; each one is
+    // scored by the newest window trained before it instead
+    for (std::size_t wi = 0; wi + 1 < report.windows.size(); wi++) {
+        WalkWindow& w = report.windows[wi];
+        w.testEnd = std::min(w.testEnd, report.windows[wi + 1].testBegin);
+    }
+
+    const std::vector<WalkParams> grid = opt.grid.empty() ? defaultWalkGrid() : opt.grid;
+    // only signals are tallied and saved: skip the level/pattern copies
+    Predictor scorer = prototype;
+    scorer.setOutputs(kPredictSignal);
+    std::vector<Predictor> candidates(grid.size(), scorer);
+    for (std::size_t c = 0; c < grid.size(); c++) {
+        candidates[c].setWeights(grid[c].trend, grid[c].momentum, grid[c].reversal, grid[c].sr);
+        candidates[c].setConfidenceThreshold(grid[c].threshold);
+    }
+    Predictor fallback = scorer;
+    {
+        const WalkParams d;
+        fallback.setWeights(d.trend, d.momentum, d.reversal, d.sr);
+        fallback.setConfidenceThreshold(d.threshold);
+    }
+
+    auto tfOf = [&](const WalkSample& s) { return s.tfMinutes > 0 ? s.tfMinutes : opt.tfMinutes; };
+
+    t0 = std::chrono::steady_clock::now();
+    std::vector<std::vector<BacktestResult>> windowTrades(report.windows.size());
+    pool.forEach(report.windows.size(), [&](std::size_t wi) {
+        WalkWindow& w = report.windows[wi];
+
+        std::size_t best = grid.size();
+        Tally bestTally;
+        for (std::size_t c = 0; c < grid.size(); c++) {
+            Tally t;
+            for (std::size_t i = w.trainBegin; i < w.trainEnd; i++) {
+                if (!valid[i]) continue;
+                const WalkSample& s = samples[i];
+                addTally(t, candidates[c].predictFeatures(features[i], s.timeStr, tfOf(s)), s);
+            }
+            if (t.trades < opt.minTrades) continue;
+            if (best == grid.size() || better(t, bestTally)) {
+                best = c;
+                bestTally = t;
+            }
+        }
+        w.tuned = best < grid.size();
+        w.params = w.tuned ? grid[best] : WalkParams{};
+        w.train = tallyMetrics(bestTally);
+        const Predictor& chosen = w.tuned ? candidates[best] : fallback;
+
+        std::vector<BacktestResult>& out = windowTrades[wi];
+        for (std::size_t i = w.testBegin; i < w.testEnd; i++) {
+            if (!valid[i]) continue;
+            const WalkSample& s = samples[i];
+            BacktestResult r;
+            r.timestamp = s.timestamp;
+            r.imagePath = s.imagePath;
+            r.timeframeMinutes = tfOf(s);
+            r.prediction = chosen.predictFeatures(features[i], s.timeStr, r.timeframeMinutes);
+            r.entryPrice = s.entryPrice;
+            r.exitPrice = s.exitPrice;
+            r.pnl = tradePnl(r.prediction, s);
+            r.wasCorrect = r.pnl > 0.0;
+            r.barsHeld = s.barsHeld;
+            out.push_back(std::move(r));
+        }
+        w.test = resultMetrics(out);
+    });
+    report.tuneMs = msSince(t0);
+
+    for (auto& wt : windowTrades) {
+        for (auto& r : wt) report.trades.push_back(std::move(r));
+    }
+    report.aggregate = resultMetrics(report.trades);
+    return report;
+}
@@ -0,0 +1,112 @@
+// ===============================
+// File: WalkForward.h
+// Walk-forward validation: tune weights/threshold on a rolling train window,
+// score the test window right after it with what won, slide, repeat. Only
+// the test windows count, so the numbers are out-of-sample.
+//
+// Corpus is a list of samples in time order, either
+//   - OHLCV bars (samplesFromBars): each sample is the last `lookback` bars as
+//     a normalized close series, outcome = close `horizon` bars later, or
+//   - chart screenshots (loadChartSamples): image + entry/exit price.
+// Features (Predictor::extractFeatures) are computed once per sample and shared
+// by every window and every candidate, so the run is ~linear in corpus size.
+// Both the extraction pass and the windows run on a WorkStealingPool.
+// ===============================
+#pragma once
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "OhlcvBars.h"
+#include "Predictor.h"
+
+// time,open,high,low,close[,volume]; a header line is skipped.
+bool loadOhlcvCsv(const std::string& path, std::vector<OhlcvBar>& out, std::string* error = nullptr);
+
+// bars[begin, end) the way a chart of them reads: closes scaled by the range's
+// low..high, volume by its max (vol01 stays empty without volume). lo/hi get
+// the price range for predictSeries' hasScale.
+void barsToSeries(const std::vector<OhlcvBar>& bars, std::size_t begin, std::size_t end,
+                  std::vector<float>& close01, std::vector<float>& vol01, double* lo = nullptr,
+                  double* hi = nullptr);
+
+// predictMultiTimeframe from one 1m bar stream: resampled to 5m and 30m, the
+// last `lookback` bars of each view scored with its TF weights (plan in
+// prices), then Predictor::fuseTimeframes. timeStr "" = the last bar's HH:MM.
+Prediction predictMultiTimeframeBars(Predictor& predictor, const std::vector<OhlcvBar>& bars1m,
+                                     const std::string& timeStr = "", int lookback = 120);
+
+struct WalkSample {
+    std::string timestamp;
+    std::string timeStr;                 // "HH:MM" for the session multipliers; "" = none
+    std::string imagePath;               // chart corpus: decoded + extracted during the run
+    std::vector<float> close01, vol01;   // bar corpus: the series itself
+    int tfMinutes = -1;                  // <= 0: WalkForwardOptions::tfMinutes
+    double entryPrice = 0.0;
+    double exitPrice = 0.0;
+    int barsHeld = 0;
+};
+
+// One sample per `step` bars. Closes are scaled by the window's low..high (what
+// the y axis of a chart of those bars would show), volume by its max.
+std::vector<WalkSample> samplesFromBars(const std::vector<OhlcvBar>& bars, int lookback, int horizon,
+                                        int step = 1);
+// The sample samplesFromBars makes for bar t (the last bar of the lookback,
+// t + horizon < bars.size()), into out so its buffers are reused.
+void sampleFromBars(const std::vector<OhlcvBar>& bars, std::size_t t, int lookback, int horizon, WalkSample& out);
+
+// CSV: timestamp,imagePath,tfMinutes,entryPrice,exitPrice (header skipped;
+// relative image paths are taken relative to the list file).
+bool loadChartSamples(const std::string& listPath, std::vector<WalkSample>& out,
+                      std::string* error = nullptr);
+
+// Predictor::extractFeatures for one sample, decoding its chart if it has one;
+// false when the chart cannot be read or the series is too short.
+bool extractSampleFeatures(const Predictor& predictor, const WalkSample& s, Predictor::Features& out);
+
+struct WalkParams {
+    double trend = 1.6;
+    double momentum = 0.35;
+    double reversal = 1.2;
+    double sr = 0.6;
+    double threshold = 60.0;
+};
+
+// 162 candidates around the shipped defaults.
+std::vector<WalkParams> defaultWalkGrid();
+
+struct WalkForwardOptions {
+    int trainSamples = 250;
+    int testSamples = 50;
+    int stepSamples = 0;              // 0 = testSamples (test windows tile the corpus); below testSamples,
+                                      // a window's test stops where the next one's starts (no sample twice)
+    int tfMinutes = -1;
+    int threads = 0;                  // 0 = hardware_concurrency
+    int minTrades = 5;                // candidates with fewer trades on train are not picked
+    std::vector<WalkParams> grid;     // empty = defaultWalkGrid()
+};
+
+struct WalkWindow {
+    std::size_t trainBegin = 0, trainEnd = 0;   // sample indices, end exclusive
+    std::size_t testBegin = 0, testEnd = 0;
+    WalkParams params;
+    bool tuned = false;                         // false: no candidate had minTrades, defaults used
+    std::map<std::string, double> train;        // the chosen candidate on its train window
+    std::map<std::string, double> test;
+};
+
+// Metric maps have Predictor::performanceMetrics' keys (trades, win_rate)
+// plus pnl / avg_pnl (percent of entry, summed over trades).
+struct WalkForwardReport {
+    std::vector<WalkWindow> windows;
+    std::map<std::string, double> aggregate;    // all test windows together
+    std::vector<BacktestResult> trades;         // every test-window prediction, in order
+    std::size_t samples = 0;
+    std::size_t failed = 0;                     // samples whose chart could not be read
+    double extractMs = 0.0;
+    double tuneMs = 0.0;
+};
+
+WalkForwardReport runWalkForward(const Predictor& prototype, const std::vector<WalkSample>& samples,
+                                 const WalkForwardOptions& opt);
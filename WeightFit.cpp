@@ -0,0 +1,305 @@
+// ===============================
+// File: WeightFit.cpp
+// ===============================
+#include "WeightFit.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#include "Trace.h"
+#include "WorkStealingPool.h"
+
+namespace {
+
+double msSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+bool fitsIndicators(const Predictor& prototype, const WeightFitOptions& opt) {
+    return opt.indicators || prototype.indicatorWeight() != 0.0;
+}
+
+// sampleAt(i, buffer) -> const WalkSample&
+template <class SampleAt>
+void build(const Predictor& prototype, std::size_t n, const SampleAt& sampleAt, const WeightFitOptions& opt,
+           WeightFitData& out) {
+    TRACE_SCOPE("buildWeightFitData");
+    const auto t0 = std::chrono::steady_clock::now();
+    // the indicator pass only runs at a non-zero weight; its value is not used here
+    Predictor extractor = prototype;
+    if (fitsIndicators(prototype, opt) && extractor.indicatorWeight() == 0.0) extractor.setIndicatorWeight(1.0);
+
+    for (std::vector<float>& col : out.terms) col.assign(n, 0.f);
+    out.label.assign(n, -1.f);   // -1: no row
+    {
+        WorkStealingPool pool(opt.threads);
+        pool.forEach(n, [&](std::size_t i) {
+            thread_local WalkSample buffer;
+            thread_local Predictor::Features f;
+            const WalkSample& s = sampleAt(i, buffer);
+            if (s.exitPrice == s.entryPrice || !extractSampleFeatures(extractor, s, f)) return;
+            double t[kScoreTerms];
+            extractor.scoreTerms(f.breakdown, s.timeStr, s.tfMinutes > 0 ? s.tfMinutes : opt.tfMinutes, t);
+            for (int k = 0; k < kScoreTerms; k++) out.terms[k][i] = (float)t[k];
+            out.label[i] = s.exitPrice > s.entryPrice ? 1.f : 0.f;
+        });
+    }
+
+    // drop the skipped rows, order kept
+    std::size_t rows = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        if (out.label[i] < 0.f) continue;
+        for (std::vector<float>& col : out.terms) col[rows] = col[i];
+        out.label[rows++] = out.label[i];
+    }
+    for (std::vector<float>& col : out.terms) col.resize(rows);
+    out.label.resize(rows);
+    out.skipped = n - rows;
+    out.extractMs = msSince(t0);
+}
+
+constexpr int kMaxParams = kScoreTerms + 1;   // + bias
+constexpr std::size_t kChunkRows = 1 << 14;   // rows per task
+constexpr std::size_t kBlockRows = 256;       // rows per column-wise block
+
+// Log loss, gradient and Hessian sums of one chunk (not yet divided by rows).
+struct PassSums {
+    double loss = 0.0;
+    std::size_t correct = 0;
+    double g[kMaxParams] = {};
+    double h[kMaxParams][kMaxParams] = {};   // lower triangle
+};
+
+// Reductions in eight independent lanes the compiler can keep in vector
+// registers (a single running float sum has to stay in order).
+float dot(const float* a, const float* b, std::size_t m) {
+    float acc[8] = {};
+    std::size_t i = 0;
+    for (; i + 8 <= m; i += 8)
+        for (int l = 0; l < 8; l++) acc[l] += a[i + l] * b[i + l];
+    float total = 0.f;
+    for (float v : acc) total += v;
+    for (; i < m; i++) total += a[i] * b[i];
+    return total;
+}
+
+float sum(const float* a, std::size_t m) {
+    float acc[8] = {};
+    std::size_t i = 0;
+    for (; i + 8 <= m; i += 8)
+        for (int l = 0; l < 8; l++) acc[l] += a[i + l];
+    float total = 0.f;
+    for (float v : acc) total += v;
+    for (; i < m; i++) total += a[i];
+    return total;
+}
+
+// params: beta over the d used columns, then the bias
+void passChunk(const WeightFitData& data, const int* cols, int d, const double* params, std::size_t r0,
+               std::size_t r1, PassSums& s) {
+    float z[kBlockRows], r[kBlockRows], w[kBlockRows];
+    const float* x[kScoreTerms];
+    for (std::size_t b = r0; b < r1; b += kBlockRows) {
+        const std::size_t m = std::min(kBlockRows, r1 - b);
+        const float* y = data.label.data() + b;
+        for (int j = 0; j < d; j++) x[j] = data.terms[cols[j]].data() + b;
+
+        const float bias = (float)params[d];
+        for (std::size_t i = 0; i < m; i++) z[i] = bias;
+        for (int j = 0; j < d; j++) {
+            const float bj = (float)params[j];
+            const float* xj = x[j];
+            for (std::size_t i = 0; i < m; i++) z[i] += bj * xj[i];
+        }
+
+        double loss = 0.0;
+        for (std::size_t i = 0; i < m; i++) {
+            const float p = 1.f / (1.f + std::exp(-z[i]));
+            r[i] = p - y[i];
+            w[i] = p * (1.f - p);
+            // -log sigmoid(+-z) without overflow
+            loss += std::log1p(std::exp(-std::fabs((double)z[i]))) + std::max((double)z[i], 0.0) - (double)y[i] * z[i];
+            s.correct += (z[i] >= 0.f) == (y[i] > 0.5f);
+        }
+        s.loss += loss;
+
+        float wx[kBlockRows];
+        for (int j = 0; j < d; j++) {
+            const float* xj = x[j];
+            s.g[j] += dot(r, xj, m);
+            for (std::size_t i = 0; i < m; i++) wx[i] = w[i] * xj[i];
+            for (int l = 0; l <= j; l++) s.h[j][l] += dot(wx, x[l], m);
+            s.h[d][j] += sum(wx, m);
+        }
+        const float gb = sum(r, m), hbb = sum(w, m);
+        s.g[d] += gb;
+        s.h[d][d] += hbb;
+    }
+}
+
+PassSums fullPass(WorkStealingPool& pool, const WeightFitData& data, const int* cols, int d, const double* params) {
+    const std::size_t n = data.rows();
+    const std::size_t chunks = (n + kChunkRows - 1) / kChunkRows;
+    std::vector<PassSums> part(chunks);
+    pool.forEach(chunks, [&](std::size_t c) {
+        passChunk(data, cols, d, params, c * kChunkRows, std::min(n, (c + 1) * kChunkRows), part[c]);
+    });
+    PassSums total;
+    for (const PassSums& p : part) {
+        total.loss += p.loss;
+        total.correct += p.correct;
+        for (int j = 0; j <= d; j++) {
+            total.g[j] += p.g[j];
+            for (int l = 0; l <= j; l++) total.h[j][l] += p.h[j][l];
+        }
+    }
+    return total;
+}
+
+// a x = b for a small symmetric positive definite a (Gaussian elimination,
+// partial pivoting); false if singular
+bool solve(double a[kMaxParams][kMaxParams], double* b, int n) {
+    for (int c = 0; c < n; c++) {
+        int piv = c;
+        for (int r = c + 1; r < n; r++)
+            if (std::fabs(a[r][c]) > std::fabs(a[piv][c])) piv = r;
+        if (std::fabs(a[piv][c]) < 1e-300) return false;
+        if (piv != c) {
+            for (int k = 0; k < n; k++) std::swap(a[c][k], a[piv][k]);
+            std::swap(b[c], b[piv]);
+        }
+        for (int r = c + 1; r < n; r++) {
+            const double f = a[r][c] / a[c][c];
+            for (int k = c; k < n; k++) a[r][k] -= f * a[c][k];
+            b[r] -= f * b[c];
+        }
+    }
+    for (int c = n - 1; c >= 0; c--) {
+        for (int k = c + 1; k < n; k++) b[c] -= a[c][k] * b[k];
+        b[c] /= a[c][c];
+    }
+    return true;
+}
+
+} // namespace
+
+void buildWeightFitData(const Predictor& prototype, const std::vector<WalkSample>& samples,
+                        const WeightFitOptions& opt, WeightFitData& out) {
+    build(prototype, samples.size(), [&](std::size_t i, WalkSample&) -> const WalkSample& { return samples[i]; },
+          opt, out);
+}
+
+void buildWeightFitData(const Predictor& prototype, const std::vector<OhlcvBar>& bars, int lookback, int horizon,
+                        int step, const WeightFitOptions& opt, WeightFitData& out) {
+    lookback = std::max(2, lookback);
+    horizon = std::max(1, horizon);
+    step = std::max(1, step);
+    const std::size_t first = (std::size_t)lookback - 1;
+    const std::size_t n =
+        first + (std::size_t)horizon < bars.size() ? (bars.size() - (std::size_t)horizon - first - 1) / step + 1 : 0;
+    build(prototype, n,
+          [&](std::size_t i, WalkSample& buffer) -> const WalkSample& {
+              sampleFromBars(bars, first + i * (std::size_t)step, lookback, horizon, buffer);
+              return buffer;
+          },
+          opt, out);
+}
+
+WeightFitReport fitWeights(const Predictor& prototype, const WeightFitData& data, const WeightFitOptions& opt) {
+    TRACE_SCOPE("fitWeights");
+    const auto t0 = std::chrono::steady_clock::now();
+    WeightFitReport rep;
+    rep.config = prototype.config();
+    rep.fitIndicators = fitsIndicators(prototype, opt);
+    rep.rows = data.rows();
+    if (rep.rows == 0) return rep;
+
+    int cols[kScoreTerms];
+    int d = 0;
+    for (int k = 0; k < kScoreTerms; k++)
+        if (k != kTermIndicators || rep.fitIndicators) cols[d++] = k;
+
+    const PredictorConfig& base = rep.config;
+    const double baseWeights[kScoreTerms] = {base.trend, base.momentum, base.reversal, base.sr, base.indicators};
+    const double rows = (double)rep.rows;
+    WorkStealingPool pool(opt.threads);
+
+    // the prototype as a logistic model, for comparison
+    double params[kMaxParams] = {};
+    for (int j = 0; j < d; j++) params[j] = baseWeights[cols[j]] / base.calibration.scale;
+    params[d] = base.calibration.bias;
+    {
+        const PassSums s = fullPass(pool, data, cols, d, params);
+        rep.baseLogLoss = s.loss / rows;
+        rep.baseAccuracy = 100.0 * (double)s.correct / rows;
+    }
+
+    // Newton from zero; a step that raises the loss is halved and retried
+    std::fill(params, params + kMaxParams, 0.0);
+    double prev[kMaxParams] = {};
+    double prevLoss = std::numeric_limits<double>::infinity();
+    int halvings = 0;
+    for (rep.iterations = 0; rep.iterations < std::max(1, opt.maxIterations); rep.iterations++) {
+        PassSums s = fullPass(pool, data, cols, d, params);
+        double loss = s.loss / rows;
+        for (int j = 0; j < d; j++) loss += 0.5 * opt.l2 * params[j] * params[j];
+        if (loss > prevLoss && halvings < 30) {
+            for (int j = 0; j <= d; j++) params[j] = prev[j] + 0.5 * (params[j] - prev[j]);
+            halvings++;
+            continue;
+        }
+        halvings = 0;
+
+        double h[kMaxParams][kMaxParams], g[kMaxParams];
+        for (int j = 0; j <= d; j++) {
+            g[j] = s.g[j] / rows + (j < d ? opt.l2 * params[j] : 0.0);
+            for (int l = 0; l <= j; l++) h[j][l] = h[l][j] = s.h[j][l] / rows;
+            if (j < d) h[j][j] += opt.l2;
+        }
+        if (!solve(h, g, d + 1)) break;
+
+        double step = 0.0;
+        for (int j = 0; j <= d; j++) {
+            prev[j] = params[j];
+            params[j] -= g[j];
+            step = std::max(step, std::fabs(g[j]));
+        }
+        prevLoss = loss;
+        if (step < opt.tolerance) {
+            rep.converged = true;
+            rep.iterations++;
+            break;
+        }
+    }
+
+    {
+        const PassSums s = fullPass(pool, data, cols, d, params);
+        rep.logLoss = s.loss / rows;
+        rep.accuracy = 100.0 * (double)s.correct / rows;
+    }
+    for (int j = 0; j < d; j++) rep.beta[cols[j]] = params[j];
+    rep.bias = params[d];
+
+    // weight = scale * beta, scale keeping sum |weight| where it was
+    double scale = opt.scale;
+    if (!(scale > 0.0)) {
+        double sumW = 0.0, sumB = 0.0;
+        for (int j = 0; j < d; j++) {
+            sumW += std::fabs(baseWeights[cols[j]]);
+            sumB += std::fabs(params[j]);
+        }
+        scale = sumW > 0.0 && sumB > 1e-12 ? sumW / sumB : base.calibration.scale;
+    }
+    PredictorConfig& cfg = rep.config;
+    cfg.trend = scale * rep.beta[kTermTrend];
+    cfg.momentum = scale * rep.beta[kTermMomentum];
+    cfg.reversal = scale * rep.beta[kTermReversal];
+    cfg.sr = scale * rep.beta[kTermSr];
+    if (rep.fitIndicators) cfg.indicators = scale * rep.beta[kTermIndicators];
+    cfg.calibration.scale = scale;
+    cfg.calibration.bias = rep.bias;
+    rep.fitMs = msSince(t0);
+    return rep;
+}
@@ -0,0 +1,71 @@
+// ===============================
+// File: WeightFit.h
+// Score weights + calibration fitted to labelled history by logistic
+// regression, instead of hand-picked:
+//
+//   P(up) = sigmoid(bias + sum_k beta[k] * terms[k])     terms: Predictor::scoreTerms
+//
+// is what predictFeatures computes with weight[k] = scale * beta[k] and
+// calibration {scale, bias} (up to the +-8 clamp on the score; inside the
+// neutral band pBull is pinned near 0.5 as before). Weights and scale only
+// come as a product, so scale is picked to keep the prototype's sum |weight|:
+// scores keep their size and the neutral gate its meaning.
+// The threshold, gates and timeframe multipliers are left as they are.
+//
+// Features are extracted once per sample on a WorkStealingPool into a dense
+// column-major matrix (one float column per term). Each Newton step (IRLS,
+// L2 on the weights) is one pass over it: fixed chunks of rows per task,
+// blocks inside a chunk processed column by column so the inner loops are
+// plain float multiply-adds, and the chunks' partial sums merged in chunk
+// order, so any thread count gives the same fit. Extraction is what costs;
+// the fit converges in a handful of passes.
+// ===============================
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "Predictor.h"
+#include "PredictorConfig.h"
+#include "WalkForward.h"
+
+struct WeightFitData {
+    std::vector<float> terms[kScoreTerms];   // terms[k][row]
+    std::vector<float> label;                // 1 = price went up, 0 = down
+    std::size_t skipped = 0;                 // flat outcome, unreadable chart or too short
+    double extractMs = 0.0;
+
+    std::size_t rows() const { return label.size(); }
+};
+
+struct WeightFitOptions {
+    int threads = 0;             // 0 = hardware_concurrency
+    int tfMinutes = -1;          // for samples with tfMinutes <= 0
+    bool indicators = false;     // fit the indicator weight too (always when the prototype's is non-zero)
+    double l2 = 1e-3;            // on the weights, not the bias
+    int maxIterations = 50;
+    double tolerance = 1e-6;     // done when no coefficient moves more than this (float sums: ~1e-7 floor)
+    double scale = 0.0;          // > 0: use this calibration scale instead of keeping sum |weight|
+};
+
+struct WeightFitReport {
+    PredictorConfig config;                  // the prototype's, with fitted weights + calibration
+    double beta[kScoreTerms] = {};           // 0 for terms not fitted
+    double bias = 0.0;
+    bool fitIndicators = false;
+    int iterations = 0;
+    bool converged = false;
+    std::size_t rows = 0;
+    double logLoss = 0.0, accuracy = 0.0;           // fitted, on the data (accuracy in percent)
+    double baseLogLoss = 0.0, baseAccuracy = 0.0;   // the prototype's weights + calibration
+    double fitMs = 0.0;
+};
+
+// One row per sample whose price moved (exit != entry).
+void buildWeightFitData(const Predictor& prototype, const std::vector<WalkSample>& samples,
+                        const WeightFitOptions& opt, WeightFitData& out);
+// The samples of samplesFromBars(bars, lookback, horizon, step), each made
+// on the fly instead of all held at once (millions of bars).
+void buildWeightFitData(const Predictor& prototype, const std::vector<OhlcvBar>& bars, int lookback, int horizon,
+                        int step, const WeightFitOptions& opt, WeightFitData& out);
+
+WeightFitReport fitWeights(const Predictor& prototype, const WeightFitData& data, const WeightFitOptions& opt = {});
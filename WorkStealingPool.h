@@ -0,0 +1,134 @@
+// ===============================
+// File: WorkStealingPool.h
+// Fixed pool of threads for "run fn(i) for i in [0, n)" jobs of uneven cost.
+// Each worker gets a contiguous block of indices in its own deque and takes
+// from the front; a worker that runs dry steals from the back of the others.
+// One job at a time (forEach blocks until it is done).
+// ===============================
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool {
+public:
+    using Job = std::function<void(std::size_t)>;
+
+    // threads <= 0: hardware_concurrency
+    explicit WorkStealingPool(int threads = 0) {
+        int n = threads > 0 ? threads : (int)std::thread::hardware_concurrency();
+        n = std::max(1, n);
+        for (int i = 0; i < n; i++) queues_.push_back(std::make_unique<Queue>());
+        for (int i = 0; i < n; i++) threads_.emplace_back([this, i] { workerLoop(i); });
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& t : threads_) t.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    int threads() const { return (int)threads_.size(); }
+
+    // fn(i) runs on pool threads, concurrently for different i. The first
+    // exception thrown is rethrown here once every index has been handled.
+    void forEach(std::size_t n, const Job& fn) {
+        if (n == 0) return;
+        std::unique_lock<std::mutex> lk(mu_);
+        error_ = nullptr;
+        remaining_.store(n);
+        const std::size_t w = queues_.size();
+        for (std::size_t q = 0; q < w; q++) {
+            std::lock_guard<std::mutex> ql(queues_[q]->mu);
+            queues_[q]->job = &fn;
+            for (std::size_t i = n * q / w; i < n * (q + 1) / w; i++) queues_[q]->tasks.push_back(i);
+        }
+        generation_++;
+        wake_.notify_all();
+        done_.wait(lk, [&] { return remaining_.load() == 0; });
+        if (error_) std::rethrow_exception(error_);
+    }
+
+private:
+    // the job pointer travels with the indices, so a worker still finishing
+    // one forEach can never run the next job's index with the old function
+    struct Queue {
+        std::mutex mu;
+        std::deque<std::size_t> tasks;
+        const Job* job = nullptr;
+    };
+
+    bool popLocal(std::size_t self, std::size_t& out, const Job*& job) {
+        Queue& q = *queues_[self];
+        std::lock_guard<std::mutex> lk(q.mu);
+        if (q.tasks.empty()) return false;
+        job = q.job;
+        out = q.tasks.front();
+        q.tasks.pop_front();
+        return true;
+    }
+
+    bool steal(std::size_t self, std::size_t& out, const Job*& job) {
+        for (std::size_t k = 1; k < queues_.size(); k++) {
+            Queue& q = *queues_[(self + k) % queues_.size()];
+            std::lock_guard<std::mutex> lk(q.mu);
+            if (q.tasks.empty()) continue;
+            job = q.job;
+            out = q.tasks.back();
+            q.tasks.pop_back();
+            return true;
+        }
+        return false;
+    }
+
+    void workerLoop(std::size_t self) {
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lk(mu_);
+                wake_.wait(lk, [&] { return stop_ || generation_ != seen; });
+                if (stop_) return;
+                seen = generation_;
+            }
+            std::size_t i = 0;
+            const Job* job = nullptr;
+            while (popLocal(self, i, job) || steal(self, i, job)) {
+                try {
+                    (*job)(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lk(mu_);
+                    if (!error_) error_ = std::current_exception();
+                }
+                if (remaining_.fetch_sub(1) == 1) {
+                    std::lock_guard<std::mutex> lk(mu_);
+                    done_.notify_all();
+                }
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mu_;
+    std::condition_variable wake_, done_;
+    bool stop_ = false;
+    uint64_t generation_ = 0;
+    std::atomic<std::size_t> remaining_{0};
+    std::exception_ptr error_;
+};
@@ -0,0 +1,213 @@
+// ===============================
+// File: candle_segment_test.cpp
+// Candle segmentation (CandleSegment.h), run by ctest.
+//   - drawn candles with a moving average in the bull colour across them
+//     must come back one for one, OHLC at the drawn rows
+//   - a line chart in the candle colours must not segment
+//   - the bundled screenshot (MA and alligator lines in the candle colours
+//     over every candle) must segment with its detected colours
+//   - a cached layout must not hand one chart's candle extent to the next
+//   stockpredict_candle_test [assets/charts]
+// Exit code = number of failed checks.
+// ===============================
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "CandleSegment.h"
+#include "ChartLayout.h"
+#include "ImageDecode.h"
+
+namespace {
+
+int g_failures = 0;
+
+void check(bool ok, const std::string& what) {
+    if (ok) return;
+    g_failures++;
+    std::cerr << "FAIL " << what << "\n";
+}
+
+const RGB kBull{40, 220, 140}, kBear{220, 60, 220};
+const DynamicColors kCandle{kBull, kBear, 45};
+const DynamicColors kVolume{{0, 200, 120}, {200, 60, 60}, 70};
+
+struct Canvas {
+    int w, h;
+    std::vector<unsigned char> px;
+
+    Canvas(int w, int h) : w(w), h(h), px((std::size_t)w * h * 4) {
+        for (std::size_t i = 0; i < px.size(); i += 4) {
+            px[i] = px[i + 1] = px[i + 2] = 20;
+            px[i + 3] = 255;
+        }
+    }
+    void set(int x, int y, const RGB& c) {
+        if (x < 0 || y < 0 || x >= w || y >= h) return;
+        unsigned char* p = &px[((std::size_t)y * w + x) * 4];
+        p[0] = c.r;
+        p[1] = c.g;
+        p[2] = c.b;
+    }
+    void fill(int x0, int y0, int x1, int y1, const RGB& c) {   // inclusive
+        for (int y = y0; y <= y1; y++)
+            for (int x = x0; x <= x1; x++) set(x, y, c);
+    }
+    ImageView view() const { return ImageView(px.data(), w, h); }
+};
+
+// 1 px polyline through one y per column
+void drawLine(Canvas& cv, int x0, int x1, double (*yAt)(int), const RGB& c) {
+    for (int x = x0; x < x1; x++) {
+        const int ya = (int)std::lround(yAt(x)), yb = (int)std::lround(yAt(x + 1));
+        for (int y = std::min(ya, yb); y <= std::max(ya, yb); y++) cv.set(x, y, c);
+    }
+}
+
+double maY(int x) { return 200.0 + 40.0 * std::sin(x / 45.0); }
+double priceY(int x) { return 180.0 + 60.0 * std::sin(x / 70.0) + 15.0 * std::sin(x / 11.0); }
+
+void drawnCandles() {
+    Canvas cv(600, 480);
+    const ChartLayout L = legacyChartLayout(cv.w, cv.h);
+    const float rows = (float)L.plot.height();
+
+    struct Drawn { int x; float open, close; bool edge; };
+    std::vector<Drawn> drawn;
+    for (int k = 0; k < 60; k++) {
+        const int x = L.plot.x0 + 6 + k * 9;
+        const bool bull = (k * 7 % 5) < 3;
+        const int mid = (int)priceY(x);
+        const int half = 6 + k * 13 % 20;
+        const int top = mid - half, bot = mid + half;
+        cv.fill(x + 2, top - 8, x + 2, bot + 8, bull ? kBull : kBear);   // wick
+        cv.fill(x, top, x + 4, bot, bull ? kBull : kBear);
+        auto norm = [&](int y) { return 1.f - (float)(y - L.plot.y0) / rows; };
+        // where the moving average runs along a body edge, the edge is the line's
+        bool edge = false;
+        for (int i = x; i <= x + 5; i++) {
+            const double y = maY(i);
+            edge |= std::abs(y - top) <= 2.5 || std::abs(y - bot) <= 2.5;
+        }
+        drawn.push_back({x, norm(bull ? bot : top), norm(bull ? top : bot), edge});
+    }
+    drawLine(cv, L.plot.x0, L.plot.x1 - 1, maY, kBull);
+
+    CandleSeries out;
+    std::vector<int> work;
+    const bool ok = segmentCandles(cv.view(), L, kCandle, kVolume, out, work);
+    check(ok, "drawn candles: not segmented");
+    check(out.size() == drawn.size(),
+          "drawn candles: " + std::to_string(out.size()) + " candles, drew " + std::to_string(drawn.size()));
+    if (!ok || out.size() != drawn.size()) return;
+    const float px = 1.5f / rows;
+    for (std::size_t k = 0; k < drawn.size(); k++) {
+        const std::string at = "drawn candle " + std::to_string(k) + ": ";
+        check(out.x0[k] == drawn[k].x && out.x1[k] == drawn[k].x + 5, at + "columns");
+        if (!drawn[k].edge) {
+            check(std::abs(out.open[k] - drawn[k].open) <= px, at + "open");
+            check(std::abs(out.close[k] - drawn[k].close) <= px, at + "close");
+        }
+        check(out.high[k] >= std::max(out.open[k], out.close[k]) && out.low[k] <= std::min(out.open[k], out.close[k]),
+              at + "high/low outside the body");
+    }
+}
+
+void lineChart() {
+    Canvas cv(600, 480);
+    const ChartLayout L = legacyChartLayout(cv.w, cv.h);
+    drawLine(cv, L.plot.x0, L.plot.x1 - 1, priceY, kBull);
+    drawLine(cv, L.plot.x0, L.plot.x1 - 1, maY, kBear);
+    CandleSeries out;
+    std::vector<int> work;
+    check(!segmentCandles(cv.view(), L, kCandle, kVolume, out, work), "line chart segmented");
+    check(out.size() == 0, "line chart: candles left in out");
+}
+
+void bundledChart(const std::string& dir) {
+    const std::string path = dir + "/test1.png";
+    PixelBuffer buf;
+    std::string err;
+    if (!decodeImageFile(path, buf, &err)) {
+        check(false, path + ": " + err);
+        return;
+    }
+    const ChartLayout L = analyzeChartLayout(buf.view(), kCandle.tol, legacyChartLayout(buf.width, buf.height));
+    check(L.detected && L.hasCandleColors, path + ": layout not detected");
+    const DynamicColors colors{L.bull, L.bear, kCandle.tol};
+
+    CandleSeries out;
+    std::vector<int> work;
+    if (!segmentCandles(buf.view(), L, colors, {L.volUp, L.volDown, L.volTolerance}, out, work)) {
+        check(false, path + ": not segmented");
+        return;
+    }
+    // ~140 candles 8 px apart; a few split where a line covers part of a body
+    check(out.size() >= 120 && out.size() <= 220, path + ": " + std::to_string(out.size()) + " candles");
+    for (std::size_t k = 0; k < out.size(); k++) {
+        const std::string at = path + ": candle " + std::to_string(k) + ": ";
+        check(out.x1[k] > out.x0[k] && out.x0[k] >= L.plot.x0 && out.x1[k] <= L.plot.x1, at + "columns");
+        check(k == 0 || out.x0[k] >= out.x1[k - 1], at + "overlaps the previous one");
+        check(out.high[k] >= std::max(out.open[k], out.close[k]) && out.low[k] <= std::min(out.open[k], out.close[k]),
+              at + "high/low outside the body");
+    }
+
+    // the green candle at x 491..495: body rows 650..735, wick up to 624
+    const float rows = (float)L.plot.height();
+    auto norm = [&](int y) { return 1.f - (float)(y - L.plot.y0) / rows; };
+    auto it = std::find(out.x0.begin(), out.x0.end(), 491);
+    if (it == out.x0.end()) {
+        check(false, path + ": no candle at x 491");
+        return;
+    }
+    const std::size_t k = (std::size_t)(it - out.x0.begin());
+    const float px = 2.f / rows;
+    check(out.x1[k] == 496, path + ": candle at x 491 ends at " + std::to_string(out.x1[k]));
+    check(std::abs(out.close[k] - norm(650)) <= px, path + ": candle at x 491: close");
+    check(std::abs(out.open[k] - norm(735)) <= px, path + ": candle at x 491: open");
+    check(std::abs(out.high[k] - norm(624)) <= px, path + ": candle at x 491: high");
+}
+
+// same size and border, so the same cache entry, but the candles start lower
+void cachedLayout(const std::string& dir) {
+    const std::string path = dir + "/test1.png";
+    PixelBuffer a;
+    std::string err;
+    if (!decodeImageFile(path, a, &err)) {
+        check(false, path + ": " + err);
+        return;
+    }
+    PixelBuffer b = a;
+    const std::size_t bg = ((std::size_t)300 * b.width + 600) * 4;   // empty plot background
+    for (int y = 200; y < 460; y++)
+        for (int x = 1; x < b.width - 1; x++)
+            std::copy(&a.rgba[bg], &a.rgba[bg] + 4, &b.rgba[((std::size_t)y * b.width + x) * 4]);
+
+    const ChartLayout fallback = legacyChartLayout(a.width, a.height);
+    const ChartLayout directA = analyzeChartLayout(a.view(), kCandle.tol, fallback);
+    const ChartLayout directB = analyzeChartLayout(b.view(), kCandle.tol, fallback);
+    check(directB.plot.y0 >= 460, path + ": blanked chart's plot starts at " + std::to_string(directB.plot.y0));
+
+    ChartLayoutCache cache;
+    const ChartLayout cachedA = cache.get(a.view(), kCandle.tol, fallback);
+    const ChartLayout cachedB = cache.get(b.view(), kCandle.tol, fallback);
+    check(cache.misses() == 1, path + ": " + std::to_string(cache.misses()) + " cache misses");
+    check(cachedA.plot.y0 == directA.plot.y0 && cachedA.plot.y1 == directA.plot.y1, path + ": cached plot");
+    check(cachedB.plot.y0 == directB.plot.y0 && cachedB.plot.y1 == directB.plot.y1,
+          path + ": blanked chart got plot y0 " + std::to_string(cachedB.plot.y0) + " from the cache, not " +
+              std::to_string(directB.plot.y0));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    drawnCandles();
+    lineChart();
+    bundledChart(argc > 1 ? argv[1] : "assets/charts");
+    cachedLayout(argc > 1 ? argv[1] : "assets/charts");
+    std::cout << (g_failures ? std::to_string(g_failures) + " failed" : std::string("all passed")) << "\n";
+    return g_failures;
+}
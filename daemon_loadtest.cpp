@@ -0,0 +1,127 @@
+// ===============================
+// File: daemon_loadtest.cpp
+// stockpredict_loadtest — hammers stockpredictd and reports throughput + tail latency.
+//   stockpredict_loadtest --image assets/charts/test1.png [--socket path]
+//                         [--clients 8] [--requests 200] [--tf 5] [--ohlcv BARS]
+// --ohlcv sends generated inline bars instead of an image path.
+// ===============================
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DaemonProtocol.h"
+
+using namespace daemonproto;
+
+static std::vector<float> makeBars(int bars, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> step(0.f, 0.004f);
+    std::vector<float> out;
+    out.reserve((size_t)bars * 5);
+    float px = 10.f;
+    for (int i = 0; i < bars; i++) {
+        float o = px;
+        float c = std::max(0.1f, o * (1.f + step(rng)));
+        float h = std::max(o, c) * 1.002f;
+        float l = std::min(o, c) * 0.998f;
+        out.insert(out.end(), {o, h, l, c, 1000.f + 500.f * std::abs(step(rng)) * 100.f});
+        px = c;
+    }
+    return out;
+}
+
+int main(int argc, char** argv) {
+    std::string socketPath = "/tmp/stockpredictd.sock";
+    std::string image;
+    int clients = 8, requests = 200, tf = 5, ohlcvBars = 0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : ""; };
+        if (a == "--socket") socketPath = next();
+        else if (a == "--image") image = next();
+        else if (a == "--clients") clients = std::max(1, std::atoi(next()));
+        else if (a == "--requests") requests = std::max(1, std::atoi(next()));
+        else if (a == "--tf") tf = std::atoi(next());
+        else if (a == "--ohlcv") ohlcvBars = std::max(30, std::atoi(next()));
+        else {
+            std::cerr << "usage: stockpredict_loadtest --image path | --ohlcv BARS [--socket path] "
+                         "[--clients N] [--requests N] [--tf N]\n";
+            return 2;
+        }
+    }
+    if (image.empty() && ohlcvBars == 0) {
+        std::cerr << "need --image or --ohlcv\n";
+        return 2;
+    }
+
+    std::vector<std::vector<double>> lat(clients);
+    std::atomic<int> failures{0};
+    std::string firstSignal;
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int c = 0; c < clients; c++) {
+        threads.emplace_back([&, c] {
+            Client client;
+            std::string err;
+            if (!client.connect(socketPath, &err)) {
+                std::cerr << err << "\n";
+                failures += requests;
+                return;
+            }
+            Request req;
+            req.tfMinutes = tf;
+            req.timeStr = "12:00";
+            if (ohlcvBars > 0) {
+                req.kind = Kind::Ohlcv;
+                req.ohlcv = makeBars(ohlcvBars, (unsigned)c + 1);
+            } else {
+                req.kind = Kind::Path;
+                req.path = image;
+            }
+
+            lat[c].reserve(requests);
+            Reply reply;
+            for (int i = 0; i < requests; i++) {
+                auto a = std::chrono::steady_clock::now();
+                if (!client.call(req, reply) || !reply.ok) {
+                    if (!reply.ok && c == 0 && i == 0) std::cerr << "error: " << reply.error << "\n";
+                    failures++;
+                    continue;
+                }
+                auto b = std::chrono::steady_clock::now();
+                lat[c].push_back(std::chrono::duration<double, std::milli>(b - a).count());
+                if (c == 0 && i == 0) firstSignal = reply.prediction.label + " " + reply.prediction.signal;
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::vector<double> all;
+    for (auto& v : lat) all.insert(all.end(), v.begin(), v.end());
+    std::sort(all.begin(), all.end());
+    auto pct = [&](double q) {
+        if (all.empty()) return 0.0;
+        size_t idx = (size_t)std::min<double>((double)all.size() - 1, std::ceil(q * (double)all.size()) - 1);
+        return all[idx];
+    };
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "requests:   " << all.size() << " ok, " << failures.load() << " failed\n"
+              << "clients:    " << clients << "\n"
+              << "throughput: " << (secs > 0 ? (double)all.size() / secs : 0.0) << " req/s\n"
+              << "latency ms: p50=" << pct(0.50) << " p90=" << pct(0.90) << " p99=" << pct(0.99)
+              << " p99.9=" << pct(0.999) << " max=" << (all.empty() ? 0.0 : all.back()) << "\n"
+              << "sample:     " << firstSignal << "\n";
+    return failures.load() ? 1 : 0;
+}
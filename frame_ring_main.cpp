@@ -0,0 +1,215 @@
+// ===============================
+// File: frame_ring_main.cpp
+// stockpredict_frames — shared-memory frame ring (see FrameRing.h), both ends.
+//   stockpredict_frames produce [--ring name] [--dir assets/charts] [--fps N] [--slots N]
+//       replays every PNG/PPM in dir as live frames (stand-in for the capture process)
+//   stockpredict_frames consume [--ring name] [--max-age-ms N] [--config file]
+//       scores the newest frame per symbol/TF in place, prints one line per frame
+//   stockpredict_frames demo [--dir assets/charts] [--fps N] [--seconds N]
+//       both of the above in one process, then prints reader stats
+// Symbol = file name up to the first '_', TF from the name (XRP_1m_..., test5).
+// --config: predictor settings (PredictorConfig.h), read once at start.
+// ===============================
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ChartMeta.h"
+#include "FrameRing.h"
+#include "ImageDecode.h"
+#include "Predictor.h"
+#include "PredictorConfig.h"
+
+static std::atomic<bool> g_quit{false};
+
+static void onQuitSignal(int) { g_quit.store(true); }
+
+struct ReplayFrame {
+    std::string symbol;
+    int tfMinutes = -1;
+    PixelBuffer pixels;
+};
+
+static std::vector<ReplayFrame> loadReplayFrames(const std::string& dir) {
+    namespace fs = std::filesystem;
+    std::vector<ReplayFrame> frames;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        if (!entry.is_regular_file()) continue;
+        const std::string ext = entry.path().extension().string();
+        if (ext != ".png" && ext != ".ppm" && ext != ".pgm") continue;
+
+        ReplayFrame f;
+        std::string err;
+        if (!decodeImageFile(entry.path().string(), f.pixels, &err)) {
+            std::cerr << "skip " << entry.path() << ": " << err << "\n";
+            continue;
+        }
+        const std::string stem = entry.path().stem().string();
+        f.symbol = stem.substr(0, stem.find('_'));
+        f.tfMinutes = parseMetaFromFilename(entry.path().string()).tfMin;
+        f.pixels.fileBytes.clear();
+        f.pixels.fileBytes.shrink_to_fit();
+        frames.push_back(std::move(f));
+    }
+    std::sort(frames.begin(), frames.end(), [](const ReplayFrame& a, const ReplayFrame& b) {
+        return a.symbol != b.symbol ? a.symbol < b.symbol : a.tfMinutes < b.tfMinutes;
+    });
+    return frames;
+}
+
+static int runProducer(const std::string& ring, const std::string& dir, int fps, int slots, int seconds) {
+    std::vector<ReplayFrame> frames = loadReplayFrames(dir);
+    if (frames.empty()) {
+        std::cerr << "no charts in " << dir << "\n";
+        return 1;
+    }
+    FrameRingConfig cfg;
+    cfg.slots = (uint32_t)std::max(2, slots);
+    cfg.maxWidth = 0;
+    cfg.maxHeight = 0;
+    for (const auto& f : frames) {
+        cfg.maxWidth = std::max(cfg.maxWidth, f.pixels.width);
+        cfg.maxHeight = std::max(cfg.maxHeight, f.pixels.height);
+    }
+
+    std::string err;
+    auto writer = FrameRingWriter::create(ring, cfg, &err);
+    if (!writer) {
+        std::cerr << "producer: " << err << "\n";
+        return 1;
+    }
+    std::cout << "producing " << frames.size() << " charts into /" << ring << " at " << fps << " fps ("
+              << cfg.slots << " slots of " << cfg.maxWidth << "x" << cfg.maxHeight << ")" << std::endl;
+
+    const auto period = std::chrono::nanoseconds(1000000000LL / std::max(1, fps));
+    const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(seconds > 0 ? seconds : 1 << 30);
+    auto next = std::chrono::steady_clock::now();
+    size_t i = 0;
+    while (!g_quit.load() && std::chrono::steady_clock::now() < until) {
+        const ReplayFrame& f = frames[i++ % frames.size()];
+        if (!writer->publish(f.symbol, f.tfMinutes, f.pixels.view(), &err)) {
+            std::cerr << "publish " << f.symbol << ": " << err << "\n";
+        }
+        next += period;
+        std::this_thread::sleep_until(next);
+    }
+    std::cout << "published " << writer->published() << " frames" << std::endl;
+    return 0;
+}
+
+static int runConsumer(const std::string& ring, int maxAgeMs, int seconds, bool quiet,
+                       const std::string& configPath) {
+    std::string err;
+    PredictorConfig cfg;
+    if (!configPath.empty() && !loadPredictorConfig(configPath, cfg, &err)) {
+        std::cerr << "consumer: " << err << "\n";
+        return 1;
+    }
+    std::unique_ptr<FrameRingReader> reader;
+    // the producer may still be starting up
+    for (int tries = 0; !reader && tries < 50 && !g_quit.load(); tries++) {
+        reader = FrameRingReader::open(ring, &err);
+        if (!reader) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    if (!reader) {
+        std::cerr << "consumer: " << err << "\n";
+        return 1;
+    }
+
+    Predictor predictor;
+    predictor.setConfidenceThreshold(60.0);
+    if (!configPath.empty()) predictor.applyConfig(cfg);
+    const std::string timeStr = nowHHMM();
+
+    const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(seconds > 0 ? seconds : 1 << 30);
+    uint64_t scored = 0;
+    double latencySumMs = 0.0;
+    while (!g_quit.load() && std::chrono::steady_clock::now() < until) {
+        if (!reader->waitForFrames(100)) continue;
+        for (const FrameInfo& f : reader->latestFrames(maxAgeMs)) {
+            Prediction p;
+            try {
+                p = predictor.predictImage(f.view, timeStr, f.tfMinutes);
+            } catch (const std::exception& e) {
+                std::cerr << f.symbol << ": " << e.what() << "\n";
+                continue;
+            }
+            if (!reader->stillValid(f)) {
+                reader->countTorn();   // overwritten mid-score; a newer frame is coming anyway
+                continue;
+            }
+            const double latencyMs = (frameClockNs() - f.captureNs) / 1e6;
+            scored++;
+            latencySumMs += latencyMs;
+            if (!quiet) {
+                std::cout << "#" << f.index << " " << f.symbol << " tf=" << f.tfMinutes << "m "
+                          << p.label << " " << p.signal << " conf=" << std::fixed << std::setprecision(1)
+                          << p.confidence << " (" << std::setprecision(2) << latencyMs << " ms after capture)"
+                          << std::endl;
+            }
+        }
+    }
+
+    const FrameReadStats& st = reader->stats();
+    std::cout << "scored " << scored << " frames, mean capture->signal "
+              << std::fixed << std::setprecision(2) << (scored ? latencySumMs / scored : 0.0) << " ms; skipped "
+              << st.superseded << " superseded, " << st.tooOld << " too old, " << st.lapped << " lapped, "
+              << st.torn << " torn" << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: stockpredict_frames produce|consume|demo [--ring name] [--dir path] [--fps N]"
+                     " [--slots N] [--max-age-ms N] [--seconds N] [--quiet] [--config file]\n";
+        return 2;
+    }
+    const std::string mode = argv[1];
+    std::string ring = "stockpredict_frames";
+    std::string dir = "assets/charts";
+    std::string configPath;
+    int fps = 30, slots = 16, maxAgeMs = 500, seconds = 0;
+    bool quiet = false;
+    for (int i = 2; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : ""; };
+        if (a == "--ring") ring = next();
+        else if (a == "--dir") dir = next();
+        else if (a == "--fps") fps = std::atoi(next());
+        else if (a == "--slots") slots = std::atoi(next());
+        else if (a == "--max-age-ms") maxAgeMs = std::atoi(next());
+        else if (a == "--seconds") seconds = std::atoi(next());
+        else if (a == "--quiet") quiet = true;
+        else if (a == "--config") configPath = next();
+        else {
+            std::cerr << "unknown option " << a << "\n";
+            return 2;
+        }
+    }
+
+    std::signal(SIGINT, onQuitSignal);
+    std::signal(SIGTERM, onQuitSignal);
+
+    if (mode == "produce") return runProducer(ring, dir, fps, slots, seconds);
+    if (mode == "consume") return runConsumer(ring, maxAgeMs, seconds, quiet, configPath);
+    if (mode == "demo") {
+        if (seconds <= 0) seconds = 5;
+        int producerRc = 0;
+        std::thread producer([&] { producerRc = runProducer(ring, dir, fps, slots, seconds); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        int rc = runConsumer(ring, maxAgeMs, seconds, quiet, configPath);
+        producer.join();
+        return rc ? rc : producerRc;
+    }
+    std::cerr << "unknown mode " << mode << "\n";
+    return 2;
+}
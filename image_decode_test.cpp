@@ -0,0 +1,716 @@
+// ===============================
+// File: image_decode_test.cpp
+// Round trips for the PNG decoder (ImageDecode.h), run by ctest.
+// PNGs are encoded here: every colour type and bit depth, each filter type
+// (and all five mixed in one image), Adam7, palette + tRNS, colour keys,
+// stored / fixed / dynamic Huffman deflate blocks, split IDATs. Each one is
+// decoded and compared pixel for pixel with the RGBA8 the decoder promises.
+// A few broken streams must fail cleanly, and the bundled chart screenshot
+// (a real encoder's dynamic blocks) must match a digest taken with an
+// independent decoder (Python zlib + a by-the-spec unfilter).
+//   stockpredict_decode_test [assets/charts]
+// Exit code = number of failed checks.
+// ===============================
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "ImageDecode.h"
+
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+int g_failures = 0;
+
+void check(bool ok, const std::string& what) {
+    if (ok) return;
+    g_failures++;
+    std::cerr << "FAIL " << what << "\n";
+}
+
+// deterministic, so a failure reproduces
+struct Rng {
+    uint32_t s;
+    uint32_t next() {
+        s ^= s << 13;
+        s ^= s >> 17;
+        s ^= s << 5;
+        return s;
+    }
+};
+
+// ---------- deflate encoder (RFC 1951) ----------
+class BitWriter {
+public:
+    explicit BitWriter(Bytes& out) : out_(out) {}
+    void put(uint32_t v, int n) {   // LSB first
+        for (int i = 0; i < n; i++) {
+            acc_ |= ((v >> i) & 1u) << cnt_;
+            if (++cnt_ == 8) flushByte();
+        }
+    }
+    void putCode(uint32_t code, int len) {   // Huffman codes go MSB first
+        for (int i = len - 1; i >= 0; i--) put((code >> i) & 1u, 1);
+    }
+    void align() {
+        if (cnt_) flushByte();
+    }
+
+private:
+    void flushByte() {
+        out_.push_back((uint8_t)acc_);
+        acc_ = 0;
+        cnt_ = 0;
+    }
+    Bytes& out_;
+    uint32_t acc_ = 0;
+    int cnt_ = 0;
+};
+
+const uint16_t kLenBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                               35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const uint8_t kLenExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                               3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const uint16_t kDistBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                8193, 12289, 16385, 24577};
+const uint8_t kDistExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+struct Token {
+    uint16_t lit = 0;    // literal, when len == 0
+    uint16_t len = 0;
+    uint16_t dist = 0;
+};
+
+int lengthSymbol(int len) {
+    int s = 28;
+    while (kLenBase[s] > len) s--;
+    return s;
+}
+
+int distSymbol(int dist) {
+    int s = 29;
+    while (kDistBase[s] > dist) s--;
+    return s;
+}
+
+// Greedy LZ77 over [begin, end) with matches reaching back into everything
+// before it (earlier blocks included); rows of an image repeat, so matches
+// (overlapping ones too) are common.
+std::vector<Token> lz77(const Bytes& data, std::size_t begin, std::size_t end, std::vector<int32_t>& head) {
+    std::vector<Token> toks;
+    auto hash = [&](std::size_t i) {
+        return ((uint32_t)data[i] << 10 ^ (uint32_t)data[i + 1] << 5 ^ data[i + 2]) & 0x7FFF;
+    };
+    std::size_t i = begin;
+    while (i < end) {
+        int bestLen = 0, bestDist = 0;
+        if (i + 3 <= end) {
+            const uint32_t h = hash(i);
+            const int32_t cand = head[h];
+            if (cand >= 0 && i - (std::size_t)cand <= 32768) {
+                int l = 0;
+                while (l < 258 && i + l < end && data[(std::size_t)cand + l] == data[i + l]) l++;
+                if (l >= 3) bestLen = l, bestDist = (int)(i - (std::size_t)cand);
+            }
+            head[h] = (int32_t)i;
+        }
+        if (bestLen) {
+            toks.push_back({0, (uint16_t)bestLen, (uint16_t)bestDist});
+            for (std::size_t k = i + 1; k < i + (std::size_t)bestLen && k + 3 <= end; k++) head[hash(k)] = (int32_t)k;
+            i += (std::size_t)bestLen;
+        } else {
+            toks.push_back({data[i], 0, 0});
+            i++;
+        }
+    }
+    return toks;
+}
+
+// Huffman code lengths for freq, none longer than maxLen (frequencies are
+// flattened until the tree fits). Unused symbols get 0.
+std::vector<uint8_t> codeLengths(std::vector<uint32_t> freq, int maxLen) {
+    const std::size_t n = freq.size();
+    std::vector<uint8_t> len(n, 0);
+    for (;;) {
+        struct Node { uint64_t w; int left, right, sym; };
+        std::vector<Node> nodes;
+        using Item = std::pair<uint64_t, int>;
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item>> q;
+        for (std::size_t s = 0; s < n; s++) {
+            if (!freq[s]) continue;
+            nodes.push_back({freq[s], -1, -1, (int)s});
+            q.push({freq[s], (int)nodes.size() - 1});
+        }
+        if (nodes.empty()) return len;
+        if (nodes.size() == 1) {
+            len[(std::size_t)nodes[0].sym] = 1;
+            return len;
+        }
+        while (q.size() > 1) {
+            const Item a = q.top(); q.pop();
+            const Item b = q.top(); q.pop();
+            nodes.push_back({a.first + b.first, a.second, b.second, -1});
+            q.push({a.first + b.first, (int)nodes.size() - 1});
+        }
+        std::fill(len.begin(), len.end(), 0);
+        int deepest = 0;
+        std::function<void(int, int)> walk = [&](int i, int depth) {
+            if (nodes[(std::size_t)i].sym >= 0) {
+                len[(std::size_t)nodes[(std::size_t)i].sym] = (uint8_t)depth;
+                deepest = std::max(deepest, depth);
+                return;
+            }
+            walk(nodes[(std::size_t)i].left, depth + 1);
+            walk(nodes[(std::size_t)i].right, depth + 1);
+        };
+        walk(q.top().second, 0);
+        if (deepest <= maxLen) return len;
+        for (uint32_t& f : freq)
+            if (f) f = (f + 1) / 2;
+    }
+}
+
+// canonical codes from lengths (RFC 1951 3.2.2)
+std::vector<uint32_t> canonicalCodes(const std::vector<uint8_t>& len) {
+    uint32_t count[16] = {}, next[16] = {};
+    for (uint8_t l : len) count[l]++;
+    count[0] = 0;
+    uint32_t code = 0;
+    for (int b = 1; b < 16; b++) {
+        code = (code + count[b - 1]) << 1;
+        next[b] = code;
+    }
+    std::vector<uint32_t> codes(len.size(), 0);
+    for (std::size_t s = 0; s < len.size(); s++)
+        if (len[s]) codes[s] = next[len[s]]++;
+    return codes;
+}
+
+enum class BlockMode { Stored, Fixed, Dynamic, Mixed };
+
+void writeTokens(BitWriter& bw, const std::vector<Token>& toks, const std::vector<uint8_t>& litLen,
+                 const std::vector<uint32_t>& litCode, const std::vector<uint8_t>& distLen,
+                 const std::vector<uint32_t>& distCode) {
+    for (const Token& t : toks) {
+        if (!t.len) {
+            bw.putCode(litCode[t.lit], litLen[t.lit]);
+            continue;
+        }
+        const int ls = lengthSymbol(t.len);
+        bw.putCode(litCode[257 + (std::size_t)ls], litLen[257 + (std::size_t)ls]);
+        bw.put((uint32_t)(t.len - kLenBase[ls]), kLenExtra[ls]);
+        const int ds = distSymbol(t.dist);
+        bw.putCode(distCode[(std::size_t)ds], distLen[(std::size_t)ds]);
+        bw.put((uint32_t)(t.dist - kDistBase[ds]), kDistExtra[ds]);
+    }
+    bw.putCode(litCode[256], litLen[256]);
+}
+
+void writeDynamicHeader(BitWriter& bw, const std::vector<uint8_t>& litLen, const std::vector<uint8_t>& distLen) {
+    std::size_t hlit = 286, hdist = 30;
+    while (hlit > 257 && !litLen[hlit - 1]) hlit--;
+    while (hdist > 1 && !distLen[hdist - 1]) hdist--;
+    std::vector<uint8_t> all(litLen.begin(), litLen.begin() + (std::ptrdiff_t)hlit);
+    all.insert(all.end(), distLen.begin(), distLen.begin() + (std::ptrdiff_t)hdist);
+
+    // run-length code the lengths with 16 / 17 / 18
+    struct Cl { uint8_t sym, extra, extraBits; };
+    std::vector<Cl> cl;
+    for (std::size_t i = 0; i < all.size();) {
+        std::size_t run = 1;
+        while (i + run < all.size() && all[i + run] == all[i]) run++;
+        if (all[i] == 0 && run >= 3) {
+            const std::size_t r = std::min<std::size_t>(run, 138);
+            if (r >= 11) cl.push_back({18, (uint8_t)(r - 11), 7});
+            else cl.push_back({17, (uint8_t)(r - 3), 3});
+            i += r;
+        } else if (all[i] != 0 && run >= 4) {
+            cl.push_back({all[i], 0, 0});
+            const std::size_t r = std::min<std::size_t>(run - 1, 6);
+            cl.push_back({16, (uint8_t)(r - 3), 2});
+            i += 1 + r;
+        } else {
+            cl.push_back({all[i], 0, 0});
+            i++;
+        }
+    }
+    std::vector<uint32_t> clFreq(19, 0);
+    for (const Cl& c : cl) clFreq[c.sym]++;
+    const std::vector<uint8_t> clLen = codeLengths(clFreq, 7);
+    const std::vector<uint32_t> clCode = canonicalCodes(clLen);
+    static const uint8_t order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+    int hclen = 19;
+    while (hclen > 4 && !clLen[order[hclen - 1]]) hclen--;
+
+    bw.put((uint32_t)(hlit - 257), 5);
+    bw.put((uint32_t)(hdist - 1), 5);
+    bw.put((uint32_t)(hclen - 4), 4);
+    for (int i = 0; i < hclen; i++) bw.put(clLen[order[i]], 3);
+    for (const Cl& c : cl) {
+        bw.putCode(clCode[c.sym], clLen[c.sym]);
+        bw.put(c.extra, c.extraBits);
+    }
+}
+
+// data in blocks of blockBytes; Mixed cycles stored / fixed / dynamic
+Bytes deflate(const Bytes& data, BlockMode mode, std::size_t blockBytes) {
+    Bytes out;
+    BitWriter bw(out);
+    std::vector<int32_t> head(1 << 15, -1);
+
+    std::vector<uint8_t> fixedLit(288), fixedDist(30, 5);
+    for (int s = 0; s < 288; s++) fixedLit[(std::size_t)s] = s < 144 ? 8 : s < 256 ? 9 : s < 280 ? 7 : 8;
+    const std::vector<uint32_t> fixedLitCode = canonicalCodes(fixedLit), fixedDistCode = canonicalCodes(fixedDist);
+
+    std::size_t pos = 0;
+    int block = 0;
+    do {
+        const std::size_t end = std::min(data.size(), pos + blockBytes);
+        const bool last = end == data.size();
+        BlockMode m = mode;
+        if (mode == BlockMode::Mixed) m = block % 3 == 0 ? BlockMode::Stored : block % 3 == 1 ? BlockMode::Fixed : BlockMode::Dynamic;
+        block++;
+
+        if (m == BlockMode::Stored) {
+            // at most 65535 bytes per stored block: split where needed
+            for (std::size_t p = pos;;) {
+                const std::size_t n = std::min<std::size_t>(65535, end - p);
+                bw.put(last && p + n == end ? 1 : 0, 1);
+                bw.put(0, 2);
+                bw.align();
+                bw.put((uint32_t)n, 16);
+                bw.put((uint32_t)n ^ 0xFFFF, 16);
+                for (std::size_t k = 0; k < n; k++) bw.put(data[p + k], 8);
+                p += n;
+                if (p == end) break;
+            }
+            // keep the match finder aware of the bytes stored here
+            for (std::size_t k = pos; k + 3 <= end; k++)
+                head[((uint32_t)data[k] << 10 ^ (uint32_t)data[k + 1] << 5 ^ data[k + 2]) & 0x7FFF] = (int32_t)k;
+        } else {
+            const std::vector<Token> toks = lz77(data, pos, end, head);
+            bw.put(last ? 1 : 0, 1);
+            if (m == BlockMode::Fixed) {
+                bw.put(1, 2);
+                writeTokens(bw, toks, fixedLit, fixedLitCode, fixedDist, fixedDistCode);
+            } else {
+                bw.put(2, 2);
+                std::vector<uint32_t> litFreq(286, 0), distFreq(30, 0);
+                for (const Token& t : toks) {
+                    if (!t.len) litFreq[t.lit]++;
+                    else litFreq[257 + (std::size_t)lengthSymbol(t.len)]++, distFreq[(std::size_t)distSymbol(t.dist)]++;
+                }
+                litFreq[256] = 1;
+                std::vector<uint8_t> litLen = codeLengths(litFreq, 15), distLen = codeLengths(distFreq, 15);
+                if (std::all_of(distLen.begin(), distLen.end(), [](uint8_t l) { return l == 0; })) distLen[0] = 1;
+                writeDynamicHeader(bw, litLen, distLen);
+                writeTokens(bw, toks, litLen, canonicalCodes(litLen), distLen, canonicalCodes(distLen));
+            }
+        }
+        pos = end;
+    } while (pos < data.size());
+    bw.align();
+    return out;
+}
+
+uint32_t adler32(const Bytes& d) {
+    uint32_t a = 1, b = 0;
+    for (uint8_t x : d) {
+        a = (a + x) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+Bytes zlibWrap(const Bytes& raw, BlockMode mode, std::size_t blockBytes) {
+    Bytes z = {0x78, 0x01};
+    const Bytes body = deflate(raw, mode, blockBytes);
+    z.insert(z.end(), body.begin(), body.end());
+    const uint32_t a = adler32(raw);
+    for (int s = 24; s >= 0; s -= 8) z.push_back((uint8_t)(a >> s));
+    return z;
+}
+
+// ---------- PNG encoder ----------
+uint32_t crc32(const uint8_t* p, std::size_t n, uint32_t c = 0xFFFFFFFFu) {
+    for (std::size_t i = 0; i < n; i++) {
+        c ^= p[i];
+        for (int k = 0; k < 8; k++) c = (c >> 1) ^ (0xEDB88320u & (0u - (c & 1u)));
+    }
+    return c;
+}
+
+void put32(Bytes& b, uint32_t v) {
+    for (int s = 24; s >= 0; s -= 8) b.push_back((uint8_t)(v >> s));
+}
+
+void chunk(Bytes& png, const char* type, const Bytes& body) {
+    put32(png, (uint32_t)body.size());
+    const std::size_t at = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), body.begin(), body.end());
+    put32(png, crc32(png.data() + at, png.size() - at) ^ 0xFFFFFFFFu);
+}
+
+struct Case {
+    std::string name;
+    int width = 13, height = 7;
+    int colorType = 6, depth = 8;
+    bool adam7 = false;
+    int filter = -1;                 // 0..4, or -1: row y uses filter y % 5
+    BlockMode mode = BlockMode::Mixed;
+    std::size_t blockBytes = 97;     // small, so every image spans several blocks
+    std::size_t idatBytes = 0;       // > 0: IDAT split into chunks of this size
+    bool key = false;                // tRNS colour key (grey / RGB)
+    int paletteSize = 0;             // colour type 3 (0 = 1 << depth)
+    int paletteAlpha = 0;            // entries with a tRNS alpha
+};
+
+int channelsOf(int colorType) {
+    switch (colorType) {
+    case 0: return 1;
+    case 2: return 3;
+    case 3: return 1;
+    case 4: return 2;
+    default: return 4;
+    }
+}
+
+struct Image {
+    std::vector<uint32_t> samples;   // width * height * channels, full range
+    Bytes palette;                   // RGB triples
+    Bytes paletteAlpha;
+    uint32_t key[3] = {0, 0, 0};
+};
+
+// Smooth ramps plus noise: rows resemble each other (LZ77 matches) without
+// being identical, and every filter has something to predict.
+Image makeImage(const Case& c, Rng& rng) {
+    Image im;
+    const int ch = channelsOf(c.colorType);
+    const uint32_t maxv = c.colorType == 3 ? (uint32_t)(c.paletteSize ? c.paletteSize : 1 << c.depth) - 1
+                                           : (uint32_t)((1u << c.depth) - 1);
+    im.samples.resize((std::size_t)c.width * c.height * ch);
+    for (int y = 0; y < c.height; y++)
+        for (int x = 0; x < c.width; x++)
+            for (int k = 0; k < ch; k++) {
+                const uint64_t ramp = (uint64_t)((x * 7 + y * 3 + k * 11) % 64) * maxv / 63;
+                const uint32_t noise = rng.next() % 4 == 0 ? rng.next() % (maxv + 1) : 0;
+                im.samples[((std::size_t)y * c.width + x) * ch + k] = (uint32_t)((ramp + noise) % (maxv + 1));
+            }
+    if (c.colorType == 3) {
+        for (uint32_t i = 0; i <= maxv; i++)
+            for (int k = 0; k < 3; k++) im.palette.push_back((uint8_t)rng.next());
+        for (int i = 0; i < c.paletteAlpha; i++) im.paletteAlpha.push_back((uint8_t)rng.next());
+    }
+    if (c.key) {
+        // a colour that is certainly present: the first pixel's
+        for (int k = 0; k < ch; k++) im.key[k] = im.samples[(std::size_t)k];
+    }
+    return im;
+}
+
+// what the decoder must turn a pixel into
+void expectedPixel(const Case& c, const Image& im, std::size_t px, uint8_t out[4]) {
+    const int ch = channelsOf(c.colorType);
+    const uint32_t* s = &im.samples[px * ch];
+    const uint32_t maxv = (1u << c.depth) - 1;
+    auto to8 = [&](uint32_t v) -> uint8_t {
+        if (c.depth == 16) return (uint8_t)(v >> 8);
+        return (uint8_t)(v * 255 / maxv);
+    };
+    switch (c.colorType) {
+    case 0:
+        out[0] = out[1] = out[2] = to8(s[0]);
+        out[3] = c.key && s[0] == im.key[0] ? 0 : 255;
+        break;
+    case 2:
+        for (int k = 0; k < 3; k++) out[k] = to8(s[k]);
+        out[3] = c.key && s[0] == im.key[0] && s[1] == im.key[1] && s[2] == im.key[2] ? 0 : 255;
+        break;
+    case 3:
+        for (int k = 0; k < 3; k++) out[k] = im.palette[s[0] * 3 + (std::size_t)k];
+        out[3] = s[0] < im.paletteAlpha.size() ? im.paletteAlpha[s[0]] : 255;
+        break;
+    case 4:
+        out[0] = out[1] = out[2] = to8(s[0]);
+        out[3] = to8(s[1]);
+        break;
+    default:
+        for (int k = 0; k < 4; k++) out[k] = to8(s[k]);
+    }
+}
+
+uint8_t paeth(int a, int b, int c) {
+    const int p = a + b - c, pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return (uint8_t)a;
+    return (uint8_t)(pb <= pc ? b : c);
+}
+
+// packed, filtered scanlines of the w x h sub-image at (x0, y0) step (dx, dy)
+void appendScanlines(const Case& c, const Image& im, int x0, int y0, int dx, int dy, Bytes& raw) {
+    const int ch = channelsOf(c.colorType);
+    const int w = c.width > x0 ? (c.width - x0 + dx - 1) / dx : 0;
+    const int h = c.height > y0 ? (c.height - y0 + dy - 1) / dy : 0;
+    if (!w || !h) return;
+    const std::size_t rowBytes = ((std::size_t)w * ch * c.depth + 7) / 8;
+    const std::size_t bpp = (std::size_t)std::max(1, ch * c.depth / 8);
+
+    Bytes prev(rowBytes, 0), cur(rowBytes);
+    for (int r = 0; r < h; r++) {
+        std::fill(cur.begin(), cur.end(), 0);
+        const int y = y0 + r * dy;
+        for (int i = 0; i < w; i++) {
+            const int x = x0 + i * dx;
+            for (int k = 0; k < ch; k++) {
+                const uint32_t v = im.samples[((std::size_t)y * c.width + x) * ch + k];
+                const std::size_t idx = (std::size_t)i * ch + k;
+                if (c.depth == 16) {
+                    cur[2 * idx] = (uint8_t)(v >> 8);
+                    cur[2 * idx + 1] = (uint8_t)v;
+                } else if (c.depth == 8) {
+                    cur[idx] = (uint8_t)v;
+                } else {
+                    const std::size_t bit = idx * (std::size_t)c.depth;
+                    cur[bit >> 3] |= (uint8_t)(v << (8 - c.depth - (int)(bit & 7)));
+                }
+            }
+        }
+        const int f = c.filter >= 0 ? c.filter : r % 5;
+        raw.push_back((uint8_t)f);
+        for (std::size_t i = 0; i < rowBytes; i++) {
+            const int a = i >= bpp ? cur[i - bpp] : 0, b = prev[i], cc = i >= bpp ? prev[i - bpp] : 0;
+            int pred = 0;
+            switch (f) {
+            case 1: pred = a; break;
+            case 2: pred = b; break;
+            case 3: pred = (a + b) >> 1; break;
+            case 4: pred = paeth(a, b, cc); break;
+            }
+            raw.push_back((uint8_t)(cur[i] - pred));
+        }
+        prev = cur;
+    }
+}
+
+Bytes encodePng(const Case& c, const Image& im) {
+    Bytes raw;
+    if (!c.adam7) {
+        appendScanlines(c, im, 0, 0, 1, 1, raw);
+    } else {
+        static const int passes[7][4] = {{0, 0, 8, 8}, {4, 0, 8, 8}, {0, 4, 4, 8}, {2, 0, 4, 4},
+                                         {0, 2, 2, 4}, {1, 0, 2, 2}, {0, 1, 1, 2}};
+        for (const auto& p : passes) appendScanlines(c, im, p[0], p[1], p[2], p[3], raw);
+    }
+
+    Bytes png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    Bytes ihdr;
+    put32(ihdr, (uint32_t)c.width);
+    put32(ihdr, (uint32_t)c.height);
+    ihdr.insert(ihdr.end(), {(uint8_t)c.depth, (uint8_t)c.colorType, 0, 0, (uint8_t)(c.adam7 ? 1 : 0)});
+    chunk(png, "IHDR", ihdr);
+    if (c.colorType == 3) chunk(png, "PLTE", im.palette);
+    if (!im.paletteAlpha.empty()) chunk(png, "tRNS", im.paletteAlpha);
+    if (c.key) {
+        Bytes t;
+        for (int k = 0; k < (c.colorType == 2 ? 3 : 1); k++) t.insert(t.end(), {(uint8_t)(im.key[k] >> 8), (uint8_t)im.key[k]});
+        chunk(png, "tRNS", t);
+    }
+    const Bytes z = zlibWrap(raw, c.mode, c.blockBytes);
+    const std::size_t step = c.idatBytes ? c.idatBytes : z.size();
+    for (std::size_t p = 0; p < z.size(); p += step)
+        chunk(png, "IDAT", Bytes(z.begin() + (std::ptrdiff_t)p, z.begin() + (std::ptrdiff_t)std::min(z.size(), p + step)));
+    chunk(png, "IEND", {});
+    return png;
+}
+
+void runCase(const Case& c, uint32_t seed) {
+    Rng rng{seed};
+    const Image im = makeImage(c, rng);
+    const Bytes png = encodePng(c, im);
+
+    PixelBuffer buf;
+    std::string err;
+    if (!decodeImageMemory(png.data(), png.size(), buf, &err)) {
+        check(false, c.name + ": decode failed: " + err);
+        return;
+    }
+    if (buf.width != c.width || buf.height != c.height) {
+        check(false, c.name + ": size " + std::to_string(buf.width) + "x" + std::to_string(buf.height));
+        return;
+    }
+    for (std::size_t px = 0; px < (std::size_t)c.width * c.height; px++) {
+        uint8_t want[4];
+        expectedPixel(c, im, px, want);
+        if (!std::equal(want, want + 4, buf.rgba.data() + px * 4)) {
+            check(false, c.name + ": pixel (" + std::to_string(px % c.width) + ", " + std::to_string(px / c.width) +
+                             ") differs");
+            return;
+        }
+    }
+}
+
+std::string modeName(BlockMode m) {
+    switch (m) {
+    case BlockMode::Stored: return "stored";
+    case BlockMode::Fixed: return "fixed";
+    case BlockMode::Dynamic: return "dynamic";
+    default: return "mixed";
+    }
+}
+
+void roundTrips() {
+    struct Format { int colorType, depth; };
+    const Format formats[] = {{0, 1}, {0, 2}, {0, 4}, {0, 8}, {0, 16}, {2, 8}, {2, 16}, {3, 1}, {3, 2},
+                              {3, 4}, {3, 8}, {4, 8}, {4, 16}, {6, 8}, {6, 16}};
+    uint32_t seed = 1;
+    int cases = 0;
+    for (const Format& f : formats) {
+        const std::string fmt = "ct" + std::to_string(f.colorType) + "/" + std::to_string(f.depth) + "bit";
+        Case c;
+        c.colorType = f.colorType;
+        c.depth = f.depth;
+
+        for (int filter = -1; filter <= 4; filter++) {
+            c.filter = filter;
+            c.name = fmt + " filter " + (filter < 0 ? std::string("mixed") : std::to_string(filter));
+            runCase(c, seed++), cases++;
+        }
+        c.filter = -1;
+        for (BlockMode m : {BlockMode::Stored, BlockMode::Fixed, BlockMode::Dynamic}) {
+            c.mode = m;
+            c.blockBytes = 1 << 20;   // one block for the whole stream
+            c.name = fmt + " " + modeName(m) + " only";
+            runCase(c, seed++), cases++;
+        }
+        c.mode = BlockMode::Mixed;
+        c.blockBytes = 97;
+
+        // odd sizes leave Adam7 passes empty or one pixel wide
+        for (int wh : {1, 5, 37}) {
+            Case a = c;
+            a.adam7 = true;
+            a.width = wh;
+            a.height = wh == 37 ? 29 : wh;
+            a.name = fmt + " adam7 " + std::to_string(a.width) + "x" + std::to_string(a.height);
+            runCase(a, seed++), cases++;
+        }
+
+        Case big = c;
+        big.width = 211;
+        big.height = 45;
+        big.idatBytes = 1000;
+        big.blockBytes = 4096;
+        big.name = fmt + " 211x45 split IDAT";
+        runCase(big, seed++), cases++;
+
+        if (f.colorType == 0 || f.colorType == 2) {
+            Case k = c;
+            k.key = true;
+            k.name = fmt + " tRNS key";
+            runCase(k, seed++), cases++;
+        }
+        if (f.colorType == 3) {
+            Case p = c;
+            p.paletteSize = std::max(2, (1 << f.depth) - 3);   // indices past it decode to opaque black: not generated
+            p.paletteAlpha = std::min(p.paletteSize, 3);
+            p.name = fmt + " short palette + tRNS";
+            runCase(p, seed++), cases++;
+        }
+    }
+    std::cout << cases << " round trips\n";
+}
+
+// Broken streams fail with an error instead of crashing or reading past the end.
+void brokenStreams() {
+    Case c;
+    c.name = "base";
+    Rng rng{99};
+    const Image im = makeImage(c, rng);
+    const Bytes good = encodePng(c, im);
+    PixelBuffer buf;
+    std::string err;
+    check(decodeImageMemory(good.data(), good.size(), buf, &err), "broken: base image decodes");
+
+    // filter type 5
+    {
+        Bytes raw;
+        appendScanlines(c, im, 0, 0, 1, 1, raw);
+        raw[0] = 5;
+        Bytes png(good.begin(), good.begin() + 8 + 25);   // signature + IHDR
+        chunk(png, "IDAT", zlibWrap(raw, BlockMode::Dynamic, 1 << 20));
+        chunk(png, "IEND", {});
+        check(!decodeImageMemory(png.data(), png.size(), buf, &err) && err == "bad PNG filter type",
+              "broken: filter type 5 rejected (" + err + ")");
+    }
+    // deflate stream cut short, the rest of the file still there
+    {
+        Bytes raw;
+        appendScanlines(c, im, 0, 0, 1, 1, raw);
+        Bytes z = zlibWrap(raw, BlockMode::Dynamic, 1 << 20);
+        z.resize(z.size() / 2);
+        Bytes png(good.begin(), good.begin() + 8 + 25);
+        chunk(png, "IDAT", z);
+        chunk(png, "IEND", {});
+        check(!decodeImageMemory(png.data(), png.size(), buf, &err), "broken: truncated deflate rejected");
+    }
+    // more image data than the header allows
+    {
+        Case wide = c;
+        wide.height = c.height + 3;
+        Rng r2{7};
+        const Image im2 = makeImage(wide, r2);
+        Bytes raw;
+        appendScanlines(wide, im2, 0, 0, 1, 1, raw);
+        Bytes png(good.begin(), good.begin() + 8 + 25);
+        chunk(png, "IDAT", zlibWrap(raw, BlockMode::Fixed, 1 << 20));
+        chunk(png, "IEND", {});
+        check(!decodeImageMemory(png.data(), png.size(), buf, &err), "broken: oversized image data rejected");
+    }
+    // file cut in the middle of a chunk
+    {
+        Bytes png(good.begin(), good.begin() + (std::ptrdiff_t)(good.size() - 20));
+        check(!decodeImageMemory(png.data(), png.size(), buf, &err), "broken: truncated file rejected");
+    }
+}
+
+uint64_t fnv1a(const std::vector<unsigned char>& b) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (unsigned char x : b) h = (h ^ x) * 0x100000001b3ull;
+    return h;
+}
+
+// Digests of the decoded RGBA8, from Python's zlib and a by-the-spec unfilter.
+void bundledCharts(const std::string& dir) {
+    struct Known { const char* file; int w, h; uint64_t digest; };
+    const Known known[] = {{"test1.png", 1148, 1382, 0x105bd1b41820dfd8ull}};
+    for (const Known& k : known) {
+        const std::string path = dir + "/" + k.file;
+        PixelBuffer buf;
+        std::string err;
+        if (!decodeImageFile(path, buf, &err)) {
+            check(false, path + ": " + err);
+            continue;
+        }
+        check(buf.width == k.w && buf.height == k.h, path + ": size");
+        check(fnv1a(buf.rgba) == k.digest, path + ": pixels differ from the reference decode");
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    roundTrips();
+    brokenStreams();
+    bundledCharts(argc > 1 ? argv[1] : "assets/charts");
+    std::cout << (g_failures ? std::to_string(g_failures) + " failed" : std::string("all passed")) << "\n";
+    return g_failures;
+}
@@ -0,0 +1,103 @@
+// ===============================
+// File: kernel_bench_main.cpp
+// stockpredict_kernel_bench — generic vs theme-specialized extraction scans
+// (ExtractKernels.h) on the same charts. Checks both give the same series, then
+// times each close / volume scan on the legacy layout.
+//   stockpredict_kernel_bench [--iters 300] [--stride 1] [--bgra] [chart ...]
+// Charts default to assets/charts/test1.png; they should use the default theme.
+// ===============================
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ChartLayout.h"
+#include "ExtractKernels.h"
+#include "ImageDecode.h"
+
+template <class Fn>
+static double bestMs(int iters, Fn&& fn) {
+    // best of 5 batches: least disturbed by whatever else the machine is doing
+    double best = 1e30;
+    for (int batch = 0; batch < 5; batch++) {
+        const auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < iters; i++) fn();
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        best = std::min(best, ms / iters);
+    }
+    return best;
+}
+
+static void report(const char* what, double generic, double special) {
+    std::cout << "  " << std::left << std::setw(7) << what << std::right << std::fixed << std::setprecision(3)
+              << " generic " << generic << " ms  specialized " << special << " ms  x" << std::setprecision(2)
+              << (special > 0.0 ? generic / special : 0.0) << "\n";
+}
+
+int main(int argc, char** argv) {
+    int iters = 300, stride = 1;
+    bool bgra = false;
+    std::vector<std::string> charts;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : ""; };
+        if (a == "--iters") iters = std::max(1, std::atoi(next()));
+        else if (a == "--stride") stride = std::max(1, std::atoi(next()));
+        else if (a == "--bgra") bgra = true;
+        else if (!a.empty() && a[0] == '-') {
+            std::cerr << "usage: stockpredict_kernel_bench [--iters N] [--stride N] [--bgra] [chart ...]\n";
+            return 2;
+        } else {
+            charts.push_back(a);
+        }
+    }
+    if (charts.empty()) charts.push_back("assets/charts/test1.png");
+
+    const DynamicColors candles{DefaultTheme::bull, DefaultTheme::bear, DefaultTheme::tolerance};
+    const DynamicColors volume{DefaultTheme::volUp, DefaultTheme::volDown, DefaultTheme::volTolerance};
+    const ThemeColors<DefaultTheme> candlesT;
+    const ThemeVolumeColors<DefaultTheme> volumeT;
+
+    int mismatches = 0;
+    for (const std::string& path : charts) {
+        PixelBuffer buf;
+        std::string err;
+        if (!decodeImageFile(path, buf, &err)) {
+            std::cerr << path << ": " << err << "\n";
+            return 1;
+        }
+        ImageView img = buf.view();
+        std::vector<unsigned char> swapped;
+        if (bgra) {
+            swapped.assign(img.data, img.data + img.stride * (std::size_t)img.height);
+            for (std::size_t i = 0; i < swapped.size(); i += 4) std::swap(swapped[i], swapped[i + 2]);
+            img = ImageView(swapped.data(), img.width, img.height, img.stride, PixelFormat::BGRA8);
+        }
+
+        const ChartLayout L = legacyChartLayout(img.width, img.height);
+        const PixelRect plot{std::max(0, L.plot.x0), std::max(0, L.plot.y0), std::min(img.width, L.plot.x1),
+                             std::min(img.height, L.plot.y1)};
+        const PixelRect vol{plot.x0, std::max(0, L.volume.y0), plot.x1, std::min(img.height, L.volume.y1)};
+
+        std::vector<int> work;
+        std::vector<float> a, b;
+        scanClose(img, plot, stride, candles, work, a);
+        scanClose(img, plot, stride, candlesT, work, b);
+        const bool closeSame = a == b;
+        scanVolume(img, vol, stride, volume, work, a);
+        scanVolume(img, vol, stride, volumeT, work, b);
+        const bool volSame = a == b;
+        mismatches += !closeSame + !volSame;
+
+        std::cout << path << " (" << img.width << "x" << img.height << (bgra ? " BGRA" : " RGBA") << ", stride "
+                  << stride << ")" << (closeSame && volSame ? "" : "  OUTPUT MISMATCH") << "\n";
+        report("close", bestMs(iters, [&] { scanClose(img, plot, stride, candles, work, a); }),
+               bestMs(iters, [&] { scanClose(img, plot, stride, candlesT, work, b); }));
+        report("volume", bestMs(iters, [&] { scanVolume(img, vol, stride, volume, work, a); }),
+               bestMs(iters, [&] { scanVolume(img, vol, stride, volumeT, work, b); }));
+    }
+    return mismatches ? 1 : 0;
+}
@@ -1,11 +1,25 @@
 // ===============================
 // File: main.cpp
 // Clean SFML GUI (single TF + multi-TF option) + REAL-TIME CLOCK
+// Redraws only when something changed (keys, clock minute, new dashboard
+// results); idle it sleeps between polls.
 // Keys:
 //   1/5/3 load charts
 //   P = predict current TF
 //   M = multi-timeframe predict (test1/test5/test30)
+//   O = toggle overlay of what the predictor extracted (series, swings, levels, plan)
+//   D = toggle watchlist dashboard (every chart in assets/charts, see Dashboard.h)
 //   ESC = quit
+// Headless (same as stockpredict_watch, which builds without SFML):
+//   StockPredictGUI --watch <dir> [--threads N] [--preview K]   predict PNGs as they land in <dir>
+// GUI:
+//   StockPredictGUI --dashboard [dir]             start in the dashboard view
+// Both:
+//   --config <file>   predictor settings (PredictorConfig.h), reloaded when the file changes;
+//                     layout = auto there turns on per-chart layout detection,
+//                     series = candles one point per candle instead of per column
+// Env:
+//   STOCKPREDICT_TRACE=trace.json  record a Chrome/Perfetto trace, written on exit
 // ===============================
 #include <SFML/Graphics.hpp>
 #include <iostream>
@@ -13,14 +27,26 @@
 #include <vector>
 #include <sstream>
 #include <iomanip>
-#include <regex>
-#include <chrono>
-#include <ctime>
-
+#include <map>
+#include <cstdlib>
+#include <memory>
+
+#include "ChartCache.h"
+#include "ChartMeta.h"
+#include "ChartOverlay.h"
+#include "ChartWatcher.h"
+#include "Dashboard.h"
 #include "Predictor.h"
+#include "PredictorConfig.h"
+#include "Trace.h"
 
+// Hits are remembered: hotkeys ask for the same few paths again and again.
+// GUI thread only.
 static std::string findAsset(const std::string& relPath) {
     namespace fs = std::filesystem;
+    static std::map<std::string, std::string> resolved;
+    auto hit = resolved.find(relPath);
+    if (hit != resolved.end()) return hit->second;
     std::vector<fs::path> bases = {
         fs::current_path(),
         fs::current_path() / "..",
@@ -29,17 +55,31 @@ static std::string findAsset(const std::string& relPath) {
     };
     for (const auto& base : bases) {
         fs::path candidate = base / relPath;
-        if (fs::exists(candidate)) return candidate.string();
+        if (fs::exists(candidate)) return resolved[relPath] = candidate.string();
     }
     return "";
 }
 
-static bool loadChart(const std::string& path, sf::Texture& tex, sf::Sprite& sprite) {
-    if (!tex.loadFromFile(path)) return false;
+static const char* const kHotkeyCharts[] = {
+    "assets/charts/test1.png", "assets/charts/test5.png", "assets/charts/test30.png",
+};
+
+static void placeChart(const sf::Texture& tex, sf::Sprite& sprite) {
     sprite.setTexture(tex, true);
     sprite.setScale(0.5f, 0.5f);
     sprite.setPosition(450.f, 50.f);
-    return true;
+}
+
+// SFML 2 has no waitEvent(timeout): poll in short sleeps so keys still feel
+// instant while an idle window costs next to nothing.
+static bool waitEventFor(sf::RenderWindow& window, sf::Event& event, sf::Time timeout) {
+    sf::Clock waited;
+    for (;;) {
+        if (window.pollEvent(event)) return true;
+        const sf::Int32 left = timeout.asMilliseconds() - waited.getElapsedTime().asMilliseconds();
+        if (left <= 0) return false;
+        sf::sleep(sf::milliseconds(std::min<sf::Int32>(left, 10)));
+    }
 }
 
 static std::string levelsToString(const std::vector<double>& lv) {
@@ -53,54 +93,69 @@ static std::string levelsToString(const std::vector<double>& lv) {
     return oss.str();
 }
 
-struct ChartMeta {
-    int tfMin = -1;                 // 1, 5, 30
-    bool hasScale = false;
-    double minPrice = 0.0;          // bottom of chart
-    double maxPrice = 0.0;          // top of chart
-};
+int main(int argc, char** argv) {
+    // Opt-in tracing of every predictor stage (see Trace.h)
+    const char* tracePath = std::getenv("STOCKPREDICT_TRACE");
+    if (tracePath && *tracePath) {
+        trace::enable();
+        trace::setThreadName("main");
+    }
 
-// Supports: XRP_1m_2.0325_2.0697.png  OR  test1.png (no scale)
-static ChartMeta parseMetaFromFilename(const std::string& imagePath) {
-    ChartMeta meta;
-
-    // timeframe
-    if (imagePath.find("test30") != std::string::npos || imagePath.find("_30m") != std::string::npos) meta.tfMin = 30;
-    else if (imagePath.find("test5") != std::string::npos || imagePath.find("_5m") != std::string::npos) meta.tfMin = 5;
-    else if (imagePath.find("test1") != std::string::npos || imagePath.find("_1m") != std::string::npos) meta.tfMin = 1;
-
-    // scale parse: ..._MIN_MAX.png
-    std::regex re(R"(_([0-9]+(?:\.[0-9]+)?)_([0-9]+(?:\.[0-9]+)?)\.png$)");
-    std::smatch m;
-    if (std::regex_search(imagePath, m, re) && m.size() == 3) {
-        meta.minPrice = std::stod(m[1].str());
-        meta.maxPrice = std::stod(m[2].str());
-        if (meta.maxPrice > meta.minPrice) meta.hasScale = true;
+    std::string watchDir;
+    int watchThreads = 2;
+    int previewStride = 0;
+    bool startDashboard = false;
+    std::string dashboardDir;
+    std::string configPath;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if (a == "--watch" && i + 1 < argc) watchDir = argv[++i];
+        else if (a == "--dashboard") {
+            startDashboard = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') dashboardDir = argv[++i];
+        }
+        else if (a == "--threads" && i + 1 < argc) watchThreads = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--preview" && i + 1 < argc) previewStride = std::max(0, std::atoi(argv[++i]));
+        else if (a == "--config" && i + 1 < argc) configPath = argv[++i];
     }
 
-    return meta;
-}
+    // Predictors (and the copies workers make) pick up edits to the file on their next prediction
+    std::shared_ptr<ConfigStore> configStore;
+    std::unique_ptr<ConfigWatcher> configWatcher;
+    if (!configPath.empty()) {
+        configStore = std::make_shared<ConfigStore>();
+        configWatcher = std::make_unique<ConfigWatcher>(configStore, configPath, 500,
+            [](bool ok, const std::string& msg) { (ok ? std::cout : std::cerr) << "config: " << msg << std::endl; });
+        std::string err;
+        if (!configWatcher->start(&err)) return 1;   // callback already printed why
+    }
 
-static std::string nowHHMM() {
-    using namespace std::chrono;
-    auto now = system_clock::now();
-    std::time_t t = system_clock::to_time_t(now);
+    if (!watchDir.empty()) {
+        WatchOptions opt;
+        opt.workers = watchThreads;
+        opt.previewStride = previewStride;
+        int rc = runWatchMode(watchDir, opt, configStore);
+        if (trace::enabled()) trace::writeChromeJson(tracePath);
+        return rc;
+    }
 
-    std::tm local{};
-#if defined(_WIN32)
-    localtime_s(&local, &t);
-#else
-    local = *std::localtime(&t);
-#endif
+    std::string chartPath = findAsset(kHotkeyCharts[0]);
+    if (chartPath.empty()) {
+        std::cerr << "Missing " << kHotkeyCharts[0] << "\n";
+        return 1;
+    }
 
-    std::ostringstream oss;
-    oss << std::setw(2) << std::setfill('0') << local.tm_hour
-        << ":"
-        << std::setw(2) << std::setfill('0') << local.tm_min;
-    return oss.str();
-}
+    // The hotkey charts decode on the cache thread while the window and font
+    // come up; the first frame does not wait for them.
+    ChartCache charts;
+    auto prefetchHotkeyCharts = [&]() {
+        for (const char* rel : kHotkeyCharts) {
+            const std::string p = findAsset(rel);
+            if (!p.empty()) charts.prefetch(p);
+        }
+    };
+    prefetchHotkeyCharts();
 
-int main() {
     sf::RenderWindow window(sf::VideoMode(1000, 750), "C++ Stock Predictor");
     window.setFramerateLimit(60);
 
@@ -111,23 +166,18 @@ int main() {
         return 1;
     }
 
-    std::string chartPath = findAsset("assets/charts/test1.png");
-
-    if (chartPath.empty()) {
-        std::cerr << "Missing assets/charts/test1.png\n";
-
-        return 1;
-    }
-
-    sf::Texture chartTexture;
-    sf::Sprite  chartSprite;
-    if (!loadChart(chartPath, chartTexture, chartSprite)) {
-        std::cerr << "Failed to load chart image\n";
-        return 1;
-    }
+    std::shared_ptr<const ChartCache::Chart> chart;   // on screen; null until the first one decodes
+    sf::Sprite chartSprite;
+    std::string pendingChart = chartPath;              // asked for, not on screen yet
+    bool announceChart = false;                        // say so in resultText when it lands
 
     Predictor predictor;
     predictor.setConfidenceThreshold(60.0);
+    predictor.setCaptureOverlay(true);
+    if (configStore) predictor.setConfigStore(configStore);
+
+    ChartOverlay chartOverlay;   // rebuilt per single-TF result, cleared on chart switch
+    bool showOverlay = true;
 
     ChartMeta meta = parseMetaFromFilename(chartPath);
     int currentTF = meta.tfMin;
@@ -145,6 +195,7 @@ int main() {
         "  1 = Load test1 (1m)\n"
         "  5 = Load test5 (5m)\n"
         "  3 = Load test30 (30m)\n"
+        "  O = Toggle overlay    D = Watchlist dashboard\n"
         "  ESC = Quit",
         font, 13
     );
@@ -161,7 +212,8 @@ int main() {
 
     auto updateStatus = [&]() {
         std::ostringstream oss;
-        oss << "Loaded: " << std::filesystem::path(chartPath).filename().string()
+        oss << (pendingChart.empty() ? "Loaded: " : "Loading: ")
+            << std::filesystem::path(pendingChart.empty() ? chartPath : pendingChart).filename().string()
             << "\nTimeframe: " << currentTF << "m"
             << "\nLocal time: " << currentTimeStr;
 
@@ -176,21 +228,44 @@ int main() {
 
     updateStatus();
 
+    // Puts pendingChart on screen once the cache has it; false while it is
+    // still decoding (the main loop asks again).
+    auto showPendingChart = [&]() -> bool {
+        std::shared_ptr<const ChartCache::Chart> next;
+        std::string err;
+        const ChartCache::State st = charts.poll(pendingChart, next, &err);
+        if (st == ChartCache::State::Pending) return false;
+        if (st == ChartCache::State::Failed) {
+            resultText.setString("Error: failed loading " + pendingChart + (err.empty() ? "" : " (" + err + ")"));
+            pendingChart.clear();
+            updateStatus();
+            return true;
+        }
+        chart = std::move(next);
+        placeChart(chart->texture, chartSprite);
+        chartPath = chart->path;
+        chartOverlay.clear();
+        meta = chart->meta;
+        currentTF = meta.tfMin;
+        pendingChart.clear();
+        updateStatus();
+        if (announceChart) resultText.setString("Switched chart. Press P to Predict.");
+        prefetchHotkeyCharts();   // re-queue any the cache has dropped since
+        return true;
+    };
+
     auto switchChart = [&](const std::string& rel) {
         std::string newPath = findAsset(rel);
         if (newPath.empty()) {
             resultText.setString("Error: missing " + rel);
             return;
         }
-        if (!loadChart(newPath, chartTexture, chartSprite)) {
-            resultText.setString("Error: failed loading " + rel);
-            return;
+        pendingChart = newPath;
+        announceChart = true;
+        if (!showPendingChart()) {
+            updateStatus();
+            resultText.setString("Loading " + rel + "...");
         }
-        chartPath = newPath;
-        meta = parseMetaFromFilename(chartPath);
-        currentTF = meta.tfMin;
-        updateStatus();
-        resultText.setString("Switched chart. Press P to Predict.");
     };
 
     auto renderPrediction = [&](const Prediction& pred, const std::string& header) {
@@ -231,8 +306,10 @@ int main() {
             << "\n  trend:    " << std::fixed << std::setprecision(2) << pred.breakdown.trendScore
             << "\n  momentum: " << std::fixed << std::setprecision(2) << pred.breakdown.momentumScore
             << "\n  reversal: " << std::fixed << std::setprecision(2) << pred.breakdown.reversalScore
-            << "\n  sr:       " << std::fixed << std::setprecision(2) << pred.breakdown.srScore
-            << "\n  raw:      " << std::fixed << std::setprecision(2) << pred.breakdown.rawScore;
+            << "\n  sr:       " << std::fixed << std::setprecision(2) << pred.breakdown.srScore;
+        if (pred.breakdown.indicatorScore != 0.0)
+            oss << "\n  indic.:   " << std::fixed << std::setprecision(2) << pred.breakdown.indicatorScore;
+        oss << "\n  raw:      " << std::fixed << std::setprecision(2) << pred.breakdown.rawScore;
 
         if (!pred.breakdown.patterns.empty()) {
             oss << "\n  patterns: ";
@@ -252,6 +329,106 @@ int main() {
         resultText.setString(oss.str());
     };
 
+    // Watchlist dashboard: created on first use, keeps refreshing in the background after that
+    std::unique_ptr<Dashboard> dashboard;
+    bool showDashboard = false;
+    sf::Text dashboardStatus("", font, 13);
+    dashboardStatus.setPosition(20.f, 62.f);
+
+    auto toggleDashboard = [&]() {
+        if (!dashboard) {
+            DashboardOptions opt;
+            opt.dir = dashboardDir.empty() ? findAsset("assets/charts") : dashboardDir;
+            auto d = std::make_unique<Dashboard>(predictor, font, opt);
+            std::string err;
+            if (!d->start(&err)) {
+                resultText.setString("Dashboard: " + err);
+                return;
+            }
+            d->setBounds(sf::FloatRect(20.f, 90.f, 960.f, 645.f));
+            dashboard = std::move(d);
+        }
+        showDashboard = !showDashboard;
+    };
+    if (startDashboard) toggleDashboard();
+
+    // Retained rendering: the single-chart screen (texts + sprite) is drawn into
+    // sceneCache only when something on it changes; a frame is presented only when
+    // dirty. Idle, the loop just sleeps between polls.
+    sf::RenderTexture sceneCache;
+    const bool haveSceneCache = sceneCache.create(window.getSize().x, window.getSize().y);
+    bool sceneDirty = true;   // sceneCache content is stale
+    bool frameDirty = true;   // window needs a new frame
+
+    auto drawScene = [&](sf::RenderTarget& target) {
+        target.clear(sf::Color(25, 25, 25));
+        target.draw(title);
+        target.draw(instructions);
+        target.draw(statusText);
+        target.draw(resultText);
+        target.draw(chartSprite);
+        if (showOverlay) chartOverlay.draw(target);
+    };
+
+    auto handleEvent = [&](const sf::Event& event) {
+        if (event.type == sf::Event::Closed) window.close();
+        if (event.type == sf::Event::Resized || event.type == sf::Event::GainedFocus) frameDirty = true;
+
+        if (event.type == sf::Event::KeyPressed) {
+            // every hotkey changes some text; cheaper to re-render once than to track which
+            sceneDirty = true;
+            frameDirty = true;
+
+            if (event.key.code == sf::Keyboard::Escape) window.close();
+
+            if (event.key.code == sf::Keyboard::D) toggleDashboard();
+            if (event.key.code == sf::Keyboard::O) showOverlay = !showOverlay;
+
+            if (event.key.code == sf::Keyboard::Num1) switchChart(kHotkeyCharts[0]);
+            if (event.key.code == sf::Keyboard::Num5) switchChart(kHotkeyCharts[1]);
+            if (event.key.code == sf::Keyboard::Num3) switchChart(kHotkeyCharts[2]);
+
+
+            if (event.key.code == sf::Keyboard::P && !chart) {
+                resultText.setString("Chart still loading...");
+            } else if (event.key.code == sf::Keyboard::P) {
+                try {
+                    // the decoded pixels on screen, scored in place; tf -1 = the
+                    // base weights, same as predictWithTime(path, ...)
+                    Prediction pred = predictor.predictImage(
+                        chart->pixels.view(), currentTimeStr, -1,
+                        meta.hasScale, meta.minPrice, meta.maxPrice
+                    );
+                    renderPrediction(pred, "Single-timeframe");
+                    chartOverlay.build(pred.overlay, chartSprite.getGlobalBounds());
+                } catch (const std::exception& e) {
+                    resultText.setString(std::string("Error: ") + e.what());
+                }
+            }
+
+            if (event.key.code == sf::Keyboard::M) {
+                try {
+                    std::string p1  = findAsset(kHotkeyCharts[0]);
+                    std::string p5  = findAsset(kHotkeyCharts[1]);
+                    std::string p30 = findAsset(kHotkeyCharts[2]);
+
+
+                    if (p1.empty() || p5.empty() || p30.empty()) {
+                        // one screenshot holds too few candles to roll up into a
+                        // 30m view (predictMultiTimeframeFromBase)
+                        resultText.setString("Error: missing test1/test5/test30 images");
+                    } else {
+                        Prediction pred = predictor.predictMultiTimeframe(p1, p5, p30, currentTimeStr);
+                        renderPrediction(pred, "Multi-timeframe (1m/5m/30m)");
+                        chartOverlay.clear();   // fused result is not from the chart on screen
+                    }
+                } catch (const std::exception& e) {
+                    resultText.setString(std::string("Error: ") + e.what());
+                }
+            }
+        }
+    };
+
     // Clock to refresh time string
     sf::Clock realtimeClock;
     std::string lastHHMM = currentTimeStr;
@@ -264,60 +441,62 @@ int main() {
             if (currentTimeStr != lastHHMM) {
                 lastHHMM = currentTimeStr;
                 updateStatus();
+                sceneDirty = true;
             }
         }
 
+        if (!pendingChart.empty() && showPendingChart()) sceneDirty = true;
+
+        // Nothing to draw: block for input. The dashboard view and a chart still
+        // decoding wake at frame rate; the plain view only for the clock.
         sf::Event event{};
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) window.close();
-
-            if (event.type == sf::Event::KeyPressed) {
-                if (event.key.code == sf::Keyboard::Escape) window.close();
-
-                if (event.key.code == sf::Keyboard::Num1) switchChart("assets/charts/test1.png");
-                if (event.key.code == sf::Keyboard::Num5) switchChart("assets/charts/test5.png");
-                if (event.key.code == sf::Keyboard::Num3) switchChart("assets/charts/test30.png");
-
-
-                if (event.key.code == sf::Keyboard::P) {
-                    try {
-                        Prediction pred = predictor.predictWithTime(
-                            chartPath, currentTimeStr,
-                            meta.hasScale, meta.minPrice, meta.maxPrice
-                        );
-                        renderPrediction(pred, "Single-timeframe");
-                    } catch (const std::exception& e) {
-                        resultText.setString(std::string("Error: ") + e.what());
-                    }
-                }
+        if (!frameDirty && (showDashboard || !sceneDirty)) {
+            const bool busy = showDashboard || !pendingChart.empty();
+            const sf::Time idle = busy ? sf::milliseconds(16) : sf::milliseconds(250);
+            if (waitEventFor(window, event, idle)) handleEvent(event);
+        }
+        while (window.pollEvent(event)) handleEvent(event);
+        if (!window.isOpen()) break;
+
+        if (showDashboard) {
+            if (dashboard->update()) frameDirty = true;
+            if (frameDirty) {
+                std::ostringstream oss;
+                oss << dashboard->scored() << "/" << dashboard->size() << " charts scored  |  D = back";
+                dashboardStatus.setString(oss.str());
+                window.clear(sf::Color(25, 25, 25));
+                window.draw(title);
+                window.draw(dashboardStatus);
+                dashboard->draw(window);
+                window.display();
+            }
+            frameDirty = false;   // sceneDirty stays set until the chart screen is shown again
+            continue;
+        }
 
-                if (event.key.code == sf::Keyboard::M) {
-                    try {
-                        std::string p1  = findAsset("assets/charts/test1.png");
-                        std::string p5  = findAsset("assets/charts/test5.png");
-                        std::string p30 = findAsset("assets/charts/test30.png");
-
-
-                        if (p1.empty() || p5.empty() || p30.empty()) {
-                            resultText.setString("Error: missing test1/test5/test30 images");
-                        } else {
-                            Prediction pred = predictor.predictMultiTimeframe(p1, p5, p30, currentTimeStr);
-                            renderPrediction(pred, "Multi-timeframe (1m/5m/30m)");
-                        }
-                    } catch (const std::exception& e) {
-                        resultText.setString(std::string("Error: ") + e.what());
-                    }
-                }
+        if (sceneDirty) {
+            if (haveSceneCache) {
+                drawScene(sceneCache);
+                sceneCache.display();
             }
+            sceneDirty = false;
+            frameDirty = true;
         }
+        if (frameDirty) {
+            if (haveSceneCache) {
+                window.clear(sf::Color(25, 25, 25));
+                window.draw(sf::Sprite(sceneCache.getTexture()));
+            } else {
+                drawScene(window);
+            }
+            window.display();
+            frameDirty = false;
+        }
+    }
 
-        window.clear(sf::Color(25, 25, 25));
-        window.draw(title);
-        window.draw(instructions);
-        window.draw(statusText);
-        window.draw(resultText);
-        window.draw(chartSprite);
-        window.display();
+    if (trace::enabled()) {
+        if (trace::writeChromeJson(tracePath)) std::cout << "Trace written to " << tracePath << "\n";
+        else std::cerr << "Failed to write trace to " << tracePath << "\n";
     }
 
     return 0;
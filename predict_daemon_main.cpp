@@ -0,0 +1,79 @@
+// ===============================
+// File: predict_daemon_main.cpp
+// stockpredictd — keeps a warm Predictor pool behind a Unix socket.
+//   stockpredictd [--socket /tmp/stockpredictd.sock] [--workers N] [--batch N] [--window-us N]
+//                 [--config file]   (PredictorConfig.h; edits apply to the next request, no restart)
+// Env:
+//   STOCKPREDICT_TRACE=trace.json  record a Chrome/Perfetto trace, written on exit
+// ===============================
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "PredictDaemon.h"
+#include "PredictorConfig.h"
+#include "Trace.h"
+
+static std::atomic<bool> g_quit{false};
+
+static void onQuitSignal(int) { g_quit.store(true); }
+
+int main(int argc, char** argv) {
+    DaemonOptions opt;
+    std::string configPath;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : ""; };
+        if (a == "--socket") opt.socketPath = next();
+        else if (a == "--workers") opt.workers = std::atoi(next());
+        else if (a == "--batch") opt.maxBatch = std::atoi(next());
+        else if (a == "--window-us") opt.batchWindowUs = std::atoi(next());
+        else if (a == "--config") configPath = next();
+        else {
+            std::cerr << "usage: stockpredictd [--socket path] [--workers N] [--batch N] [--window-us N]"
+                         " [--config file]\n";
+            return 2;
+        }
+    }
+
+    const char* tracePath = std::getenv("STOCKPREDICT_TRACE");
+    if (tracePath && *tracePath) trace::enable();
+
+    Predictor predictor;
+    predictor.setConfidenceThreshold(60.0);
+
+    // the workers' copies follow the same store
+    std::unique_ptr<ConfigWatcher> configWatcher;
+    if (!configPath.empty()) {
+        auto store = std::make_shared<ConfigStore>();
+        configWatcher = std::make_unique<ConfigWatcher>(store, configPath, 500,
+            [](bool ok, const std::string& msg) { (ok ? std::cout : std::cerr) << "stockpredictd config: " << msg << std::endl; });
+        if (!configWatcher->start()) return 1;   // callback already printed why
+        predictor.setConfigStore(store);
+    }
+
+    PredictDaemon daemon(predictor, opt);
+    std::string err;
+    if (!daemon.start(&err)) {
+        std::cerr << "stockpredictd: " << err << "\n";
+        return 1;
+    }
+    std::cout << "stockpredictd listening on " << opt.socketPath << std::endl;
+
+    std::signal(SIGINT, onQuitSignal);
+    std::signal(SIGTERM, onQuitSignal);
+    while (!g_quit.load()) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    daemon.stop();
+    DaemonStats st = daemon.stats();
+    std::cout << "served " << st.requests << " requests in " << st.batches << " batches ("
+              << st.deduped << " deduped, " << st.errors << " errors)\n";
+
+    if (tracePath && *tracePath) trace::writeChromeJson(tracePath);
+    return 0;
+}
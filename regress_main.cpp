@@ -0,0 +1,418 @@
+// ===============================
+// File: regress_main.cpp
+// stockpredict_regress — end-to-end throughput/latency regression harness.
+// Runs predictWithTime over every chart and predictMultiTimeframe over 1m/5m/30m
+// triples, at 1, 2, 4 .. N threads, on the real charts in --charts plus
+// --generate synthetic ones (deterministic, written as PPM into --work).
+// Reports charts/sec (total and per core), p50/p99 latency, scaling efficiency
+// and peak RSS, plus a digest of every prediction.
+//   stockpredict_regress [--charts assets/charts] [--generate 24] [--work dir]
+//                        [--threads N] [--passes 3]
+//                        [--save-baseline b.json] [--baseline b.json [--tolerance 0.10] [--outputs-only]]
+// With --baseline: exit 1 if throughput drops / p99 or RSS grow by more than the
+// tolerance, or if any prediction differs from the baseline's. --outputs-only
+// compares the predictions alone (timings from another machine mean nothing).
+//
+// regress_baseline.json (next to this file) is the committed baseline: the
+// default corpus (assets/charts + --generate 24), timings from a 1-core
+// reference run. ctest runs it as regress_outputs (--outputs-only, one pass,
+// one thread), so CI checks predictions on every build. After an intended
+// output change, or to gate timings on your own machine, rewrite it with
+//   stockpredict_regress --save-baseline regress_baseline.json
+// Peak RSS needs getrusage (POSIX); elsewhere it reads 0 and is not compared.
+// ===============================
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#define STOCKPREDICT_HAVE_RUSAGE 1
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ChartMeta.h"
+#include "Predictor.h"
+
+namespace fs = std::filesystem;
+
+static const char* kTimeStr = "10:30";   // fixed so outputs are comparable run to run
+
+struct Job {
+    std::string name;                    // key in the digest map
+    std::vector<std::string> paths;      // 1 = single chart, 3 = 1m/5m/30m
+    int tfMinutes = -1;
+};
+
+struct RunStats {
+    std::string workload;
+    int threads = 1;
+    double chartsPerSec = 0.0;
+    double perCore = 0.0;
+    double p50Ms = 0.0;
+    double p99Ms = 0.0;
+    double efficiency = 1.0;             // throughput / (threads * 1-thread throughput)
+};
+
+// ---------- synthetic charts ----------
+
+// Random-walk candles in the default colours on the legacy layout (plot 10..75%,
+// volume 74..89%), so the default Predictor reads them like the real ones.
+static bool writeSyntheticChart(const std::string& path, uint32_t seed, int W, int H) {
+    std::vector<unsigned char> rgb((std::size_t)W * H * 3, 20);
+    uint64_t state = 0x9E3779B97F4A7C15ull * (seed + 1);
+    auto rnd = [&]() {   // uniform 0..1
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return (double)(state >> 11) / (double)(1ull << 53);
+    };
+    auto put = [&](int x, int y, unsigned char r, unsigned char g, unsigned char b) {
+        if (x < 0 || y < 0 || x >= W || y >= H) return;
+        unsigned char* p = &rgb[((std::size_t)y * W + x) * 3];
+        p[0] = r; p[1] = g; p[2] = b;
+    };
+
+    const int candleW = 5, pitch = 7;
+    const int n = (W - 60) / pitch;
+    const int y0 = H / 10, y1 = H - H / 4;
+    const int volBase = (int)(0.88 * H), volTop = (int)(0.76 * H);
+    const double drift = (seed % 3 == 0) ? 0.003 : (seed % 3 == 1 ? -0.002 : 0.0);
+    auto Y = [&](double v) { return y1 - (int)(v * (y1 - y0)); };
+
+    double prev = 0.5;
+    for (int i = 0; i < n; i++) {
+        double next = prev + drift + (rnd() - 0.5) * 0.05 + 0.01 * std::sin(i * 0.07 * (1 + seed % 5));
+        next = std::min(0.95, std::max(0.05, next));
+        const bool bull = next >= prev;
+        const unsigned char r = bull ? 40 : 220, g = bull ? 220 : 60, b = bull ? 140 : 220;
+        const int x = 30 + i * pitch;
+        const int top = std::min(Y(prev), Y(next)), bot = std::max(Y(prev), Y(next));
+        for (int y = top - 3; y <= bot + 3; y++) put(x + candleW / 2, y, r, g, b);
+        for (int y = top; y <= bot; y++)
+            for (int dx = 0; dx < candleW; dx++) put(x + dx, y, r, g, b);
+        const int vh = 3 + (int)(rnd() * (volBase - volTop - 3));
+        for (int y = volBase; y > volBase - vh; y--)
+            for (int dx = 0; dx < candleW; dx++) put(x + dx, y, bull ? 0 : 200, bull ? 200 : 60, bull ? 120 : 60);
+        prev = next;
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    out << "P6\n" << W << " " << H << "\n255\n";
+    out.write((const char*)rgb.data(), (std::streamsize)rgb.size());
+    return (bool)out;
+}
+
+// ---------- output digest ----------
+
+static uint64_t fnv1a(uint64_t h, const std::string& s) {
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+static std::string predictionKey(const Prediction& p) {
+    std::ostringstream oss;
+    oss << std::setprecision(9) << p.label << '|' << p.signal << '|' << p.buyType << '|' << p.pBull << '|'
+        << p.confidence << '|' << p.stopLoss << '|' << p.target1 << '|' << p.target2 << '|'
+        << p.riskRewardRatio << '|' << p.confluence << '|' << p.breakdown.rawScore;
+    for (double s : p.supportLevels) oss << "|s" << s;
+    for (double r : p.resistanceLevels) oss << "|r" << r;
+    return oss.str();
+}
+
+static std::string hex64(uint64_t v) {
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016" PRIx64, v);
+    return buf;
+}
+
+// ---------- running ----------
+
+static double percentile(std::vector<double>& v, double q) {
+    if (v.empty()) return 0.0;
+    const std::size_t k = std::min(v.size() - 1, (std::size_t)(q * (v.size() - 1) + 0.5));
+    std::nth_element(v.begin(), v.begin() + (std::ptrdiff_t)k, v.end());
+    return v[k];
+}
+
+static Prediction runJob(Predictor& p, const Job& j) {
+    if (j.paths.size() == 3) return p.predictMultiTimeframe(j.paths[0], j.paths[1], j.paths[2], kTimeStr);
+    const ChartMeta meta = parseMetaFromFilename(j.paths[0]);
+    return p.predictWithTime(j.paths[0], kTimeStr, j.tfMinutes, meta.hasScale, meta.minPrice, meta.maxPrice);
+}
+
+// One workload at one thread count: `passes` sweeps over the jobs, split
+// dynamically between threads; every thread owns its Predictor.
+static RunStats runWorkload(const std::string& name, const std::vector<Job>& jobs, const Predictor& proto,
+                            int threads, int passes, std::map<std::string, std::string>& digests,
+                            bool& mismatch) {
+    const std::size_t total = jobs.size() * (std::size_t)passes;
+    std::atomic<std::size_t> next{0};
+    std::vector<std::vector<double>> lat(threads);
+    std::vector<std::vector<std::string>> keys(threads, std::vector<std::string>(jobs.size()));
+
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&, t] {
+            Predictor p = proto;
+            for (std::size_t i; (i = next.fetch_add(1)) < total;) {
+                const Job& j = jobs[i % jobs.size()];
+                const auto s = std::chrono::steady_clock::now();
+                std::string key;
+                try {
+                    key = predictionKey(runJob(p, j));
+                } catch (const std::exception& e) {
+                    key = std::string("error: ") + e.what();
+                }
+                lat[t].push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - s).count());
+                keys[t][i % jobs.size()] = std::move(key);
+            }
+        });
+    }
+    for (auto& th : pool) th.join();
+    const double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    // every thread count has to produce the same predictions
+    for (int t = 0; t < threads; t++) {
+        for (std::size_t k = 0; k < jobs.size(); k++) {
+            if (keys[t][k].empty()) continue;
+            const std::string d = hex64(fnv1a(0xcbf29ce484222325ull, keys[t][k]));
+            std::string& slot = digests[name + ":" + jobs[k].name];
+            if (slot.empty()) slot = d;
+            else if (slot != d) {
+                std::cerr << "output differs between thread counts: " << jobs[k].name << "\n";
+                mismatch = true;
+            }
+        }
+    }
+
+    std::vector<double> all;
+    for (auto& v : lat) all.insert(all.end(), v.begin(), v.end());
+    RunStats r;
+    r.workload = name;
+    r.threads = threads;
+    r.chartsPerSec = wallS > 0 ? total / wallS : 0.0;
+    r.perCore = r.chartsPerSec / threads;
+    r.p50Ms = percentile(all, 0.50);
+    r.p99Ms = percentile(all, 0.99);
+    return r;
+}
+
+static long peakRssKb() {
+#if defined(STOCKPREDICT_HAVE_RUSAGE)
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+#if defined(__APPLE__)
+    return ru.ru_maxrss / 1024;   // bytes there
+#else
+    return ru.ru_maxrss;          // KB
+#endif
+#else
+    return 0;
+#endif
+}
+
+// ---------- baseline JSON ----------
+// Written and read only by this tool: one run per line, fixed key order.
+
+static void saveBaseline(const std::string& path, const std::vector<RunStats>& runs, long rssKb,
+                         const std::map<std::string, std::string>& digests) {
+    std::ofstream out(path);
+    out << "{\n  \"version\": 1,\n  \"peak_rss_kb\": " << rssKb << ",\n  \"runs\": [\n";
+    for (std::size_t i = 0; i < runs.size(); i++) {
+        const RunStats& r = runs[i];
+        out << std::fixed << std::setprecision(4) << "    {\"workload\": \"" << r.workload << "\", \"threads\": "
+            << r.threads << ", \"charts_per_sec\": " << r.chartsPerSec << ", \"charts_per_sec_per_core\": "
+            << r.perCore << ", \"p50_ms\": " << r.p50Ms << ", \"p99_ms\": " << r.p99Ms
+            << ", \"efficiency\": " << r.efficiency << "}" << (i + 1 < runs.size() ? "," : "") << "\n";
+    }
+    out << "  ],\n  \"outputs\": {\n";
+    std::size_t i = 0;
+    for (const auto& kv : digests) {
+        out << "    \"" << kv.first << "\": \"" << kv.second << "\"" << (++i < digests.size() ? "," : "") << "\n";
+    }
+    out << "  }\n}\n";
+}
+
+static bool loadBaseline(const std::string& path, std::vector<RunStats>& runs, long& rssKb,
+                         std::map<std::string, std::string>& digests) {
+    std::ifstream in(path);
+    if (!in) return false;
+    const std::regex runRe(
+        R"re(\{"workload": "([^"]+)", "threads": (\d+), "charts_per_sec": ([-\d.eE+]+), "charts_per_sec_per_core": ([-\d.eE+]+), "p50_ms": ([-\d.eE+]+), "p99_ms": ([-\d.eE+]+), "efficiency": ([-\d.eE+]+)\})re");
+    const std::regex rssRe(R"re("peak_rss_kb": (\d+))re");
+    const std::regex outRe(R"re(^\s*"([^"]+:[^"]+)": "([0-9a-f]{16})")re");
+    std::string line;
+    std::smatch m;
+    while (std::getline(in, line)) {
+        if (std::regex_search(line, m, runRe)) {
+            RunStats r;
+            r.workload = m[1];
+            r.threads = std::stoi(m[2]);
+            r.chartsPerSec = std::stod(m[3]);
+            r.perCore = std::stod(m[4]);
+            r.p50Ms = std::stod(m[5]);
+            r.p99Ms = std::stod(m[6]);
+            r.efficiency = std::stod(m[7]);
+            runs.push_back(r);
+        } else if (std::regex_search(line, m, rssRe)) {
+            rssKb = std::stol(m[1]);
+        } else if (std::regex_search(line, m, outRe)) {
+            digests[m[1]] = m[2];
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::string chartsDir = "assets/charts";
+    std::string workDir = (fs::temp_directory_path() / "stockpredict_regress").string();
+    std::string baselinePath, savePath;
+    int generate = 24, maxThreads = (int)std::max(1u, std::thread::hardware_concurrency()), passes = 3;
+    double tolerance = 0.10;
+    bool outputsOnly = false;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : ""; };
+        if (a == "--charts") chartsDir = next();
+        else if (a == "--generate") generate = std::max(0, std::atoi(next()));
+        else if (a == "--work") workDir = next();
+        else if (a == "--threads") maxThreads = std::max(1, std::atoi(next()));
+        else if (a == "--passes") passes = std::max(1, std::atoi(next()));
+        else if (a == "--baseline") baselinePath = next();
+        else if (a == "--save-baseline") savePath = next();
+        else if (a == "--tolerance") tolerance = std::atof(next());
+        else if (a == "--outputs-only") outputsOnly = true;
+        else {
+            std::cerr << "unknown option " << a << "\n";
+            return 2;
+        }
+    }
+
+    // ---- corpus ----
+    std::vector<Job> single, multi;
+    std::error_code ec;
+    std::vector<std::string> real;
+    for (const auto& e : fs::directory_iterator(chartsDir, ec)) {
+        const std::string ext = e.path().extension().string();
+        if (e.is_regular_file() && (ext == ".png" || ext == ".ppm")) real.push_back(e.path().string());
+    }
+    std::sort(real.begin(), real.end());
+    for (const auto& p : real) single.push_back({"real/" + fs::path(p).filename().string(), {p}, parseMetaFromFilename(p).tfMin});
+
+    fs::create_directories(workDir, ec);
+    const int tfs[3] = {1, 5, 30};
+    std::vector<std::string> gen;
+    for (int i = 0; i < generate; i++) {
+        const int tf = tfs[i % 3];
+        const std::string name = "GEN" + std::to_string(i) + "_" + std::to_string(tf) + "m.ppm";
+        const std::string path = (fs::path(workDir) / name).string();
+        if (!writeSyntheticChart(path, (uint32_t)i, 900 + 40 * (i % 8), 700 + 20 * (i % 5))) {
+            std::cerr << "cannot write " << path << "\n";
+            return 1;
+        }
+        gen.push_back(path);
+        single.push_back({"gen/" + name, {path}, tf});
+    }
+    for (std::size_t i = 0; i + 2 < gen.size(); i += 3) {
+        multi.push_back({"gen/multi" + std::to_string(i / 3), {gen[i], gen[i + 1], gen[i + 2]}, -1});
+    }
+    if (single.empty()) {
+        std::cerr << "empty corpus (no charts in " << chartsDir << " and --generate 0)\n";
+        return 2;
+    }
+    std::cout << "corpus: " << real.size() << " real + " << gen.size() << " generated charts, " << multi.size()
+              << " multi-TF triples; " << passes << " passes per run\n";
+
+    // ---- runs ----
+    std::vector<int> threadCounts;
+    for (int t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    Predictor proto;
+    proto.setConfidenceThreshold(60.0);
+    std::vector<RunStats> runs;
+    std::map<std::string, std::string> digests;
+    bool mismatch = false;
+    for (const auto& wl : {std::make_pair(std::string("single"), &single), std::make_pair(std::string("multi"), &multi)}) {
+        if (wl.second->empty()) continue;
+        double base1 = 0.0;
+        for (int t : threadCounts) {
+            RunStats r = runWorkload(wl.first, *wl.second, proto, t, passes, digests, mismatch);
+            if (t == 1) base1 = r.chartsPerSec;
+            r.efficiency = base1 > 0 ? r.chartsPerSec / (t * base1) : 1.0;
+            runs.push_back(r);
+            std::cout << std::left << std::setw(7) << r.workload << std::right << " threads=" << std::setw(2) << t
+                      << std::fixed << std::setprecision(1) << "  " << std::setw(8) << r.chartsPerSec << " charts/s"
+                      << "  " << std::setw(7) << r.perCore << "/core" << std::setprecision(2) << "  p50 "
+                      << r.p50Ms << " ms  p99 " << r.p99Ms << " ms  eff " << std::setprecision(0)
+                      << r.efficiency * 100.0 << "%\n";
+        }
+    }
+    const long rss = peakRssKb();
+    if (rss > 0) std::cout << "peak RSS " << rss / 1024.0 << " MB\n";
+
+    if (!savePath.empty()) {
+        saveBaseline(savePath, runs, rss, digests);
+        std::cout << "baseline written to " << savePath << "\n";
+    }
+    if (baselinePath.empty()) return mismatch ? 1 : 0;
+
+    // ---- compare ----
+    std::vector<RunStats> baseRuns;
+    long baseRss = 0;
+    std::map<std::string, std::string> baseDigests;
+    if (!loadBaseline(baselinePath, baseRuns, baseRss, baseDigests)) {
+        std::cerr << "cannot read baseline " << baselinePath << "\n";
+        return 2;
+    }
+    int regressions = 0;
+    for (const RunStats& b : baseRuns) {
+        if (outputsOnly) break;
+        for (const RunStats& r : runs) {
+            if (r.workload != b.workload || r.threads != b.threads) continue;
+            if (r.chartsPerSec < b.chartsPerSec * (1.0 - tolerance)) {
+                std::cout << "REGRESSION " << r.workload << " threads=" << r.threads << ": " << std::setprecision(1)
+                          << r.chartsPerSec << " charts/s vs " << b.chartsPerSec << "\n";
+                regressions++;
+            }
+            if (r.p99Ms > b.p99Ms * (1.0 + tolerance)) {
+                std::cout << "REGRESSION " << r.workload << " threads=" << r.threads << ": p99 " << std::setprecision(2)
+                          << r.p99Ms << " ms vs " << b.p99Ms << "\n";
+                regressions++;
+            }
+        }
+    }
+    if (!outputsOnly && baseRss > 0 && rss > 0 && rss > baseRss * (1.0 + tolerance)) {
+        std::cout << "REGRESSION peak RSS " << rss << " KB vs " << baseRss << "\n";
+        regressions++;
+    }
+    int changed = 0;
+    for (const auto& kv : baseDigests) {
+        auto it = digests.find(kv.first);
+        if (it == digests.end()) continue;   // chart not in this corpus
+        if (it->second != kv.second) {
+            std::cout << "OUTPUT CHANGED " << kv.first << "\n";
+            changed++;
+        }
+    }
+    std::cout << (regressions || changed || mismatch ? "FAIL" : "OK") << ": " << regressions
+              << " perf regression(s), " << changed << " changed output(s) vs " << baselinePath
+              << " (tolerance " << std::setprecision(0) << tolerance * 100.0 << "%)\n";
+    return (regressions || changed || mismatch) ? 1 : 0;
+}
@@ -0,0 +1,109 @@
+// ===============================
+// File: train_main.cpp
+// stockpredict_train — fit weights + calibration to labelled history (see WeightFit.h)
+// and write a config Predictor loads (--config / ConfigWatcher).
+//   stockpredict_train --ohlcv bars.csv [--lookback 120] [--horizon 10] [--sample-step 1]
+//   stockpredict_train --charts list.csv
+// common: [--config base.conf]  start from (colours, cuts, gates, TF multipliers kept)
+//         [--out fitted.conf]   (default: print it)
+//         [--tf N] [--threads N] [--indicators] [--l2 X] [--iterations N] [--scale X]
+// ===============================
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Predictor.h"
+#include "PredictorConfig.h"
+#include "WalkForward.h"
+#include "WeightFit.h"
+
+int main(int argc, char** argv) {
+    std::string ohlcvPath, chartsPath, basePath, outPath;
+    int lookback = 120, horizon = 10, sampleStep = 1;
+    WeightFitOptions opt;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : ""; };
+        if (a == "--ohlcv") ohlcvPath = next();
+        else if (a == "--charts") chartsPath = next();
+        else if (a == "--config") basePath = next();
+        else if (a == "--out") outPath = next();
+        else if (a == "--lookback") lookback = std::atoi(next());
+        else if (a == "--horizon") horizon = std::atoi(next());
+        else if (a == "--sample-step") sampleStep = std::atoi(next());
+        else if (a == "--tf") opt.tfMinutes = std::atoi(next());
+        else if (a == "--threads") opt.threads = std::atoi(next());
+        else if (a == "--indicators") opt.indicators = true;
+        else if (a == "--l2") opt.l2 = std::atof(next());
+        else if (a == "--iterations") opt.maxIterations = std::atoi(next());
+        else if (a == "--scale") opt.scale = std::atof(next());
+        else {
+            std::cerr << "unknown option " << a << "\n";
+            return 2;
+        }
+    }
+    if (ohlcvPath.empty() == chartsPath.empty()) {
+        std::cerr << "usage: stockpredict_train --ohlcv bars.csv | --charts list.csv [--config base.conf]"
+                     " [--out fitted.conf] [--tf N] [--threads N] [--indicators] [--l2 X] [--iterations N]"
+                     " [--scale X] [--lookback N] [--horizon N] [--sample-step N]\n";
+        return 2;
+    }
+
+    std::string err;
+    Predictor prototype;
+    if (!basePath.empty()) {
+        PredictorConfig base;
+        if (!loadPredictorConfig(basePath, base, &err)) {
+            std::cerr << err << "\n";
+            return 1;
+        }
+        prototype.applyConfig(base);
+    }
+
+    WeightFitData data;
+    if (!ohlcvPath.empty()) {
+        std::vector<OhlcvBar> bars;
+        if (!loadOhlcvCsv(ohlcvPath, bars, &err)) {
+            std::cerr << err << "\n";
+            return 1;
+        }
+        buildWeightFitData(prototype, bars, lookback, horizon, sampleStep, opt, data);
+        std::cout << bars.size() << " bars (lookback " << lookback << ", horizon " << horizon << ") -> ";
+    } else {
+        std::vector<WalkSample> samples;
+        if (!loadChartSamples(chartsPath, samples, &err)) {
+            std::cerr << err << "\n";
+            return 1;
+        }
+        buildWeightFitData(prototype, samples, opt, data);
+    }
+    std::cout << data.rows() << " rows (" << data.skipped << " skipped), features " << std::fixed
+              << std::setprecision(1) << data.extractMs << " ms\n";
+    if (data.rows() == 0) {
+        std::cerr << "nothing to fit\n";
+        return 1;
+    }
+
+    const WeightFitReport rep = fitWeights(prototype, data, opt);
+    const PredictorConfig& c = rep.config;
+    std::cout << "fit: " << rep.iterations << " Newton steps" << (rep.converged ? "" : " (not converged)") << ", "
+              << std::setprecision(1) << rep.fitMs << " ms\n"
+              << std::setprecision(4) << "  log loss " << rep.baseLogLoss << " -> " << rep.logLoss << ", accuracy "
+              << std::setprecision(1) << rep.baseAccuracy << "% -> " << rep.accuracy << "%\n"
+              << std::setprecision(3) << "  weights trend " << c.trend << " momentum " << c.momentum << " reversal "
+              << c.reversal << " sr " << c.sr;
+    if (rep.fitIndicators) std::cout << " indicators " << c.indicators;
+    std::cout << "\n  calibration scale " << c.calibration.scale << " bias " << c.calibration.bias << "\n";
+
+    if (outPath.empty()) {
+        std::cout << "\n" << formatPredictorConfig(c);
+    } else if (!savePredictorConfig(outPath, c, &err)) {
+        std::cerr << err << "\n";
+        return 1;
+    } else {
+        std::cout << "wrote " << outPath << "\n";
+    }
+    return 0;
+}
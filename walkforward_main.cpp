@@ -0,0 +1,127 @@
+// ===============================
+// File: walkforward_main.cpp
+// stockpredict_walkforward — out-of-sample check of weights/threshold (see WalkForward.h).
+//   stockpredict_walkforward --ohlcv bars.csv [--lookback 120] [--horizon 10] [--sample-step 1]
+//   stockpredict_walkforward --charts list.csv
+// common: [--train N] [--test N] [--step N] [--tf N] [--threads N] [--min-trades N]
+//         [--csv trades.csv]   (test-window predictions, saveBacktestCSV format)
+//         [--mc N [--mc-shuffle]]  N Monte Carlo resamples of the test trades (see MonteCarlo.h)
+// ===============================
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "MonteCarlo.h"
+#include "Predictor.h"
+#include "WalkForward.h"
+
+static void printDistribution(const char* name, const Distribution& d, const char* unit) {
+    std::cout << "  " << std::left << std::setw(13) << name << std::right << std::fixed << std::setprecision(2)
+              << " mean " << d.mean << unit << "  sd " << d.stddev << "  p5 " << d.p5 << unit << "  p50 " << d.p50
+              << unit << "  p95 " << d.p95 << unit << "  [p1 " << d.p1 << ", p99 " << d.p99 << "]\n";
+}
+
+static void printMetrics(const std::map<std::string, double>& m) {
+    auto get = [&](const char* k) {
+        auto it = m.find(k);
+        return it == m.end() ? 0.0 : it->second;
+    };
+    std::cout << "trades=" << (int)get("trades") << " win=" << std::fixed << std::setprecision(1)
+              << get("win_rate") << "% pnl=" << std::setprecision(2) << get("pnl") << "% avg="
+              << std::setprecision(3) << get("avg_pnl") << "%";
+}
+
+int main(int argc, char** argv) {
+    std::string ohlcvPath, chartsPath, csvOut;
+    MonteCarloOptions mc;
+    mc.resamples = 0;
+    int lookback = 120, horizon = 10, sampleStep = 1;
+    WalkForwardOptions opt;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : ""; };
+        if (a == "--ohlcv") ohlcvPath = next();
+        else if (a == "--charts") chartsPath = next();
+        else if (a == "--lookback") lookback = std::atoi(next());
+        else if (a == "--horizon") horizon = std::atoi(next());
+        else if (a == "--sample-step") sampleStep = std::atoi(next());
+        else if (a == "--train") opt.trainSamples = std::atoi(next());
+        else if (a == "--test") opt.testSamples = std::atoi(next());
+        else if (a == "--step") opt.stepSamples = std::atoi(next());
+        else if (a == "--tf") opt.tfMinutes = std::atoi(next());
+        else if (a == "--threads") opt.threads = std::atoi(next());
+        else if (a == "--min-trades") opt.minTrades = std::atoi(next());
+        else if (a == "--csv") csvOut = next();
+        else if (a == "--mc") mc.resamples = (std::size_t)std::max(0, std::atoi(next()));
+        else if (a == "--mc-shuffle") mc.shuffle = true;
+        else {
+            std::cerr << "unknown option " << a << "\n";
+            return 2;
+        }
+    }
+    if (ohlcvPath.empty() == chartsPath.empty()) {
+        std::cerr << "usage: stockpredict_walkforward --ohlcv bars.csv | --charts list.csv [--train N] [--test N]"
+                     " [--step N] [--tf N] [--threads N] [--min-trades N] [--lookback N] [--horizon N]"
+                     " [--sample-step N] [--csv out.csv] [--mc N [--mc-shuffle]]\n";
+        return 2;
+    }
+
+    std::vector<WalkSample> samples;
+    std::string err;
+    if (!ohlcvPath.empty()) {
+        std::vector<OhlcvBar> bars;
+        if (!loadOhlcvCsv(ohlcvPath, bars, &err)) {
+            std::cerr << err << "\n";
+            return 1;
+        }
+        samples = samplesFromBars(bars, lookback, horizon, sampleStep);
+        std::cout << bars.size() << " bars -> " << samples.size() << " samples (lookback " << lookback
+                  << ", horizon " << horizon << ")\n";
+    } else if (!loadChartSamples(chartsPath, samples, &err)) {
+        std::cerr << err << "\n";
+        return 1;
+    }
+
+    Predictor prototype;
+    const WalkForwardReport rep = runWalkForward(prototype, samples, opt);
+
+    for (std::size_t i = 0; i < rep.windows.size(); i++) {
+        const WalkWindow& w = rep.windows[i];
+        std::cout << "window " << i << " train [" << w.trainBegin << "," << w.trainEnd << ") test ["
+                  << w.testBegin << "," << w.testEnd << ") ";
+        if (w.tuned) {
+            std::cout << "w=" << std::setprecision(2) << w.params.trend << "/" << w.params.momentum << "/"
+                      << w.params.reversal << "/" << w.params.sr << " th=" << std::setprecision(0)
+                      << w.params.threshold << " | train ";
+            printMetrics(w.train);
+        } else {
+            std::cout << "defaults (no candidate reached min trades)";
+        }
+        std::cout << " | test ";
+        printMetrics(w.test);
+        std::cout << "\n";
+    }
+    std::cout << "out-of-sample: ";
+    printMetrics(rep.aggregate);
+    std::cout << "\n" << rep.samples << " samples (" << rep.failed << " unreadable), " << rep.windows.size()
+              << " windows; features " << std::setprecision(1) << rep.extractMs << " ms, tuning "
+              << rep.tuneMs << " ms\n";
+
+    Predictor book;
+    for (const BacktestResult& r : rep.trades) book.addBacktestResult(r);
+    if (!csvOut.empty()) book.saveBacktestCSV(csvOut);
+
+    if (mc.resamples > 0) {
+        mc.threads = opt.threads;
+        const MonteCarloReport m = runMonteCarlo(book.tradePnls(), mc);
+        std::cout << (mc.shuffle ? "trade-order shuffle" : "bootstrap") << ": " << m.resamples << " x "
+                  << m.trades << " trades in " << std::setprecision(1) << m.ms << " ms\n";
+        printDistribution("final pnl", m.finalEquity, "%");
+        printDistribution("max drawdown", m.maxDrawdown, "%");
+        printDistribution("win rate", m.winRate, "%");
+    }
+    return 0;
+}
@@ -0,0 +1,60 @@
+// ===============================
+// File: watch_main.cpp
+// stockpredict_watch — headless folder watch mode (ChartWatcher.h), no SFML.
+// Same loop as StockPredictGUI --watch, for boxes without a display stack.
+//   stockpredict_watch <dir> [--threads N] [--preview K]
+//                      [--config file]   (PredictorConfig.h; edits apply to the next chart)
+// Env:
+//   STOCKPREDICT_TRACE=trace.json  record a Chrome/Perfetto trace, written on exit
+// ===============================
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "ChartWatcher.h"
+#include "PredictorConfig.h"
+#include "Trace.h"
+
+int main(int argc, char** argv) {
+    std::string dir;
+    WatchOptions opt;
+    std::string configPath;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : ""; };
+        if (a == "--threads") opt.workers = std::max(1, std::atoi(next()));
+        else if (a == "--preview") opt.previewStride = std::max(0, std::atoi(next()));
+        else if (a == "--config") configPath = next();
+        else if (dir.empty() && !a.empty() && a[0] != '-') dir = a;
+        else {
+            dir.clear();
+            break;
+        }
+    }
+    if (dir.empty()) {
+        std::cerr << "usage: stockpredict_watch <dir> [--threads N] [--preview K] [--config file]\n";
+        return 2;
+    }
+
+    const char* tracePath = std::getenv("STOCKPREDICT_TRACE");
+    if (tracePath && *tracePath) {
+        trace::enable();
+        trace::setThreadName("main");
+    }
+
+    // the workers' copies follow the same store
+    std::shared_ptr<ConfigStore> configStore;
+    std::unique_ptr<ConfigWatcher> configWatcher;
+    if (!configPath.empty()) {
+        configStore = std::make_shared<ConfigStore>();
+        configWatcher = std::make_unique<ConfigWatcher>(configStore, configPath, 500,
+            [](bool ok, const std::string& msg) { (ok ? std::cout : std::cerr) << "config: " << msg << std::endl; });
+        if (!configWatcher->start()) return 1;   // callback already printed why
+    }
+
+    const int rc = runWatchMode(dir, opt, configStore);
+    if (trace::enabled()) trace::writeChromeJson(tracePath);
+    return rc;
+}